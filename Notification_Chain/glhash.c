@@ -0,0 +1,402 @@
+/**
+ * @file glhash.c
+ * @author agent
+ * @brief  This file implements the intrusive hash table, its incremental resize and the lock striped table
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "glhash.h"
+#include <stdlib.h>
+
+#define GLHASH_USER_DATA(glhash, glhash_node)   ((void *)((char *)(glhash_node) - (glhash)->offset))
+
+/*********** private helper functions BEGIN **********/
+
+/**
+ * @brief   smallest power of two >= value, at least GLHASH_MIN_SIZE
+ *
+ * @param value
+ * @return unsigned int
+ */
+static unsigned int glhash_round_up(unsigned int value)
+{
+    unsigned int size = GLHASH_MIN_SIZE;
+
+    while(size < value)
+    {
+        size <<= 1;
+    }
+    return size;
+}
+
+/**
+ * @brief   chain holding nodes of hash, the old bucket while it still has nodes
+ *
+ * @param glhash - buckets allocated
+ * @param hash
+ * @return glhash_node_t** - chain head
+ */
+static glhash_node_t **glhash_chain(glhash_t *glhash, unsigned int hash)
+{
+    glhash_node_t **old_chain;
+
+    if(glhash->old_buckets)
+    {
+        old_chain = &glhash->old_buckets[hash & (glhash->old_size - 1)];
+        if(*old_chain)
+        {
+            return old_chain;
+        }
+    }
+    return &glhash->buckets[hash & (glhash->size - 1)];
+}
+
+/**
+ * @brief   move all nodes of one old bucket to the new table
+ *
+ * @param glhash
+ * @param index - old bucket
+ */
+static void glhash_migrate_bucket(glhash_t *glhash, unsigned int index)
+{
+    glhash_node_t *node, **chain;
+
+    while((node = glhash->old_buckets[index]) != NULL)
+    {
+        glhash->old_buckets[index] = node->next;
+        chain = &glhash->buckets[node->hash & (glhash->size - 1)];
+        node->next = *chain;
+        *chain = node;
+    }
+}
+
+/**
+ * @brief   move next old buckets in order, free old table once drained
+ *
+ * @param glhash
+ * @param buckets - old buckets to move
+ */
+static void glhash_migrate(glhash_t *glhash, unsigned int buckets)
+{
+    while(buckets-- != 0 && glhash->migrate_index < glhash->old_size)
+    {
+        glhash_migrate_bucket(glhash, glhash->migrate_index++);
+    }
+    if(glhash->migrate_index == glhash->old_size)
+    {
+        free(glhash->old_buckets);
+        glhash->old_buckets = NULL;
+        glhash->old_size = 0;
+        glhash->migrate_index = 0;
+    }
+}
+
+/**
+ * @brief   first non empty bucket from index on
+ *
+ * @param buckets
+ * @param size
+ * @param index
+ * @return glhash_node_t* - NULL when none
+ */
+static glhash_node_t *glhash_scan(glhash_node_t **buckets, unsigned int size, unsigned int index)
+{
+    for(; index < size; index++)
+    {
+        if(buckets[index])
+        {
+            return buckets[index];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief   stripe of hash, from upper bits of a multiplicative mix so stripe and bucket bits differ
+ *
+ * @param glhash_striped
+ * @param hash
+ * @return glhash_stripe_t*
+ */
+static glhash_stripe_t *glhash_striped_stripe(glhash_striped_t *glhash_striped, unsigned int hash)
+{
+    unsigned long long mixed = (unsigned int)(hash * 2654435769u);
+
+    return &glhash_striped->stripes[mixed >> glhash_striped->stripe_shift];
+}
+
+/*********** private helper functions END ***********/
+
+unsigned int glhash_bytes(const void *data, size_t size)
+{
+    const unsigned char *bytes = (const unsigned char *) data;
+    unsigned int hash = 2166136261u;
+
+    while(size-- != 0)
+    {
+        hash ^= *bytes++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void glhash_init(glhash_t *glhash, unsigned int size,
+        unsigned int (*hash_fn)(void *key),
+        int (*key_comp_fn)(void *user_data, void *key),
+        int offset)
+{
+    glhash->buckets = NULL;
+    glhash->size = glhash_round_up(size);
+    glhash->old_buckets = NULL;
+    glhash->old_size = 0;
+    glhash->migrate_index = 0;
+    glhash->count = 0;
+    glhash->hash_fn = hash_fn;
+    glhash->key_comp_fn = key_comp_fn;
+    glhash->offset = offset;
+}
+
+void glhash_destroy(glhash_t *glhash)
+{
+    free(glhash->buckets);
+    free(glhash->old_buckets);
+    glhash->buckets = NULL;
+    glhash->old_buckets = NULL;
+    glhash->old_size = 0;
+    glhash->migrate_index = 0;
+    glhash->count = 0;
+}
+
+void glhash_insert(glhash_t *glhash, glhash_node_t *glhash_node, void *key)
+{
+    glhash_node_t **chain;
+
+    glhash_node->hash = glhash->hash_fn(key);
+
+    if(!glhash->buckets)
+    {
+        glhash->buckets = calloc(glhash->size, sizeof(glhash_node_t *));
+    }
+
+    if(glhash->old_buckets)
+    {
+        glhash_migrate(glhash, GLHASH_MIGRATE_STEP);
+    }
+
+    if(glhash->count >= glhash->size)
+    {
+        /* a resize is drained before count can double again, finish it anyway if it is not */
+        if(glhash->old_buckets)
+        {
+            glhash_migrate(glhash, glhash->old_size);
+        }
+        glhash->old_buckets = glhash->buckets;
+        glhash->old_size = glhash->size;
+        glhash->migrate_index = 0;
+        glhash->size <<= 1;
+        glhash->buckets = calloc(glhash->size, sizeof(glhash_node_t *));
+    }
+
+    /* keep nodes of one hash on one chain */
+    if(glhash->old_buckets)
+    {
+        glhash_migrate_bucket(glhash, glhash_node->hash & (glhash->old_size - 1));
+    }
+
+    chain = &glhash->buckets[glhash_node->hash & (glhash->size - 1)];
+    glhash_node->next = *chain;
+    *chain = glhash_node;
+    glhash->count++;
+}
+
+glhash_node_t *glhash_lookup(glhash_t *glhash, void *key)
+{
+    unsigned int hash;
+    glhash_node_t *node;
+
+    if(glhash->count == 0)
+    {
+        return NULL;
+    }
+
+    hash = glhash->hash_fn(key);
+    for(node = *glhash_chain(glhash, hash); node; node = node->next)
+    {
+        if(node->hash == hash && glhash->key_comp_fn(GLHASH_USER_DATA(glhash, node), key) == 0)
+        {
+            return node;
+        }
+    }
+    return NULL;
+}
+
+glhash_node_t *glhash_lookup_next(glhash_t *glhash, glhash_node_t *glhash_node, void *key)
+{
+    glhash_node_t *node;
+
+    for(node = glhash_node->next; node; node = node->next)
+    {
+        if(node->hash == glhash_node->hash && glhash->key_comp_fn(GLHASH_USER_DATA(glhash, node), key) == 0)
+        {
+            return node;
+        }
+    }
+    return NULL;
+}
+
+void glhash_remove(glhash_t *glhash, glhash_node_t *glhash_node)
+{
+    glhash_node_t **chain = glhash_chain(glhash, glhash_node->hash);
+
+    while(*chain != glhash_node)
+    {
+        chain = &(*chain)->next;
+    }
+    *chain = glhash_node->next;
+    glhash_node->next = NULL;
+    glhash->count--;
+}
+
+glhash_node_t *glhash_first(glhash_t *glhash)
+{
+    glhash_node_t *node = NULL;
+
+    if(glhash->count == 0)
+    {
+        return NULL;
+    }
+    if(glhash->old_buckets)
+    {
+        node = glhash_scan(glhash->old_buckets, glhash->old_size, 0);
+    }
+    return node ? node : glhash_scan(glhash->buckets, glhash->size, 0);
+}
+
+glhash_node_t *glhash_next(glhash_t *glhash, glhash_node_t *glhash_node)
+{
+    glhash_node_t *node;
+    unsigned int index;
+
+    if(glhash_node->next)
+    {
+        return glhash_node->next;
+    }
+
+    if(glhash->old_buckets)
+    {
+        index = glhash_node->hash & (glhash->old_size - 1);
+        if(glhash->old_buckets[index])
+        {
+            /* node is in old table, rest of it then the whole new table */
+            node = glhash_scan(glhash->old_buckets, glhash->old_size, index + 1);
+            return node ? node : glhash_scan(glhash->buckets, glhash->size, 0);
+        }
+    }
+    return glhash_scan(glhash->buckets, glhash->size, (glhash_node->hash & (glhash->size - 1)) + 1);
+}
+
+void glhash_striped_init(glhash_striped_t *glhash_striped, unsigned int stripes, unsigned int size,
+        unsigned int (*hash_fn)(void *key),
+        int (*key_comp_fn)(void *user_data, void *key),
+        int offset)
+{
+    unsigned int bits = 0;
+
+    while((1u << bits) < stripes)
+    {
+        bits++;
+    }
+    glhash_striped->stripe_count = 1u << bits;
+    glhash_striped->stripe_shift = 32 - bits;
+    glhash_striped->stripes = aligned_alloc(GLHASH_CACHE_LINE_SIZE,
+            sizeof(glhash_stripe_t) * glhash_striped->stripe_count);
+
+    for(unsigned int i = 0; i < glhash_striped->stripe_count; i++)
+    {
+        pthread_mutex_init(&glhash_striped->stripes[i].mutex, NULL);
+        glhash_init(&glhash_striped->stripes[i].table, size, hash_fn, key_comp_fn, offset);
+    }
+}
+
+void glhash_striped_destroy(glhash_striped_t *glhash_striped)
+{
+    for(unsigned int i = 0; i < glhash_striped->stripe_count; i++)
+    {
+        glhash_destroy(&glhash_striped->stripes[i].table);
+        pthread_mutex_destroy(&glhash_striped->stripes[i].mutex);
+    }
+    free(glhash_striped->stripes);
+    glhash_striped->stripes = NULL;
+}
+
+glhash_t *glhash_striped_lock(glhash_striped_t *glhash_striped, void *key)
+{
+    /* every stripe has the same hash function */
+    glhash_stripe_t *stripe = glhash_striped_stripe(glhash_striped,
+            glhash_striped->stripes[0].table.hash_fn(key));
+
+    pthread_mutex_lock(&stripe->mutex);
+    return &stripe->table;
+}
+
+void glhash_striped_unlock(glhash_striped_t *glhash_striped, void *key)
+{
+    glhash_stripe_t *stripe = glhash_striped_stripe(glhash_striped,
+            glhash_striped->stripes[0].table.hash_fn(key));
+
+    pthread_mutex_unlock(&stripe->mutex);
+}
+
+glhash_node_t *glhash_striped_insert(glhash_striped_t *glhash_striped, glhash_node_t *glhash_node, void *key)
+{
+    glhash_stripe_t *stripe = glhash_striped_stripe(glhash_striped,
+            glhash_striped->stripes[0].table.hash_fn(key));
+    glhash_node_t *found;
+
+    pthread_mutex_lock(&stripe->mutex);
+    found = glhash_lookup(&stripe->table, key);
+    if(!found)
+    {
+        glhash_insert(&stripe->table, glhash_node, key);
+    }
+    pthread_mutex_unlock(&stripe->mutex);
+    return found;
+}
+
+glhash_node_t *glhash_striped_lookup(glhash_striped_t *glhash_striped, void *key)
+{
+    glhash_stripe_t *stripe = glhash_striped_stripe(glhash_striped,
+            glhash_striped->stripes[0].table.hash_fn(key));
+    glhash_node_t *found;
+
+    pthread_mutex_lock(&stripe->mutex);
+    found = glhash_lookup(&stripe->table, key);
+    pthread_mutex_unlock(&stripe->mutex);
+    return found;
+}
+
+void glhash_striped_remove(glhash_striped_t *glhash_striped, glhash_node_t *glhash_node)
+{
+    glhash_stripe_t *stripe = glhash_striped_stripe(glhash_striped, glhash_node->hash);
+
+    pthread_mutex_lock(&stripe->mutex);
+    glhash_remove(&stripe->table, glhash_node);
+    pthread_mutex_unlock(&stripe->mutex);
+}
+
+unsigned int glhash_striped_count(glhash_striped_t *glhash_striped)
+{
+    unsigned int count = 0;
+
+    for(unsigned int i = 0; i < glhash_striped->stripe_count; i++)
+    {
+        pthread_mutex_lock(&glhash_striped->stripes[i].mutex);
+        count += glhash_striped->stripes[i].table.count;
+        pthread_mutex_unlock(&glhash_striped->stripes[i].mutex);
+    }
+    return count;
+}
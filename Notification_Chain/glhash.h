@@ -0,0 +1,237 @@
+/**
+ * @file glhash.h
+ * @author agent
+ * @brief  This file defines an intrusive chained hash table glued the same way as glthread_t:
+ *         user structure embeds a glhash_node_t, table finds the structure back through its offset.
+ *         table doubles when it gets full, old buckets move to the new table a few per insert,
+ *         so no insert pays for a full rehash. glhash_striped_t splits keys over independent
+ *         tables each behind its own mutex for concurrent use
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __GLHASH__
+#define __GLHASH__
+
+#include <stddef.h>
+#include <pthread.h>
+
+/* buckets of a table on first insert */
+#define GLHASH_MIN_SIZE             16
+/* old buckets moved to the new table by each insert while resizing */
+#define GLHASH_MIGRATE_STEP         2
+#define GLHASH_CACHE_LINE_SIZE      64
+
+/* hash node, embedded in user structure */
+typedef struct _glhash_node{
+
+    struct _glhash_node *next;      /* bucket chain */
+    unsigned int hash;              /* full hash of node key, kept for resize and chain walk */
+} glhash_node_t;
+
+/**
+ * @brief   hash table, chained, power of two buckets
+ *
+ * @note    while resizing, nodes live in old_buckets until their old bucket moves,
+ *          insert moves the old bucket of its key first, so nodes of one hash are
+ *          always on one chain: the old bucket when it is not empty, else the new one
+ *
+ */
+typedef struct _glhash{
+
+    glhash_node_t **buckets;
+    unsigned int size;              /* buckets, allocated on first insert */
+    glhash_node_t **old_buckets;    /* table being drained, NULL when not resizing */
+    unsigned int old_size;
+    unsigned int migrate_index;     /* next old bucket to move */
+    unsigned int count;
+    unsigned int (*hash_fn)(void *key);
+    int (*key_comp_fn)(void *user_data, void *key);  /* 0 when user structure has key */
+    int offset;                     /* offset of glhash_node_t in user structure */
+} glhash_t;
+
+/**
+ * @brief   one stripe of striped table, own cache line so stripe locks do not share one
+ *
+ */
+typedef struct _glhash_stripe{
+
+    _Alignas(GLHASH_CACHE_LINE_SIZE) pthread_mutex_t mutex;
+    glhash_t table;
+} glhash_stripe_t;
+
+/* lock striped table, key picks its stripe from the upper hash bits */
+typedef struct _glhash_striped{
+
+    glhash_stripe_t *stripes;
+    unsigned int stripe_count;      /* power of two */
+    unsigned int stripe_shift;      /* 32 - log2(stripe_count) */
+} glhash_striped_t;
+
+#define GLHASH_TO_STRUCT(fn_name, structure_name, field_name)                          \
+    static inline structure_name * fn_name(glhash_node_t *glhashptr){                  \
+        return (structure_name *)((char *)(glhashptr) - (char *)&(((structure_name *)0)->field_name)); \
+    }
+
+#define GLHASH_COUNT(glhashptr)                     ((glhashptr)->count)
+
+#define IS_GLHASH_EMPTY(glhashptr)                  ((glhashptr)->count == 0)
+
+/* delete safe loop over all nodes, in no particular order,
+ * normal continue and break can be used, no insert inside the loop */
+#define ITERATE_GLHASH_BEGIN(glhashptr, glhashnodeptr)                                             \
+{                                                                                                  \
+    glhash_node_t *_glhash_ptr = NULL;                                                             \
+    glhashnodeptr = glhash_first(glhashptr);                                                       \
+    for(; glhashnodeptr != NULL; glhashnodeptr = _glhash_ptr){                                     \
+        _glhash_ptr = glhash_next(glhashptr, glhashnodeptr);
+
+#define ITERATE_GLHASH_END(glhashptr, glhashnodeptr)                                               \
+        }}
+
+/**
+ * @brief   FNV-1a hash of bytes, for user hash functions
+ *
+ * @param data
+ * @param size
+ * @return unsigned int
+ */
+unsigned int glhash_bytes(const void *data, size_t size);
+
+/**
+ * @brief   initiate table, buckets are allocated on first insert
+ *
+ * @param glhash
+ * @param size - expected nodes, rounded up to a power of two buckets, 0 for GLHASH_MIN_SIZE
+ * @param hash_fn - hash of key
+ * @param key_comp_fn - compare user structure with key, 0 when equal
+ * @param offset - offset of glhash_node_t in user structure
+ */
+void glhash_init(glhash_t *glhash, unsigned int size,
+        unsigned int (*hash_fn)(void *key),
+        int (*key_comp_fn)(void *user_data, void *key),
+        int offset);
+
+/**
+ * @brief   free buckets, nodes are owned by caller and left as they are
+ *
+ * @param glhash
+ */
+void glhash_destroy(glhash_t *glhash);
+
+/**
+ * @brief   insert node with key, duplicate keys are allowed (see glhash_lookup_next()),
+ *          doubles table when count reaches buckets, moves GLHASH_MIGRATE_STEP old buckets
+ *
+ * @param glhash
+ * @param glhash_node
+ * @param key - key of user structure holding glhash_node
+ */
+void glhash_insert(glhash_t *glhash, glhash_node_t *glhash_node, void *key);
+
+/**
+ * @brief   first node with key
+ *
+ * @param glhash
+ * @param key
+ * @return glhash_node_t* - NULL when not found
+ */
+glhash_node_t *glhash_lookup(glhash_t *glhash, void *key);
+
+/**
+ * @brief   next node with the same key after glhash_node
+ *
+ * @param glhash
+ * @param glhash_node - node returned by glhash_lookup() / glhash_lookup_next()
+ * @param key
+ * @return glhash_node_t* - NULL when no more
+ */
+glhash_node_t *glhash_lookup_next(glhash_t *glhash, glhash_node_t *glhash_node, void *key);
+
+/**
+ * @brief   unlink node, it must be in table
+ *
+ * @param glhash
+ * @param glhash_node
+ */
+void glhash_remove(glhash_t *glhash, glhash_node_t *glhash_node);
+
+/* iteration, see ITERATE_GLHASH_BEGIN() */
+glhash_node_t *glhash_first(glhash_t *glhash);
+
+glhash_node_t *glhash_next(glhash_t *glhash, glhash_node_t *glhash_node);
+
+/**
+ * @brief   initiate striped table
+ *
+ * @param glhash_striped
+ * @param stripes - rounded up to a power of two, about the number of threads using the table
+ * @param size - expected nodes per stripe
+ * @param hash_fn
+ * @param key_comp_fn
+ * @param offset
+ */
+void glhash_striped_init(glhash_striped_t *glhash_striped, unsigned int stripes, unsigned int size,
+        unsigned int (*hash_fn)(void *key),
+        int (*key_comp_fn)(void *user_data, void *key),
+        int offset);
+
+/**
+ * @brief   free stripes, nodes are owned by caller
+ *
+ * @param glhash_striped
+ */
+void glhash_striped_destroy(glhash_striped_t *glhash_striped);
+
+/**
+ * @brief   lock stripe of key, for compound operations (look up then insert / update)
+ *
+ * @param glhash_striped
+ * @param key
+ * @return glhash_t* - stripe table, use the plain glhash_* calls on it until glhash_striped_unlock()
+ */
+glhash_t *glhash_striped_lock(glhash_striped_t *glhash_striped, void *key);
+
+void glhash_striped_unlock(glhash_striped_t *glhash_striped, void *key);
+
+/**
+ * @brief   insert node unless key is already in table
+ *
+ * @param glhash_striped
+ * @param glhash_node
+ * @param key
+ * @return glhash_node_t* - NULL when inserted, else node already holding key
+ */
+glhash_node_t *glhash_striped_insert(glhash_striped_t *glhash_striped, glhash_node_t *glhash_node, void *key);
+
+/**
+ * @brief   node with key
+ *
+ * @note    stripe is unlocked on return, caller keeps the node alive against concurrent remove
+ *
+ * @param glhash_striped
+ * @param key
+ * @return glhash_node_t* - NULL when not found
+ */
+glhash_node_t *glhash_striped_lookup(glhash_striped_t *glhash_striped, void *key);
+
+/**
+ * @brief   unlink node, it must be in table
+ *
+ * @param glhash_striped
+ * @param glhash_node
+ */
+void glhash_striped_remove(glhash_striped_t *glhash_striped, glhash_node_t *glhash_node);
+
+/**
+ * @brief   nodes in all stripes, stripes are counted one after the other
+ *
+ * @param glhash_striped
+ * @return unsigned int
+ */
+unsigned int glhash_striped_count(glhash_striped_t *glhash_striped);
+
+#endif /* __GLHASH__ */
@@ -0,0 +1,318 @@
+/**
+ * @file glhash_test.c
+ * @author agent
+ * @brief  This file tests glhash_t: inserts, lookups, removes and iteration while old buckets are
+ *         still being moved to a resized table, duplicate keys, then glhash_striped_t filled and
+ *         emptied by threads racing on the same keys
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "glhash.h"
+
+#define ITEMS               5000
+#define DUPLICATES          4
+#define STRIPED_THREADS     4
+#define STRIPED_ITEMS       20000
+
+typedef struct item_{
+
+    int key;
+    int in_table;
+    glhash_node_t hash_glue;
+} item_t;
+GLHASH_TO_STRUCT(hash_glue_to_item, item_t, hash_glue);
+
+static unsigned int item_hash(void *key)
+{
+    return glhash_bytes(key, sizeof(int));
+}
+
+/* few distinct hashes, long chains for every bucket move */
+static unsigned int item_hash_narrow(void *key)
+{
+    return glhash_bytes(key, sizeof(int)) & 0x3f;
+}
+
+static int item_key_comp(void *user_data, void *key)
+{
+    return ((item_t *)user_data)->key != *(int *)key;
+}
+
+/**
+ * @brief   nodes of key found by lookup / lookup next
+ *
+ * @param glhash
+ * @param key
+ * @return int - -1 when a node of another key or of a removed item shows up
+ */
+static int lookup_count(glhash_t *glhash, int key)
+{
+    glhash_node_t *node;
+    int count = 0;
+
+    for(node = glhash_lookup(glhash, &key); node; node = glhash_lookup_next(glhash, node, &key))
+    {
+        if(hash_glue_to_item(node)->key != key || !hash_glue_to_item(node)->in_table)
+        {
+            return -1;
+        }
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief   insert keys one at a time, while a resize is in progress check every key inserted
+ *          so far, remove some of them and walk the table
+ *
+ * @param hash_fn
+ * @param name
+ * @return int - 0 when table always matched the items
+ */
+static int test_resize(unsigned int (*hash_fn)(void *key), const char *name)
+{
+    item_t *items = calloc(ITEMS, sizeof(item_t));
+    glhash_t glhash;
+    glhash_node_t *node;
+    unsigned int count = 0, seen, size, resizes = 0, migrating_inserts = 0, migrating_removes = 0;
+    unsigned long bad = 0;
+    int i, j;
+
+    glhash_init(&glhash, 0, hash_fn, item_key_comp, offsetof(item_t, hash_glue));
+
+    for(i = 0; i < ITEMS; i++)
+    {
+        items[i].key = i;
+        size = glhash.size;
+        glhash_insert(&glhash, &items[i].hash_glue, &items[i].key);
+        resizes += glhash.size != size;
+        items[i].in_table = 1;
+        count++;
+
+        if(!glhash.old_buckets)
+        {
+            continue;
+        }
+
+        /* nodes are split between old and new buckets now */
+        migrating_inserts++;
+        if(i % 3 == 0)
+        {
+            j = rand() % (i + 1);
+            if(items[j].in_table)
+            {
+                glhash_remove(&glhash, &items[j].hash_glue);
+                items[j].in_table = 0;
+                count--;
+                migrating_removes++;
+            }
+        }
+
+        for(j = 0; j <= i; j++)
+        {
+            bad += lookup_count(&glhash, j) != items[j].in_table;
+        }
+
+        seen = 0;
+        ITERATE_GLHASH_BEGIN(&glhash, node){
+            bad += !hash_glue_to_item(node)->in_table;
+            seen++;
+        } ITERATE_GLHASH_END(&glhash, node);
+        bad += seen != count;
+    }
+
+    /* resize finished, everything still there */
+    for(j = 0; j < ITEMS; j++)
+    {
+        bad += lookup_count(&glhash, j) != items[j].in_table;
+    }
+    bad += GLHASH_COUNT(&glhash) != count;
+
+    printf("resize %-6s items %u, resizes %u, inserts while migrating %u, removes while migrating %u, bad %lu, %s\n",
+            name, count, resizes, migrating_inserts, migrating_removes, bad, bad == 0 && resizes > 0 &&
+            migrating_removes > 0 ? "ok" : "FAILED");
+
+    glhash_destroy(&glhash);
+    free(items);
+    return bad == 0 && resizes > 0 && migrating_removes > 0 ? 0 : 1;
+}
+
+/**
+ * @brief   same key inserted several times, lookup next finds all of them across resizes
+ *
+ * @return int - 0 on success
+ */
+static int test_duplicates(void)
+{
+    item_t *items = calloc(ITEMS, sizeof(item_t));
+    glhash_t glhash;
+    unsigned long bad = 0;
+    int i;
+
+    glhash_init(&glhash, 0, item_hash, item_key_comp, offsetof(item_t, hash_glue));
+    for(i = 0; i < ITEMS; i++)
+    {
+        items[i].key = i / DUPLICATES;
+        items[i].in_table = 1;
+        glhash_insert(&glhash, &items[i].hash_glue, &items[i].key);
+    }
+    for(i = 0; i < ITEMS / DUPLICATES; i++)
+    {
+        bad += lookup_count(&glhash, i) != DUPLICATES;
+    }
+
+    /* drop one of each, the rest stay reachable */
+    for(i = 0; i < ITEMS; i += DUPLICATES)
+    {
+        glhash_remove(&glhash, &items[i].hash_glue);
+        items[i].in_table = 0;
+    }
+    for(i = 0; i < ITEMS / DUPLICATES; i++)
+    {
+        bad += lookup_count(&glhash, i) != DUPLICATES - 1;
+    }
+
+    printf("duplicates    keys %u, bad %lu, %s\n", ITEMS / DUPLICATES, bad, bad == 0 ? "ok" : "FAILED");
+    glhash_destroy(&glhash);
+    free(items);
+    return bad == 0 ? 0 : 1;
+}
+
+typedef struct striped_arg_{
+
+    glhash_striped_t *glhash_striped;
+    item_t *items;                  /* own items of thread, keys shared by all threads */
+    unsigned long inserted;
+    unsigned long removed;
+    unsigned long bad;
+} striped_arg_t;
+
+/**
+ * @brief   every thread inserts every key unless present, then removes the ones it inserted
+ *          once all threads inserted, so each key is inserted and removed exactly once
+ *
+ * @param arg - striped_arg_t - pointer
+ * @return void*
+ */
+static void *striped_insert_fn(void *arg)
+{
+    striped_arg_t *striped_arg = (striped_arg_t *) arg;
+    item_t *item;
+    glhash_node_t *found;
+
+    for(int i = 0; i < STRIPED_ITEMS; i++)
+    {
+        item = &striped_arg->items[i];
+        item->key = i;
+        found = glhash_striped_insert(striped_arg->glhash_striped, &item->hash_glue, &item->key);
+        if(found == NULL)
+        {
+            item->in_table = 1;
+            striped_arg->inserted++;
+        }
+        else
+        {
+            striped_arg->bad += hash_glue_to_item(found)->key != i;
+        }
+    }
+    return NULL;
+}
+
+static void *striped_remove_fn(void *arg)
+{
+    striped_arg_t *striped_arg = (striped_arg_t *) arg;
+    item_t *item;
+
+    for(int i = 0; i < STRIPED_ITEMS; i++)
+    {
+        item = &striped_arg->items[i];
+        if(!item->in_table)
+        {
+            continue;
+        }
+        striped_arg->bad += glhash_striped_lookup(striped_arg->glhash_striped, &item->key) == NULL;
+        glhash_striped_remove(striped_arg->glhash_striped, &item->hash_glue);
+        item->in_table = 0;
+        striped_arg->removed++;
+    }
+    return NULL;
+}
+
+/**
+ * @brief   striped table under concurrent insert unless present, lookup and remove
+ *
+ * @return int - 0 on success
+ */
+static int test_striped(void)
+{
+    glhash_striped_t glhash_striped;
+    striped_arg_t args[STRIPED_THREADS];
+    pthread_t threads[STRIPED_THREADS];
+    unsigned long inserted = 0, removed = 0, bad = 0;
+    unsigned int full_count;
+    glhash_t *stripe;
+    int key;
+
+    glhash_striped_init(&glhash_striped, STRIPED_THREADS, 0, item_hash, item_key_comp,
+            offsetof(item_t, hash_glue));
+
+    for(int i = 0; i < STRIPED_THREADS; i++)
+    {
+        args[i].glhash_striped = &glhash_striped;
+        args[i].items = calloc(STRIPED_ITEMS, sizeof(item_t));
+        args[i].inserted = args[i].removed = args[i].bad = 0;
+        pthread_create(&threads[i], NULL, striped_insert_fn, &args[i]);
+    }
+    for(int i = 0; i < STRIPED_THREADS; i++)
+    {
+        pthread_join(threads[i], NULL);
+        inserted += args[i].inserted;
+    }
+    full_count = glhash_striped_count(&glhash_striped);
+
+    /* compound operation under stripe lock, key stays in table */
+    key = STRIPED_ITEMS / 2;
+    stripe = glhash_striped_lock(&glhash_striped, &key);
+    bad += lookup_count(stripe, key) != 1;
+    glhash_striped_unlock(&glhash_striped, &key);
+
+    for(int i = 0; i < STRIPED_THREADS; i++)
+    {
+        pthread_create(&threads[i], NULL, striped_remove_fn, &args[i]);
+    }
+    for(int i = 0; i < STRIPED_THREADS; i++)
+    {
+        pthread_join(threads[i], NULL);
+        removed += args[i].removed;
+        bad += args[i].bad;
+        free(args[i].items);
+    }
+
+    bad += inserted != STRIPED_ITEMS || full_count != STRIPED_ITEMS || removed != STRIPED_ITEMS ||
+           glhash_striped_count(&glhash_striped) != 0;
+    printf("striped       threads %u, stripes %u, inserted %lu, removed %lu, bad %lu, %s\n",
+            STRIPED_THREADS, glhash_striped.stripe_count, inserted, removed, bad, bad == 0 ? "ok" : "FAILED");
+
+    glhash_striped_destroy(&glhash_striped);
+    return bad == 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    int rc = 0;
+
+    srand(1);
+    rc |= test_resize(item_hash, "spread");
+    rc |= test_resize(item_hash_narrow, "narrow");
+    rc |= test_duplicates();
+    rc |= test_striped();
+    return rc;
+}
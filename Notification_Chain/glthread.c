@@ -197,6 +197,191 @@ dequeue_glthread_first(glthread_t *base_glthread){
     return temp;
 }
 
+void
+init_glthread_list(glthread_list_t *glthread_list){
+
+    init_glthread(&glthread_list->head);
+    glthread_list->tail = NULL;
+    glthread_list->count = 0;
+}
+
+void
+glthread_list_add_last(glthread_list_t *glthread_list, glthread_t *new_glthread){
+
+    glthread_add_next(glthread_list->tail ? glthread_list->tail : &glthread_list->head, new_glthread);
+    glthread_list->tail = new_glthread;
+    glthread_list->count++;
+}
+
+void
+glthread_list_add_first(glthread_list_t *glthread_list, glthread_t *new_glthread){
+
+    glthread_add_next(&glthread_list->head, new_glthread);
+    if(!glthread_list->tail)
+        glthread_list->tail = new_glthread;
+    glthread_list->count++;
+}
+
+void
+glthread_list_remove(glthread_list_t *glthread_list, glthread_t *glthread){
+
+    if(glthread_list->tail == glthread)
+        glthread_list->tail = glthread->left == &glthread_list->head ? NULL : glthread->left;
+    remove_glthread(glthread);
+    glthread_list->count--;
+}
+
+glthread_t *
+glthread_list_dequeue_first(glthread_list_t *glthread_list){
+
+    glthread_t *temp = glthread_list->head.right;
+
+    if(!temp)
+        return NULL;
+    glthread_list_remove(glthread_list, temp);
+    return temp;
+}
+
+/* pairing heap */
+
+#define GLHEAP_LESS(glheap, a, b)   \
+    ((glheap)->comp_fn(GLTHREAD_GET_USER_DATA_FROM_OFFSET(a, (glheap)->offset), \
+                       GLTHREAD_GET_USER_DATA_FROM_OFFSET(b, (glheap)->offset)) < 0)
+
+/* make the larger of two root nodes the leftmost child of the other,
+ * returns the new root, its next / prev are left to the caller */
+static glheap_node_t *
+glheap_link(glheap_t *glheap, glheap_node_t *a, glheap_node_t *b){
+
+    glheap_node_t *temp;
+
+    if(GLHEAP_LESS(glheap, b, a)){
+        temp = a;
+        a = b;
+        b = temp;
+    }
+    b->prev = a;
+    b->next = a->child;
+    if(a->child)
+        a->child->prev = b;
+    a->child = b;
+    return a;
+}
+
+/* two pass merge of a sibling list, left to right in pairs,
+ * then the pairs right to left, returns the new root */
+static glheap_node_t *
+glheap_merge_pairs(glheap_t *glheap, glheap_node_t *first){
+
+    glheap_node_t *pairs = NULL,
+                  *a, *b, *root;
+
+    while(first){
+        a = first;
+        b = a->next;
+        if(!b){
+            a->next = pairs;
+            pairs = a;
+            break;
+        }
+        first = b->next;
+        a = glheap_link(glheap, a, b);
+        a->next = pairs;
+        pairs = a;
+    }
+
+    /* pairs is reversed, last pair first */
+    root = pairs;
+    pairs = pairs->next;
+    while(pairs){
+        a = pairs->next;
+        root = glheap_link(glheap, root, pairs);
+        pairs = a;
+    }
+    root->next = NULL;
+    root->prev = NULL;
+    return root;
+}
+
+/* unlink a non root node and its subtree from its parent */
+static void
+glheap_cut(glheap_node_t *glheap_node){
+
+    if(glheap_node->prev->child == glheap_node)
+        glheap_node->prev->child = glheap_node->next;
+    else
+        glheap_node->prev->next = glheap_node->next;
+    if(glheap_node->next)
+        glheap_node->next->prev = glheap_node->prev;
+    glheap_node->next = NULL;
+    glheap_node->prev = NULL;
+}
+
+void
+init_glheap(glheap_t *glheap, int (*comp_fn)(void *, void *), int offset){
+
+    glheap->root = NULL;
+    glheap->count = 0;
+    glheap->comp_fn = comp_fn;
+    glheap->offset = offset;
+}
+
+void
+init_glheap_node(glheap_node_t *glheap_node){
+
+    glheap_node->child = NULL;
+    glheap_node->next = NULL;
+    glheap_node->prev = NULL;
+}
+
+void
+glheap_insert(glheap_t *glheap, glheap_node_t *glheap_node){
+
+    init_glheap_node(glheap_node);
+    glheap->root = glheap->root ? glheap_link(glheap, glheap->root, glheap_node) : glheap_node;
+    glheap->count++;
+}
+
+glheap_node_t *
+glheap_pop_min(glheap_t *glheap){
+
+    glheap_node_t *root = glheap->root;
+
+    if(!root)
+        return NULL;
+    glheap->root = root->child ? glheap_merge_pairs(glheap, root->child) : NULL;
+    glheap->count--;
+    init_glheap_node(root);
+    return root;
+}
+
+void
+glheap_decrease_key(glheap_t *glheap, glheap_node_t *glheap_node){
+
+    if(glheap_node == glheap->root)
+        return;
+    glheap_cut(glheap_node);
+    glheap->root = glheap_link(glheap, glheap->root, glheap_node);
+}
+
+void
+glheap_remove(glheap_t *glheap, glheap_node_t *glheap_node){
+
+    glheap_node_t *subtree;
+
+    if(glheap_node == glheap->root){
+        glheap_pop_min(glheap);
+        return;
+    }
+    glheap_cut(glheap_node);
+    if(glheap_node->child){
+        subtree = glheap_merge_pairs(glheap, glheap_node->child);
+        glheap->root = glheap_link(glheap, glheap->root, subtree);
+    }
+    glheap->count--;
+    init_glheap_node(glheap_node);
+}
+
 #if 0
 void *
 gl_thread_search(glthread_t *glthread_head, 
@@ -40,6 +40,40 @@ typedef struct _glthread{
     struct _glthread *right;
 } glthread_t;
 
+/* list head with tail pointer and element count,
+ * append, pop front, remove and count are O(1).
+ * head is a plain glthread_t head, so IS_GLTHREAD_LIST_EMPTY() and
+ * ITERATE_GLTHREAD_BEGIN() work on GLTHREAD_LIST_HEAD(list) as before,
+ * nodes must be linked and unlinked through glthread_list_* only */
+typedef struct _glthread_list{
+
+    glthread_t head;
+    glthread_t *tail;       /* last node, NULL when empty */
+    unsigned int count;
+} glthread_list_t;
+
+/* intrusive pairing heap node, embed it like glthread_t.
+ * child is the leftmost child, next the right sibling,
+ * prev the left sibling or the parent for a leftmost child */
+typedef struct _glheap_node{
+
+    struct _glheap_node *child;
+    struct _glheap_node *next;
+    struct _glheap_node *prev;
+} glheap_node_t;
+
+/* min pairing heap, replaces glthread_priority_insert() sorted lists,
+ * insert, peek and decrease key are O(1), pop min and remove O(log n) amortized.
+ * comp_fn gets the user structures (node address - offset) and returns
+ * negative when the first one goes out before the second one */
+typedef struct _glheap{
+
+    glheap_node_t *root;    /* min node, NULL when empty */
+    unsigned int count;
+    int (*comp_fn)(void *, void *);
+    int offset;             /* offset of glheap_node_t in user structure */
+} glheap_t;
+
 /* macro defines */
 
 #define IS_QUEUED_UP_IN_THREAD(glthreadptr) \
@@ -82,6 +116,23 @@ typedef struct _glthread{
 #define GLTHREAD_GET_USER_DATA_FROM_OFFSET(glthreadptr, offset)  \
     (void *)((char *)(glthreadptr) - offset)
 
+#define GLTHREAD_LIST_HEAD(glthreadlistptr)         (&(glthreadlistptr)->head)
+
+#define GLTHREAD_LIST_COUNT(glthreadlistptr)        ((glthreadlistptr)->count)
+
+#define IS_GLTHREAD_LIST_T_EMPTY(glthreadlistptr)   ((glthreadlistptr)->count == 0)
+
+#define GLHEAP_TO_STRUCT(fn_name, structure_name, field_name)                          \
+    static inline structure_name * fn_name(glheap_node_t *glheapptr){                  \
+        return (structure_name *)((char *)(glheapptr) - (char *)&(((structure_name *)0)->field_name)); \
+    }
+
+#define GLHEAP_MIN(glheapptr)                       ((glheapptr)->root)
+
+#define GLHEAP_COUNT(glheapptr)                     ((glheapptr)->count)
+
+#define IS_GLHEAP_EMPTY(glheapptr)                  ((glheapptr)->root == 0)
+
 
 /* public operations */
 void
@@ -105,6 +156,7 @@ delete_glthread_list(glthread_t *base_glthread);
 unsigned int 
 get_glthread_list_count(glthread_t *base_glthread);
 
+/* O(n) sorted insert, use glheap_t for priority queues */
 void
 glthread_priority_insert(glthread_t *base_glthread,     
                          glthread_t *glthread,
@@ -114,6 +166,40 @@ glthread_priority_insert(glthread_t *base_glthread,
 glthread_t *
 dequeue_glthread_first(glthread_t *base_glthread);
 
+void
+init_glthread_list(glthread_list_t *glthread_list);
+
+void
+glthread_list_add_last(glthread_list_t *glthread_list, glthread_t *new_glthread);
+
+void
+glthread_list_add_first(glthread_list_t *glthread_list, glthread_t *new_glthread);
+
+void
+glthread_list_remove(glthread_list_t *glthread_list, glthread_t *glthread);
+
+glthread_t *
+glthread_list_dequeue_first(glthread_list_t *glthread_list);
+
+void
+init_glheap(glheap_t *glheap, int (*comp_fn)(void *, void *), int offset);
+
+void
+init_glheap_node(glheap_node_t *glheap_node);
+
+void
+glheap_insert(glheap_t *glheap, glheap_node_t *glheap_node);
+
+glheap_node_t *
+glheap_pop_min(glheap_t *glheap);
+
+/* node key was just lowered by the caller, node must be in heap */
+void
+glheap_decrease_key(glheap_t *glheap, glheap_node_t *glheap_node);
+
+void
+glheap_remove(glheap_t *glheap, glheap_node_t *glheap_node);
+
 #if 0
 void *
 gl_thread_search(glthread_t *base_glthread,
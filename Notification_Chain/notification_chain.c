@@ -1,8 +1,43 @@
 #include"notification_chain.h"
 #include<string.h>
 #include<assert.h>
+#include<stddef.h>
 
+/* key looked up in nfce_key_table */
+typedef struct nfc_key_
+{
+    char *key;
+    size_t key_size;
+}nfc_key_t;
+
+/**
+ * @brief hash of notification key, key table callback
+ * 
+ * @param key - nfc_key_t pointer
+ * @return unsigned int 
+ */
+static unsigned int nfc_key_hash(void *key)
+{
+    nfc_key_t *nfc_key = (nfc_key_t *) key;
+
+    return glhash_bytes(nfc_key->key, nfc_key->key_size);
+}
 
+/**
+ * @brief compare notification chain element key with key, key table callback
+ * 
+ * @param nfce - notif_chain_element_t pointer
+ * @param key - nfc_key_t pointer
+ * @return int - 0 if element has the key
+ */
+static int nfc_key_comp(void *nfce, void *key)
+{
+    notif_chain_element_t *element = (notif_chain_element_t *) nfce;
+    nfc_key_t *nfc_key = (nfc_key_t *) key;
+
+    return !(element->key_size == nfc_key->key_size
+        && memcmp(element->key, nfc_key->key, nfc_key->key_size) == 0);
+}
 
 /**
  * @brief this function register subscription request by the subscriper 
@@ -17,7 +52,17 @@ void nfc_register_notif_chain(notification_chain_t *nfc, notif_chain_element_t *
     memcpy(new_nfce, nfce, sizeof(notif_chain_element_t));
 
     /* add local element to notification data structure */
-    glthread_add_last(&nfc->notification_chain_head, &new_nfce->glue);
+    if(new_nfce->is_key_set && new_nfce->key_size != 0)
+    {
+        nfc_key_t nfc_key = { new_nfce->key, new_nfce->key_size };
+
+        assert(new_nfce->key_size <= MAX_NOTIFI_KEY_SIZE);
+        glhash_insert(&nfc->nfce_key_table, &new_nfce->hash_glue, &nfc_key);
+    }
+    else
+    {
+        glthread_list_add_last(&nfc->notification_chain_head, &new_nfce->glue);
+    }
 }
 
 /**
@@ -36,7 +81,9 @@ void nfc_invoke_notif_chain(notification_chain_t *nfc,
     nfc_op_t update_type)
 {
     glthread_t *curr;
+    glhash_node_t *curr_node;
     notif_chain_element_t *curr_nfce;
+    nfc_key_t nfc_key = { key, key_size };
 
     /**
      * validate key size
@@ -46,36 +93,39 @@ void nfc_invoke_notif_chain(notification_chain_t *nfc,
      */
     assert(key_size <= MAX_NOTIFI_KEY_SIZE);
     
-    /* iterate over all glthread nodes */
-    ITERATE_GLTHREAD_BEGIN(&nfc->notification_chain_head, curr)
+    /**
+     * wild card case
+     * 
+     * subscribers without key get every notification
+     * 
+     */
+    ITERATE_GLTHREAD_BEGIN(GLTHREAD_LIST_HEAD(&nfc->notification_chain_head), curr)
     {
         /* get notification chain element from glthreda node */
         curr_nfce = glthread_glue_to_notif_chain_element(curr);
+        curr_nfce->app_cb(arg, arg_size, update_type, curr_nfce->sub_id);
+
+    }ITERATE_GLTHREAD_END(GLTHREAD_LIST_HEAD(&nfc->notification_chain_head), curr); // mark for iteration end
 
-        /**
-         * wild card case
-         * 
-         * if key not specified or curr_nfce->key not specified
-         * means it is wild card condition 
-         * so the publisher has to invoke the callback
-         * 
-         */
-        if(!( key != NULL && key_size != 0 && curr_nfce->is_key_set && (curr_nfce->key_size == key_size) ))
+    /* key not specified, it is wild card for the publisher, notify all keyed subscribers */
+    if(key == NULL || key_size == 0)
+    {
+        ITERATE_GLHASH_BEGIN(&nfc->nfce_key_table, curr_node)
         {
+            curr_nfce = glhash_glue_to_notif_chain_element(curr_node);
             curr_nfce->app_cb(arg, arg_size, update_type, curr_nfce->sub_id);
-        }
-        /* not wild card */
-        else
-        {
-            /* compare the keys if match invoke the subscriber callback */
-            if( memcmp(curr_nfce->key, key, key_size) == 0 )
-            {
-                curr_nfce->app_cb(arg, arg_size, update_type, curr_nfce->sub_id);
-            }
-
-        }
-        
-    }ITERATE_GLTHREAD_END(&nfc->notification_chain_head, curr); // mark for iteration end
+
+        }ITERATE_GLHASH_END(&nfc->nfce_key_table, curr_node);
+        return;
+    }
+
+    /* not wild card, invoke only the subscribers with matching key */
+    for(curr_node = glhash_lookup(&nfc->nfce_key_table, &nfc_key); curr_node;
+        curr_node = glhash_lookup_next(&nfc->nfce_key_table, curr_node, &nfc_key))
+    {
+        curr_nfce = glhash_glue_to_notif_chain_element(curr_node);
+        curr_nfce->app_cb(arg, arg_size, update_type, curr_nfce->sub_id);
+    }
 }
 /**
  * @brief allocate notification chain data structure pointer and return it
@@ -92,7 +142,9 @@ notification_chain_t *nfc_create_new_notif_chain(char *notif_chain_name)
     {
         strncpy(nfc->nfc_name, notif_chain_name, sizeof(nfc->nfc_name));
     }
-    init_glthread(&nfc->notification_chain_head);
+    init_glthread_list(&nfc->notification_chain_head);
+    glhash_init(&nfc->nfce_key_table, 0, nfc_key_hash, nfc_key_comp,
+        offsetof(notif_chain_element_t, hash_glue));
 
     return nfc;
 }
@@ -106,13 +158,22 @@ notification_chain_t *nfc_create_new_notif_chain(char *notif_chain_name)
 void nfc_delete_all_nfce(notification_chain_t *nfc)
 {
     glthread_t *curr;
+    glhash_node_t *curr_node;
     notif_chain_element_t *curr_nfce;
-    ITERATE_GLTHREAD_BEGIN(&nfc->notification_chain_head, curr)
+    ITERATE_GLTHREAD_BEGIN(GLTHREAD_LIST_HEAD(&nfc->notification_chain_head), curr)
     {
         curr_nfce=glthread_glue_to_notif_chain_element(curr);
-        remove_glthread(&curr_nfce->glue);
+        glthread_list_remove(&nfc->notification_chain_head, &curr_nfce->glue);
         free(curr_nfce);
 
-    }ITERATE_GLTHREAD_END(nfc->notification_chain_head, curr);
+    }ITERATE_GLTHREAD_END(GLTHREAD_LIST_HEAD(&nfc->notification_chain_head), curr);
+
+    ITERATE_GLHASH_BEGIN(&nfc->nfce_key_table, curr_node)
+    {
+        curr_nfce = glhash_glue_to_notif_chain_element(curr_node);
+        glhash_remove(&nfc->nfce_key_table, curr_node);
+        free(curr_nfce);
 
+    }ITERATE_GLHASH_END(&nfc->nfce_key_table, curr_node);
+    glhash_destroy(&nfc->nfce_key_table);
 }
\ No newline at end of file
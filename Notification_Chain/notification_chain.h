@@ -14,6 +14,7 @@
 #define NOTIFICATION_CHAIN_H
 
 #include"glthread.h"
+#include"glhash.h"
 #include"ctype.h"
 #include<stdlib.h>
 #include<stdbool.h>
@@ -92,7 +93,8 @@ typedef struct notif_chain_element_
     bool is_key_set;
     /* notification callback pointer*/
     nfc_app_cb app_cb;
-    glthread_t glue;
+    glthread_t glue;            /* in notification_chain_head, subscribers without key */
+    glhash_node_t hash_glue;    /* in nfce_key_table, subscribers with key */
 
 
 }notif_chain_element_t;
@@ -106,11 +108,20 @@ typedef struct notif_chain_element_
  */
 GLTHREAD_TO_STRUCT(glthread_glue_to_notif_chain_element, notif_chain_element_t, glue);
 
+/**
+ * @brief get notification chain element from its key table node
+ * 
+ * @param glhash_node_t - glue pointer to hash node
+ * 
+ */
+GLHASH_TO_STRUCT(glhash_glue_to_notif_chain_element, notif_chain_element_t, hash_glue);
+
 /* NFC struct  */
 typedef struct notification_chain_
 {
     char nfc_name[MAX_NOTIFI_CHAIN_NAME];
-    glthread_t notification_chain_head;
+    glthread_list_t notification_chain_head;   /* wild card subscribers in registration order, O(1) append */
+    glhash_t nfce_key_table;                   /* subscribers with key, by key */
 }notification_chain_t;
 
 
@@ -14,6 +14,35 @@
 #include<stdlib.h>
 #include<assert.h>
 #include<string.h>
+#include<stddef.h>
+
+/**
+ * @brief hash of routing table entry key, hash table callback
+ * 
+ * @param key - rt_entry_key_t pointer, zero padded dest_ip
+ * @return unsigned int 
+ */
+static unsigned int rt_entry_key_hash(void *key)
+{
+    return glhash_bytes(key, sizeof(rt_entry_key_t));
+}
+
+/**
+ * @brief compare routing table entry with key, hash table callback
+ * 
+ * @param rt_entry - rt_entry_t pointer
+ * @param key - rt_entry_key_t pointer
+ * @return int - 0 if entry has the key
+ */
+static int rt_entry_key_comp(void *rt_entry, void *key)
+{
+    rt_entry_key_t *entry_key = &((rt_entry_t *) rt_entry)->rt_entry_key;
+    rt_entry_key_t *lookup_key = (rt_entry_key_t *) key;
+
+    return !(entry_key->mask == lookup_key->mask
+        && strncmp(entry_key->dest_ip, lookup_key->dest_ip, sizeof(entry_key->dest_ip)) == 0);
+}
+
 /**
  * @brief initiate routing table data source 
  * 
@@ -22,6 +51,8 @@
 void rt_init_rt_table(rt_table_t *rt_table)
 {
     rt_table->head = NULL;
+    glhash_init(&rt_table->rt_entry_table, 0, rt_entry_key_hash, rt_entry_key_comp,
+        offsetof(rt_entry_t, hash_glue));
 }
 /**
  * @brief fetch routing data entry
@@ -34,23 +65,22 @@ void rt_init_rt_table(rt_table_t *rt_table)
 rt_entry_t *rt_look_up_rt_entry(rt_table_t *rt_table, 
 					char *dest, char mask)
 {
-    rt_entry_t *fetched_entry = NULL;
+    rt_entry_key_t key;
+    glhash_node_t *fetched_node;
 
-    /* iterate over all linked list with <fetched_entry> pointer */
-    ITERTAE_RT_TABLE_BEGIN(rt_table, fetched_entry)
-    {
-        /* data entry found */
-        if(fetched_entry->rt_entry_key.mask == mask 
-            && strncmp(fetched_entry->rt_entry_key.dest_ip, dest,
-                sizeof(fetched_entry->rt_entry_key.dest_ip)) == 0 )
-        {
-            return fetched_entry;
-        }
+    /* key as stored in entries, zero padded so it hashes the same */
+    memset(&key, 0, sizeof(key));
+    strncpy(key.dest_ip, dest, sizeof(key.dest_ip));
+    key.mask = mask;
 
-    }ITERTAE_RT_TABLE_END(rt_table, fetched_entry);
+    fetched_node = glhash_lookup(&rt_table->rt_entry_table, &key);
 
     /* data entry not found */
-    return NULL;
+    if(!fetched_node)
+    {
+        return NULL;
+    }
+    return glhash_glue_to_rt_entry(fetched_node);
 }
 /**
  * @brief add or update routing table data source
@@ -117,7 +147,9 @@ rt_entry_t *rt_add_or_update_rt_entry(rt_table_t *rt_table,
         {
             head->prev = rt_entry;
         }
-        
+
+        /* index entry by its key */
+        glhash_insert(&rt_table->rt_entry_table, &rt_entry->hash_glue, &rt_entry->rt_entry_key);
     }
 
     /* case publisher thread modify data entry */
@@ -151,6 +183,7 @@ bool rt_delete_rt_entry(rt_table_t *rt_table,
     {
         /* remove data entry from routing table linked list */
         rt_entry_remove(rt_table, fetched_entry);
+        glhash_remove(&rt_table->rt_entry_table, &fetched_entry->hash_glue);
 
         /* destroy subscribers nfc and notfy subscribers */
         nfc_invoke_notif_chain(fetched_entry->subs_notif_chain,
@@ -190,7 +223,7 @@ void rt_dump_rt_table(rt_table_t *rt_table)
 		glthread_t *curr;
 		notif_chain_element_t *nfce;
 
-		ITERATE_GLTHREAD_BEGIN(&rt_entry_curr->subs_notif_chain->notification_chain_head, curr)
+		ITERATE_GLTHREAD_BEGIN(GLTHREAD_LIST_HEAD(&rt_entry_curr->subs_notif_chain->notification_chain_head), curr)
         {
 
 			nfce = glthread_glue_to_notif_chain_element(curr);
@@ -198,6 +231,17 @@ void rt_dump_rt_table(rt_table_t *rt_table)
 			printf("%u ", nfce->sub_id);
 
 		} ITERATE_GLTHREAD_END(&rt_entry->nfc->notif_chain_head, curr)
+
+		glhash_node_t *curr_node;
+
+		ITERATE_GLHASH_BEGIN(&rt_entry_curr->subs_notif_chain->nfce_key_table, curr_node)
+        {
+
+			nfce = glhash_glue_to_notif_chain_element(curr_node);
+			
+			printf("%u ", nfce->sub_id);
+
+		} ITERATE_GLHASH_END(&rt_entry_curr->subs_notif_chain->nfce_key_table, curr_node)
 		printf("\n");
 
 
@@ -16,6 +16,7 @@
 #include<stdlib.h>
 #include<stdio.h>
 #include "notification_chain.h"
+#include "glhash.h"
 
 /* macros */
 #define MAX_IP_SIZE 16
@@ -36,12 +37,20 @@ typedef struct rt_entry_
     char gateway_ip[MAX_IP_SIZE];
     struct rt_entry_ *next;
     struct rt_entry_ *prev;
+    glhash_node_t hash_glue; // node in routing table look up hash, keyed by rt_entry_key
     notification_chain_t *subs_notif_chain; // subscribers notification chain data structure
 }rt_entry_t;
 
+/**
+ * @brief get routing table entry from its look up hash node
+ * 
+ */
+GLHASH_TO_STRUCT(glhash_glue_to_rt_entry, rt_entry_t, hash_glue);
+
 typedef struct rt_table_
 {
     rt_entry_t *head;
+    glhash_t rt_entry_table; // entries by key, look up without walking the list
 }rt_table_t;
 
 /*************** operations ****************/
@@ -0,0 +1,93 @@
+/**
+ * @file fiber_app.c
+ * @author agent
+ * @brief  demo of many fibers multiplexed on two thread pool workers,
+ *         fibers block on a wait queue and a barrier without blocking workers
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "threadlib.h"
+#include "fiber.h"
+
+#define FIBERS_COUNT    1000
+#define WORKERS_COUNT   2
+
+static wait_queue_t wq;
+static th_barrier_t barrier;
+static pthread_mutex_t gate_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool gate_open = false;
+static uint32_t passed = 0;
+
+/* wait queue condition: block while gate closed */
+static bool gate_closed(void *arg, pthread_mutex_t **out_mutex)
+{
+    if(out_mutex)
+    {
+        *out_mutex = &gate_mutex;
+        pthread_mutex_lock(&gate_mutex);
+    }
+    return !gate_open;
+}
+
+static void *fiber_fn(void *arg)
+{
+    /* block fiber until gate open, worker keeps running other fibers */
+    wait_queue_test_and_wait(&wq, gate_closed, arg);
+    passed++;
+    pthread_mutex_unlock(&gate_mutex);
+
+    /* all fibers meet at barrier */
+    thread_barrier_wait(&barrier);
+    return NULL;
+}
+
+static void *opener_fn(void *arg)
+{
+    /* last fiber open the gate for all others */
+    pthread_mutex_lock(&gate_mutex);
+    gate_open = true;
+    wait_queue_broadcast(&wq, false);
+    pthread_mutex_unlock(&gate_mutex);
+
+    thread_barrier_wait(&barrier);
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    thread_pool_t *th_pool = calloc(1, sizeof(thread_pool_t));
+    fiber_sched_t sched;
+    char name[32];
+
+    thread_pool_init(th_pool);
+    for(int i = 0; i < WORKERS_COUNT; i++)
+    {
+        sprintf(name, "worker%d", i);
+        thread_pool_insert_new_thread(th_pool, thread_create(NULL, name));
+    }
+
+    wait_queue_init(&wq);
+    thread_barrier_init(&barrier, FIBERS_COUNT + 1);
+
+    fiber_sched_init(&sched, 0);
+    for(int i = 0; i < FIBERS_COUNT; i++)
+    {
+        sprintf(name, "fiber%d", i);
+        fiber_create(&sched, name, fiber_fn, NULL);
+    }
+    fiber_create(&sched, "opener", opener_fn, NULL);
+
+    printf("running %d fibers on %u workers\n", FIBERS_COUNT + 1,
+            fiber_sched_start(&sched, th_pool, WORKERS_COUNT));
+    fiber_sched_join(&sched);
+    fiber_sched_destroy(&sched);
+
+    printf("%u fibers passed the wait queue and the barrier\n", passed);
+    return 0;
+}
@@ -0,0 +1,336 @@
+/**
+ * @file hazard_app.c
+ * @author agent
+ * @brief  lock-free stack (Treiber) and queue (Michael-Scott) reclaimed with hazard pointers:
+ *         producer threads push numbered nodes, consumer threads pop them and free them through
+ *         th_hp_retire(). every value must come out exactly once and every node must be freed,
+ *         freed nodes are poisoned so a read after free shows up as a bad value
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <pthread.h>
+#include "threadlib.h"
+#include "th_hazard.h"
+
+#define PRODUCERS           4
+#define CONSUMERS           4
+#define ITEMS_PER_PRODUCER  250000
+#define ITEMS_COUNT         ((uint64_t)PRODUCERS * ITEMS_PER_PRODUCER)
+#define POISON              0xdeadbeefdeadbeefULL
+
+typedef struct lf_node_
+{
+    uint64_t value;
+    struct lf_node_ *_Atomic next;
+    th_hp_head_t hp_head;
+}lf_node_t;
+
+typedef struct lf_stack_
+{
+    _Alignas(TH_CACHE_LINE_SIZE) lf_node_t *_Atomic top;
+}lf_stack_t;
+
+typedef struct lf_queue_
+{
+    _Alignas(TH_CACHE_LINE_SIZE) lf_node_t *_Atomic head;      /* dummy node, first value is head->next */
+    _Alignas(TH_CACHE_LINE_SIZE) lf_node_t *_Atomic tail;
+}lf_queue_t;
+
+typedef struct bench_
+{
+    bool use_queue;
+    lf_stack_t stack;
+    lf_queue_t queue;
+    th_hp_domain_t domain;
+    _Atomic uint64_t next_value;                /* next value a producer pushes */
+    _Atomic uint64_t popped;
+    _Atomic uint64_t sum;
+    _Atomic uint64_t bad;
+}bench_t;
+
+static _Atomic uint64_t nodes_freed = 0;
+
+static lf_node_t *lf_node_create(uint64_t value)
+{
+    lf_node_t *node = malloc(sizeof(lf_node_t));
+
+    node->value = value;
+    atomic_init(&node->next, NULL);
+    return node;
+}
+
+static void lf_node_free(th_hp_head_t *head)
+{
+    lf_node_t *node = (lf_node_t *)((char *)head - offsetof(lf_node_t, hp_head));
+
+    node->value = POISON;
+    free(node);
+    atomic_fetch_add_explicit(&nodes_freed, 1, memory_order_relaxed);
+}
+
+/*********** lock-free stack **********/
+
+static void lf_stack_push(lf_stack_t *stack, lf_node_t *node)
+{
+    lf_node_t *top = atomic_load(&stack->top);
+
+    do
+    {
+        atomic_store_explicit(&node->next, top, memory_order_relaxed);
+    } while(!atomic_compare_exchange_weak(&stack->top, &top, node));
+}
+
+/**
+ * @brief   pop top node, top is protected while its next is read, so it can not be
+ *          freed and its address reused under us (no ABA)
+ *
+ * @param stack
+ * @param hp
+ * @return lf_node_t* - popped node, caller retires it once done with it, NULL if empty
+ */
+static lf_node_t *lf_stack_pop(lf_stack_t *stack, th_hp_record_t *hp)
+{
+    lf_node_t *top;
+
+    for(;;)
+    {
+        top = th_hp_protect(hp, 0, (void *_Atomic *)&stack->top);
+        if(top == NULL)
+        {
+            return NULL;
+        }
+        if(atomic_compare_exchange_strong(&stack->top, &top, atomic_load(&top->next)))
+        {
+            th_hp_clear(hp, 0);
+            return top;
+        }
+    }
+}
+
+/*********** lock-free queue **********/
+
+static void lf_queue_init(lf_queue_t *queue)
+{
+    lf_node_t *dummy = lf_node_create(0);
+
+    atomic_init(&queue->head, dummy);
+    atomic_init(&queue->tail, dummy);
+}
+
+static void lf_queue_enqueue(lf_queue_t *queue, lf_node_t *node, th_hp_record_t *hp)
+{
+    lf_node_t *tail, *next;
+
+    for(;;)
+    {
+        tail = th_hp_protect(hp, 0, (void *_Atomic *)&queue->tail);
+        next = atomic_load(&tail->next);
+        if(tail != atomic_load(&queue->tail))
+        {
+            continue;
+        }
+        if(next != NULL)
+        {
+            /* help lagging tail along */
+            atomic_compare_exchange_strong(&queue->tail, &tail, next);
+            continue;
+        }
+        if(atomic_compare_exchange_strong(&tail->next, &next, node))
+        {
+            atomic_compare_exchange_strong(&queue->tail, &tail, node);
+            th_hp_clear(hp, 0);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief   dequeue first value, old dummy is retired and the dequeued node becomes the dummy
+ *
+ * @param queue
+ * @param hp
+ * @param value
+ * @return true - value dequeued, false - queue empty
+ */
+static bool lf_queue_dequeue(lf_queue_t *queue, th_hp_record_t *hp, uint64_t *value)
+{
+    lf_node_t *head, *tail, *next;
+
+    for(;;)
+    {
+        head = th_hp_protect(hp, 0, (void *_Atomic *)&queue->head);
+        tail = atomic_load(&queue->tail);
+        next = th_hp_protect(hp, 1, (void *_Atomic *)&head->next);
+        if(head != atomic_load(&queue->head))
+        {
+            continue;
+        }
+        if(next == NULL)
+        {
+            th_hp_clear(hp, 0);
+            th_hp_clear(hp, 1);
+            return false;
+        }
+        if(head == tail)
+        {
+            atomic_compare_exchange_strong(&queue->tail, &tail, next);
+            continue;
+        }
+        /* next is protected, its value is read before head moves past it */
+        *value = next->value;
+        if(atomic_compare_exchange_strong(&queue->head, &head, next))
+        {
+            th_hp_clear(hp, 0);
+            th_hp_clear(hp, 1);
+            th_hp_retire(hp, head, &head->hp_head, lf_node_free);
+            return true;
+        }
+    }
+}
+
+/*********** producers and consumers **********/
+
+static void *producer_fn(void *arg)
+{
+    bench_t *bench = (bench_t *) arg;
+    th_hp_record_t *hp = th_hp_acquire(&bench->domain);
+    uint64_t value;
+
+    for(uint32_t i = 0; i < ITEMS_PER_PRODUCER; i++)
+    {
+        value = atomic_fetch_add(&bench->next_value, 1);
+        if(bench->use_queue)
+        {
+            lf_queue_enqueue(&bench->queue, lf_node_create(value), hp);
+        }
+        else
+        {
+            lf_stack_push(&bench->stack, lf_node_create(value));
+        }
+    }
+    th_hp_release(hp);
+    return NULL;
+}
+
+static void *consumer_fn(void *arg)
+{
+    bench_t *bench = (bench_t *) arg;
+    th_hp_record_t *hp = th_hp_acquire(&bench->domain);
+    lf_node_t *node;
+    uint64_t value;
+    bool got;
+
+    while(atomic_load(&bench->popped) < ITEMS_COUNT)
+    {
+        if(bench->use_queue)
+        {
+            got = lf_queue_dequeue(&bench->queue, hp, &value);
+        }
+        else
+        {
+            node = lf_stack_pop(&bench->stack, hp);
+            got = node != NULL;
+            if(got)
+            {
+                value = node->value;
+                th_hp_retire(hp, node, &node->hp_head, lf_node_free);
+            }
+        }
+
+        if(!got)
+        {
+            sched_yield();
+            continue;
+        }
+        if(value == 0 || value > ITEMS_COUNT)
+        {
+            atomic_fetch_add(&bench->bad, 1);
+        }
+        atomic_fetch_add(&bench->sum, value);
+        atomic_fetch_add(&bench->popped, 1);
+    }
+    th_hp_release(hp);
+    return NULL;
+}
+
+/**
+ * @brief   run producers and consumers on stack or queue
+ *
+ * @param use_queue
+ * @return int - 0 when every value came out once and every node was freed
+ */
+static int bench_run(bool use_queue)
+{
+    pthread_t producers[PRODUCERS], consumers[CONSUMERS];
+    bench_t *bench = aligned_alloc(TH_CACHE_LINE_SIZE, sizeof(bench_t));
+    struct timespec begin, end;
+    uint64_t expected_sum = ITEMS_COUNT * (ITEMS_COUNT + 1) / 2;
+    uint64_t freed_before = atomic_load(&nodes_freed);
+    uint64_t freed_in_run;
+    double elapsed_ms;
+    bool ok;
+
+    memset(bench, 0, sizeof(bench_t));
+    bench->use_queue = use_queue;
+    atomic_init(&bench->next_value, 1);
+    th_hp_domain_init(&bench->domain, 0);
+    if(use_queue)
+    {
+        lf_queue_init(&bench->queue);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for(int i = 0; i < CONSUMERS; i++)
+    {
+        pthread_create(&consumers[i], NULL, consumer_fn, bench);
+    }
+    for(int i = 0; i < PRODUCERS; i++)
+    {
+        pthread_create(&producers[i], NULL, producer_fn, bench);
+    }
+    for(int i = 0; i < PRODUCERS; i++)
+    {
+        pthread_join(producers[i], NULL);
+    }
+    for(int i = 0; i < CONSUMERS; i++)
+    {
+        pthread_join(consumers[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    freed_in_run = atomic_load(&nodes_freed) - freed_before;
+    /* no thread left, everything still retired goes now */
+    th_hp_domain_destroy(&bench->domain);
+    elapsed_ms = (end.tv_sec - begin.tv_sec) * 1e3 + (end.tv_nsec - begin.tv_nsec) / 1e6;
+
+    ok = atomic_load(&bench->bad) == 0 && atomic_load(&bench->sum) == expected_sum &&
+         atomic_load(&nodes_freed) - freed_before == ITEMS_COUNT;
+    printf("%-6s items %lu, %.1f ms, freed while running %lu, freed at destroy %lu, %s\n",
+            use_queue ? "queue" : "stack", ITEMS_COUNT, elapsed_ms, freed_in_run,
+            atomic_load(&nodes_freed) - freed_before - freed_in_run, ok ? "ok" : "FAILED");
+
+    if(use_queue)
+    {
+        /* last dequeued node is still the dummy */
+        free(atomic_load(&bench->queue.head));
+    }
+    free(bench);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    int rc = 0;
+
+    rc |= bench_run(false);
+    rc |= bench_run(true);
+    return rc;
+}
@@ -0,0 +1,233 @@
+/**
+ * @file heap_app.c
+ * @author agent
+ * @brief  glheap_t pairing heap: random insert / decrease key / remove / pop min checked against
+ *         a linear scan of the same items, then pop order of what is left, then
+ *         time of a priority queue on glheap_t against glthread_priority_insert() sorted list
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <time.h>
+#include "glthread.h"
+
+#define ITEMS               2000
+#define OPERATIONS          200000
+/* small key range, so equal keys are common */
+#define KEY_RANGE           1000
+#define BENCH_ITEMS         20000
+
+typedef struct heap_item_
+{
+    int key;
+    bool in_heap;
+    glheap_node_t heap_node;
+    glthread_t list_node;
+}heap_item_t;
+GLHEAP_TO_STRUCT(heap_node_to_item, heap_item_t, heap_node);
+GLTHREAD_TO_STRUCT(list_node_to_item, heap_item_t, list_node);
+
+static int heap_item_comp(void *item1, void *item2)
+{
+    int key1 = ((heap_item_t *) item1)->key;
+    int key2 = ((heap_item_t *) item2)->key;
+
+    return key1 < key2 ? -1 : key1 > key2 ? 1 : 0;
+}
+
+static double elapsed_ms(struct timespec *begin, struct timespec *end)
+{
+    return (end->tv_sec - begin->tv_sec) * 1e3 + (end->tv_nsec - begin->tv_nsec) / 1e6;
+}
+
+/**
+ * @brief   smallest key of items in heap, by scanning all of them
+ *
+ * @param items
+ * @return int - INT_MAX when none
+ */
+static int reference_min(heap_item_t *items)
+{
+    int min = INT_MAX;
+
+    for(int i = 0; i < ITEMS; i++)
+    {
+        if(items[i].in_heap && items[i].key < min)
+        {
+            min = items[i].key;
+        }
+    }
+    return min;
+}
+
+/**
+ * @brief   random operations, heap min and count checked against reference after each
+ *
+ * @return int - 0 when heap always agreed with reference
+ */
+static int heap_check_random(void)
+{
+    heap_item_t *items = calloc(ITEMS, sizeof(heap_item_t));
+    heap_item_t *item;
+    glheap_node_t *node;
+    glheap_t heap;
+    unsigned int count = 0;
+    unsigned long bad = 0;
+    unsigned long ops[4] = {0};
+    int i;
+
+    init_glheap(&heap, heap_item_comp, offsetof(heap_item_t, heap_node));
+    srand(1);
+
+    for(long op = 0; op < OPERATIONS; op++)
+    {
+        item = &items[rand() % ITEMS];
+        /* inserts outweigh pops, so heap fills up and decrease key / remove find items */
+        switch(rand() % 6)
+        {
+            case 0:
+            case 1:
+                if(item->in_heap)
+                {
+                    continue;
+                }
+                item->key = rand() % KEY_RANGE;
+                item->in_heap = true;
+                glheap_insert(&heap, &item->heap_node);
+                count++;
+                ops[0]++;
+                break;
+            case 2:
+            case 3:
+                if(!item->in_heap)
+                {
+                    continue;
+                }
+                item->key -= rand() % (KEY_RANGE / 10);
+                glheap_decrease_key(&heap, &item->heap_node);
+                ops[1]++;
+                break;
+            case 4:
+                if(!item->in_heap)
+                {
+                    continue;
+                }
+                glheap_remove(&heap, &item->heap_node);
+                item->in_heap = false;
+                count--;
+                ops[2]++;
+                break;
+            default:
+                node = glheap_pop_min(&heap);
+                if(node == NULL)
+                {
+                    bad += count != 0;
+                    break;
+                }
+                item = heap_node_to_item(node);
+                /* any item with the smallest key may come out */
+                bad += !item->in_heap || item->key != reference_min(items);
+                item->in_heap = false;
+                count--;
+                ops[3]++;
+                break;
+        }
+
+        bad += GLHEAP_COUNT(&heap) != count || IS_GLHEAP_EMPTY(&heap) != (count == 0);
+        if(!IS_GLHEAP_EMPTY(&heap))
+        {
+            bad += heap_node_to_item(GLHEAP_MIN(&heap))->key != reference_min(items);
+        }
+    }
+
+    /* drain, keys come out in order */
+    for(i = INT_MIN; (node = glheap_pop_min(&heap)) != NULL; count--)
+    {
+        item = heap_node_to_item(node);
+        bad += item->key < i;
+        i = item->key;
+    }
+    bad += count != 0;
+
+    printf("random  insert %lu, decrease key %lu, remove %lu, pop min %lu, bad %lu, %s\n",
+            ops[0], ops[1], ops[2], ops[3], bad, bad == 0 ? "ok" : "FAILED");
+    free(items);
+    return bad == 0 ? 0 : 1;
+}
+
+/**
+ * @brief   priority queue on glheap_t against glthread_priority_insert() sorted list,
+ *          same keys into both, then pop all of them
+ *
+ * @return int - 0 when both popped the same key sequence
+ */
+static int heap_bench(void)
+{
+    heap_item_t *heap_items = calloc(BENCH_ITEMS, sizeof(heap_item_t));
+    heap_item_t *list_items = calloc(BENCH_ITEMS, sizeof(heap_item_t));
+    int *heap_keys = calloc(BENCH_ITEMS, sizeof(int));
+    struct timespec begin, end;
+    double heap_ms, list_ms;
+    glheap_node_t *node;
+    glthread_t *glthread;
+    glheap_t heap;
+    glthread_t list;
+    int bad = 0;
+
+    srand(2);
+    for(int i = 0; i < BENCH_ITEMS; i++)
+    {
+        heap_items[i].key = list_items[i].key = rand() % (BENCH_ITEMS * 4);
+    }
+
+    init_glheap(&heap, heap_item_comp, offsetof(heap_item_t, heap_node));
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for(int i = 0; i < BENCH_ITEMS; i++)
+    {
+        glheap_insert(&heap, &heap_items[i].heap_node);
+    }
+    for(int i = 0; (node = glheap_pop_min(&heap)) != NULL; i++)
+    {
+        heap_keys[i] = heap_node_to_item(node)->key;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    heap_ms = elapsed_ms(&begin, &end);
+
+    init_glthread(&list);
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for(int i = 0; i < BENCH_ITEMS; i++)
+    {
+        glthread_priority_insert(&list, &list_items[i].list_node, heap_item_comp,
+                offsetof(heap_item_t, list_node));
+    }
+    for(int i = 0; (glthread = dequeue_glthread_first(&list)) != NULL; i++)
+    {
+        bad += i >= BENCH_ITEMS || list_node_to_item(glthread)->key != heap_keys[i];
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    list_ms = elapsed_ms(&begin, &end);
+
+    printf("bench   items %u, glheap %.2f ms, sorted list %.2f ms, bad %d, %s\n",
+            BENCH_ITEMS, heap_ms, list_ms, bad, bad == 0 ? "ok" : "FAILED");
+    free(heap_items);
+    free(list_items);
+    free(heap_keys);
+    return bad == 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    int rc = 0;
+
+    rc |= heap_check_random();
+    rc |= heap_bench();
+    return rc;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file lock_app.c
+ * @author agent
+ * @brief  contention benchmark of th_lock_t types: 1 to 64 threads update a shared record
+ *         in a short critical section for a fixed time, throughput and fairness
+ *         (fewest / most critical sections per thread) are reported per lock type and thread count
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "threadlib.h"
+#include "th_lock.h"
+
+#define MAX_THREADS         64
+#define RUN_MS              200         /* run time per lock type and thread count */
+#define RECORD_WORDS        8           /* words updated in critical section */
+#define OUTSIDE_WORK        64          /* loop iterations between critical sections */
+
+typedef struct bench_
+{
+    th_lock_t lock;
+    uint64_t record[RECORD_WORDS];      /* protected by lock */
+    _Atomic bool start;
+    _Atomic bool stop;
+}bench_t;
+
+typedef struct bench_thread_
+{
+    _Alignas(TH_CACHE_LINE_SIZE) bench_t *bench;
+    uint64_t ops;
+}bench_thread_t;
+
+static void *locker_fn(void *arg)
+{
+    bench_thread_t *self = (bench_thread_t *) arg;
+    bench_t *bench = self->bench;
+    volatile uint32_t outside;
+
+    while(!atomic_load(&bench->start))
+    {
+        sched_yield();
+    }
+
+    while(!atomic_load_explicit(&bench->stop, memory_order_relaxed))
+    {
+        th_lock_lock(&bench->lock);
+        for(uint32_t i = 0; i < RECORD_WORDS; i++)
+        {
+            bench->record[i]++;
+        }
+        th_lock_unlock(&bench->lock);
+        self->ops++;
+
+        for(outside = 0; outside < OUTSIDE_WORK; outside++);
+    }
+    return NULL;
+}
+
+/**
+ * @brief   run threads_count lockers on one lock type for RUN_MS
+ *
+ * @param type
+ * @param threads_count
+ * @param min_ops - fewest critical sections of one thread
+ * @param max_ops - most critical sections of one thread
+ * @return double - mean nano seconds per critical section, all threads together
+ */
+static double bench_run(th_lock_type_t type, uint32_t threads_count, uint64_t *min_ops, uint64_t *max_ops)
+{
+    static pthread_t threads[MAX_THREADS];
+    bench_thread_t *lockers = aligned_alloc(TH_CACHE_LINE_SIZE, sizeof(bench_thread_t) * MAX_THREADS);
+    bench_t *bench = aligned_alloc(TH_CACHE_LINE_SIZE, sizeof(bench_t));
+    uint64_t total = 0;
+
+    th_lock_init(&bench->lock, type);
+    memset(bench->record, 0, sizeof(bench->record));
+    atomic_init(&bench->start, false);
+    atomic_init(&bench->stop, false);
+
+    for(uint32_t i = 0; i < threads_count; i++)
+    {
+        lockers[i].bench = bench;
+        lockers[i].ops = 0;
+        pthread_create(&threads[i], NULL, locker_fn, &lockers[i]);
+    }
+
+    atomic_store(&bench->start, true);
+    usleep(RUN_MS * 1000);
+    atomic_store(&bench->stop, true);
+
+    *min_ops = UINT64_MAX;
+    *max_ops = 0;
+    for(uint32_t i = 0; i < threads_count; i++)
+    {
+        pthread_join(threads[i], NULL);
+        total += lockers[i].ops;
+        *min_ops = lockers[i].ops < *min_ops ? lockers[i].ops : *min_ops;
+        *max_ops = lockers[i].ops > *max_ops ? lockers[i].ops : *max_ops;
+    }
+
+    /* every critical section updated every word once */
+    if(bench->record[0] != total || bench->record[RECORD_WORDS - 1] != total)
+    {
+        printf("%s: mutual exclusion broken, %lu updates for %lu critical sections\n",
+                th_lock_type_name(type), bench->record[0], total);
+        exit(1);
+    }
+
+    th_lock_destroy(&bench->lock);
+    free(bench);
+    free(lockers);
+    return total ? (RUN_MS * 1e6) / (double)total : 0;
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t min_ops, max_ops;
+    double ns_per_op;
+
+    printf("%-8s %-14s %10s %10s %12s\n", "threads", "lock", "ns/op", "Mops/s", "min/max");
+    for(uint32_t threads_count = 1; threads_count <= MAX_THREADS; threads_count *= 2)
+    {
+        for(int type = 0; type < TH_LOCK_TYPES; type++)
+        {
+            ns_per_op = bench_run(type, threads_count, &min_ops, &max_ops);
+            printf("%-8u %-14s %10.2f %10.2f %12.2f\n", threads_count, th_lock_type_name(type),
+                    ns_per_op, ns_per_op ? 1e3 / ns_per_op : 0, max_ops ? (double)min_ops / max_ops : 0);
+        }
+    }
+    return 0;
+}
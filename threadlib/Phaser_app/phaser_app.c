@@ -0,0 +1,89 @@
+/**
+ * @file phaser_app.c
+ * @author agent
+ * @brief  demo of tiered phaser with an elastic worker set:
+ *         workers join and leave between phases, each team arrives on its own sub-phaser
+ * 
+ *                      root
+ *                     /    \
+ *                team_a    team_b
+ * 
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "threadlib.h"
+#include "phaser.h"
+
+#define WORKERS_COUNT   6
+
+typedef struct worker_
+{
+    char name[16];
+    phaser_t *team;
+    uint32_t phases;                /* phases this worker stays for */
+    uint32_t join_delay_us;         /* late joiners register in the middle of the run */
+}worker_t;
+
+static phaser_t root, team_a, team_b;
+
+static void *worker_fn(void *arg)
+{
+    worker_t *worker = (worker_t *) arg;
+    uint32_t phase;
+
+    usleep(worker->join_delay_us);
+    phase = phaser_register(worker->team);
+    printf("%s joined at phase %u\n", worker->name, phase);
+
+    for(uint32_t i = 0; i < worker->phases; i++)
+    {
+        /* split phase: arrive, do work not depending on others, then wait */
+        phase = phaser_arrive(worker->team);
+        usleep(1000);
+        phaser_await_advance(worker->team, phase);
+    }
+
+    phase = phaser_arrive_and_deregister(worker->team);
+    printf("%s left at phase %u\n", worker->name, phase);
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    static worker_t workers[WORKERS_COUNT];
+    thread_t *threads[WORKERS_COUNT];
+
+    /* parties come and go with workers, empty teams leave root */
+    phaser_init(&root, NULL, 0);
+    phaser_init(&team_a, &root, 0);
+    /* workers joining an empty team queue up on its registration lock in order */
+    phaser_init_lock(&team_b, &root, 0, TH_LOCK_MCS);
+
+    for(int i = 0; i < WORKERS_COUNT; i++)
+    {
+        snprintf(workers[i].name, sizeof(workers[i].name), "worker%d", i);
+        workers[i].team = (i % 2) ? &team_b : &team_a;
+        workers[i].phases = 3 + 2 * i;
+        workers[i].join_delay_us = (i >= 4) ? 5000 : 0;
+
+        threads[i] = thread_create(NULL, workers[i].name);
+        thread_set_thread_attribute_joinable_or_detached(threads[i], true);
+        thread_run(threads[i], worker_fn, &workers[i]);
+    }
+
+    for(int i = 0; i < WORKERS_COUNT; i++)
+    {
+        pthread_join(threads[i]->thread, NULL);
+        free(threads[i]);
+    }
+
+    printf("final phase %u, root parties %u\n", phaser_get_phase(&root), phaser_get_parties(&root));
+    return 0;
+}
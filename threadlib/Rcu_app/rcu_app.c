@@ -0,0 +1,299 @@
+/**
+ * @file rcu_app.c
+ * @author agent
+ * @brief  read-copy-update of a shared config: one writer publishes a new copy per update and
+ *         frees the old one through th_rcu_call() or th_rcu_synchronize(), reader threads check
+ *         every copy they see is whole. freed copies are poisoned so a read after free shows up
+ *         as a bad copy. runs QSBR readers reporting quiescent states at thread_test_and_pause(),
+ *         one of them paused midway, then epoch readers using read side sections
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include "threadlib.h"
+#include "bitsop.h"
+#include "th_rcu.h"
+
+#define READERS             4
+#define UPDATES             20000
+/* every SYNC_EVERY update waits its grace period itself instead of deferring the free */
+#define SYNC_EVERY          16
+#define MAX_PENDING         32
+/* reads between reader yields */
+#define READ_BATCH          256
+#define CONFIG_VALUES       8
+#define POISON              0xdeadbeefdeadbeefULL
+
+typedef struct rcu_config_
+{
+    uint64_t version;
+    uint64_t values[CONFIG_VALUES];             /* all equal version in a whole copy */
+    th_rcu_head_t rcu_head;
+}rcu_config_t;
+
+typedef struct bench_
+{
+    th_rcu_t rcu;
+    rcu_config_t *config;                       /* rcu protected */
+    _Atomic bool done;
+    _Atomic uint64_t updates;
+    _Atomic uint64_t reads;
+    _Atomic uint64_t bad;
+    _Atomic uint64_t retired;                   /* copies handed to th_rcu_call() */
+    uint64_t callbacks_before;                  /* callbacks_run when bench started */
+    _Atomic uint64_t max_in_flight;             /* most retired copies not yet freed */
+}bench_t;
+
+static _Atomic uint64_t configs_freed = 0;
+static _Atomic uint64_t callbacks_run = 0;
+
+static rcu_config_t *rcu_config_create(uint64_t version)
+{
+    rcu_config_t *config = malloc(sizeof(rcu_config_t));
+
+    config->version = version;
+    for(int i = 0; i < CONFIG_VALUES; i++)
+    {
+        config->values[i] = version;
+    }
+    return config;
+}
+
+static void rcu_config_free(rcu_config_t *config)
+{
+    config->version = POISON;
+    for(int i = 0; i < CONFIG_VALUES; i++)
+    {
+        config->values[i] = POISON;
+    }
+    free(config);
+    atomic_fetch_add_explicit(&configs_freed, 1, memory_order_relaxed);
+}
+
+static void rcu_config_free_cb(th_rcu_head_t *head)
+{
+    rcu_config_free((rcu_config_t *)((char *)head - offsetof(rcu_config_t, rcu_head)));
+    atomic_fetch_add_explicit(&callbacks_run, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief   read current copy once
+ *
+ * @param bench
+ * @param reader
+ * @return true - copy is whole
+ */
+static bool rcu_config_check(bench_t *bench, th_rcu_reader_t *reader)
+{
+    rcu_config_t *config;
+    bool whole = true;
+
+    th_rcu_read_lock(reader);
+    config = TH_RCU_DEREFERENCE(bench->config);
+    for(int i = 0; i < CONFIG_VALUES; i++)
+    {
+        if(config->values[i] != config->version)
+        {
+            whole = false;
+        }
+    }
+    th_rcu_read_unlock(reader);
+    return whole && config->version != POISON;
+}
+
+static void *reader_fn(void *arg)
+{
+    bench_t *bench = (bench_t *) arg;
+    thread_t *self = thread_self();
+    th_rcu_reader_t reader;
+    uint64_t reads = 0;
+
+    th_rcu_register_reader(&bench->rcu, &reader);
+    /* QSBR: every pause point is a quiescent state */
+    thread_set_rcu_reader(self, &reader);
+
+    while(!atomic_load(&bench->done))
+    {
+        if(!rcu_config_check(bench, &reader))
+        {
+            atomic_fetch_add(&bench->bad, 1);
+        }
+        thread_test_and_pause(self);
+        /* leave the writer and reclaimer some cpu when readers outnumber cores */
+        if(++reads % READ_BATCH == 0)
+        {
+            sched_yield();
+        }
+    }
+
+    thread_set_rcu_reader(self, NULL);
+    th_rcu_unregister_reader(&reader);
+    atomic_fetch_add(&bench->reads, reads);
+    return NULL;
+}
+
+/**
+ * @brief   writer is a registered reader as well, so a QSBR grace period must not wait
+ *          for it while it waits for one itself
+ *
+ * @param arg - bench_t - pointer
+ * @return void*
+ */
+static void *writer_fn(void *arg)
+{
+    bench_t *bench = (bench_t *) arg;
+    thread_t *self = thread_self();
+    th_rcu_reader_t reader;
+    rcu_config_t *old_config, *new_config;
+    uint64_t in_flight;
+
+    th_rcu_register_reader(&bench->rcu, &reader);
+    thread_set_rcu_reader(self, &reader);
+
+    for(uint64_t i = 0; i < UPDATES; i++)
+    {
+        th_rcu_read_lock(&reader);
+        old_config = TH_RCU_DEREFERENCE(bench->config);
+        new_config = rcu_config_create(old_config->version + 1);
+        th_rcu_read_unlock(&reader);
+
+        /* single writer, no other update to race with */
+        TH_RCU_ASSIGN_POINTER(bench->config, new_config);
+
+        if(i % SYNC_EVERY == 0)
+        {
+            th_rcu_synchronize(&bench->rcu, &reader);
+            rcu_config_free(old_config);
+        }
+        else
+        {
+            atomic_fetch_add(&bench->retired, 1);
+            th_rcu_call(&bench->rcu, &reader, &old_config->rcu_head, rcu_config_free_cb);
+
+            /* callbacks not yet run are bounded by max_pending */
+            in_flight = atomic_load(&bench->retired) - (atomic_load(&callbacks_run) - bench->callbacks_before);
+            if(in_flight > atomic_load(&bench->max_in_flight))
+            {
+                atomic_store(&bench->max_in_flight, in_flight);
+            }
+        }
+        atomic_fetch_add_explicit(&bench->updates, 1, memory_order_relaxed);
+        thread_test_and_pause(self);
+    }
+
+    thread_set_rcu_reader(self, NULL);
+    th_rcu_unregister_reader(&reader);
+    return NULL;
+}
+
+/**
+ * @brief   pause a QSBR reader at its pause point, grace periods must not wait for it meanwhile
+ *
+ * @param bench
+ * @param thread
+ * @return true - writer kept updating while reader was paused
+ */
+static bool rcu_pause_reader(bench_t *bench, thread_t *thread)
+{
+    uint64_t start, wanted;
+    bool progressed;
+
+    thread_pause(thread);
+    while(!IS_BIT_SET(atomic_load(&thread->flag), THREAD_F_PAUSED))
+    {
+        usleep(1000);
+    }
+    /* more updates than max_pending lets through without a grace period, or all that are left */
+    start = atomic_load(&bench->updates);
+    wanted = UPDATES - start < 2 * MAX_PENDING ? UPDATES - start : 2 * MAX_PENDING;
+    for(int i = 0; i < 1000 && atomic_load(&bench->updates) - start < wanted; i++)
+    {
+        usleep(1000);
+    }
+    progressed = atomic_load(&bench->updates) - start >= wanted;
+    thread_resume(thread);
+    return progressed;
+}
+
+/**
+ * @brief   run readers and writer of one flavor
+ *
+ * @param flavor
+ * @return int - 0 when every read saw a whole copy and every copy was freed
+ */
+static int bench_run(th_rcu_flavor_t flavor)
+{
+    thread_t *readers[READERS], *writer;
+    bench_t *bench = aligned_alloc(TH_CACHE_LINE_SIZE, sizeof(bench_t));
+    uint64_t freed_before = atomic_load(&configs_freed);
+    struct timespec begin, end;
+    double elapsed_ms;
+    bool paused_ok = true;
+    bool ok;
+
+    memset(bench, 0, sizeof(bench_t));
+    bench->callbacks_before = atomic_load(&callbacks_run);
+    th_rcu_init(&bench->rcu, flavor, MAX_PENDING);
+    bench->config = rcu_config_create(0);
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for(int i = 0; i < READERS; i++)
+    {
+        readers[i] = thread_create(NULL, "rcu_reader");
+        thread_set_thread_attribute_joinable_or_detached(readers[i], true);
+        thread_run(readers[i], reader_fn, bench);
+    }
+    writer = thread_create(NULL, "rcu_writer");
+    thread_set_thread_attribute_joinable_or_detached(writer, true);
+    thread_run(writer, writer_fn, bench);
+
+    if(flavor == TH_RCU_QSBR)
+    {
+        paused_ok = rcu_pause_reader(bench, readers[0]);
+    }
+
+    pthread_join(writer->thread, NULL);
+    atomic_store(&bench->done, true);
+    for(int i = 0; i < READERS; i++)
+    {
+        pthread_join(readers[i]->thread, NULL);
+        free(readers[i]);
+    }
+    free(writer);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    /* runs callbacks still pending */
+    th_rcu_destroy(&bench->rcu);
+    rcu_config_free(bench->config);
+    elapsed_ms = (end.tv_sec - begin.tv_sec) * 1e3 + (end.tv_nsec - begin.tv_nsec) / 1e6;
+
+    ok = paused_ok && atomic_load(&bench->bad) == 0 &&
+         atomic_load(&configs_freed) - freed_before == UPDATES + 1 &&
+         atomic_load(&bench->max_in_flight) <= MAX_PENDING;
+    printf("%-5s updates %u, reads %lu, %.1f ms, bad %lu, max pending %lu, paused reader %s, %s\n",
+            flavor == TH_RCU_QSBR ? "qsbr" : "epoch", UPDATES, atomic_load(&bench->reads), elapsed_ms,
+            atomic_load(&bench->bad), atomic_load(&bench->max_in_flight),
+            flavor == TH_RCU_QSBR ? (paused_ok ? "offline" : "STALLED") : "-", ok ? "ok" : "FAILED");
+
+    free(bench);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    int rc = 0;
+
+    rc |= bench_run(TH_RCU_QSBR);
+    rc |= bench_run(TH_RCU_EPOCH);
+    return rc;
+}
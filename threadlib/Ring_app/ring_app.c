@@ -0,0 +1,233 @@
+/**
+ * @file ring_app.c
+ * @author agent
+ * @brief  throughput of SPSC and MPSC rings: producers pinned to their own cores send numbered
+ *         messages to a consumer pinned to another, in batches of 1 and 32, spinning and blocking.
+ *         consumer checks each producer messages come in order and none is lost
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include "threadlib.h"
+#include "th_ring.h"
+
+#define MESSAGES            10000000    /* per run, all producers together */
+#define RING_CAPACITY       4096
+#define MAX_PRODUCERS       4
+#define MAX_BATCH           32
+#define PRODUCER_SHIFT      56          /* message = producer id << shift | sequence */
+
+typedef struct bench_
+{
+    bool mpsc;
+    bool blocking;
+    uint32_t batch;
+    uint32_t producers;
+    th_spsc_ring_t spsc;
+    th_mpsc_ring_t mpsc_ring;
+    uint64_t bad;
+}bench_t;
+
+typedef struct producer_
+{
+    bench_t *bench;
+    uint64_t id;
+    uint64_t count;
+}producer_t;
+
+/**
+ * @brief   pin calling thread to cpu, modulo online cpus
+ *
+ * @param cpu
+ */
+static void bench_pin(uint32_t cpu)
+{
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu % (uint32_t)sysconf(_SC_NPROCESSORS_ONLN), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+static void *producer_fn(void *arg)
+{
+    producer_t *producer = (producer_t *) arg;
+    bench_t *bench = producer->bench;
+    void *msgs[MAX_BATCH];
+    uint64_t seq = 0;
+    uint32_t count, done;
+
+    bench_pin(1 + producer->id);
+
+    while(seq < producer->count)
+    {
+        count = producer->count - seq < bench->batch ? producer->count - seq : bench->batch;
+        for(uint32_t i = 0; i < count; i++)
+        {
+            msgs[i] = (void *)(uintptr_t)(producer->id << PRODUCER_SHIFT | (seq + i));
+        }
+
+        if(bench->blocking)
+        {
+            if(bench->mpsc)
+            {
+                th_mpsc_ring_enqueue_wait(&bench->mpsc_ring, msgs, count);
+            }
+            else
+            {
+                th_spsc_ring_enqueue_wait(&bench->spsc, msgs, count);
+            }
+            seq += count;
+            continue;
+        }
+
+        for(done = 0; done < count; )
+        {
+            done += bench->mpsc ? th_mpsc_ring_enqueue_batch(&bench->mpsc_ring, msgs + done, count - done) :
+                                  th_spsc_ring_enqueue_batch(&bench->spsc, msgs + done, count - done);
+            if(done < count)
+            {
+                sched_yield();
+            }
+        }
+        seq += count;
+    }
+    return NULL;
+}
+
+/**
+ * @brief   consume all messages on calling thread, check per producer order
+ *
+ * @param bench
+ */
+static void bench_consume(bench_t *bench)
+{
+    uint64_t next[MAX_PRODUCERS] = { 0 };
+    void *msgs[MAX_BATCH];
+    uint64_t received = 0, msg, id;
+    uint32_t count;
+
+    while(received < MESSAGES)
+    {
+        if(bench->blocking)
+        {
+            count = bench->mpsc ? th_mpsc_ring_dequeue_wait(&bench->mpsc_ring, msgs, bench->batch) :
+                                  th_spsc_ring_dequeue_wait(&bench->spsc, msgs, bench->batch);
+        }
+        else
+        {
+            count = bench->mpsc ? th_mpsc_ring_dequeue_batch(&bench->mpsc_ring, msgs, bench->batch) :
+                                  th_spsc_ring_dequeue_batch(&bench->spsc, msgs, bench->batch);
+            if(count == 0)
+            {
+                sched_yield();
+                continue;
+            }
+        }
+
+        for(uint32_t i = 0; i < count; i++)
+        {
+            msg = (uint64_t)(uintptr_t)msgs[i];
+            id = msg >> PRODUCER_SHIFT;
+            if(id >= bench->producers || (msg & ((1ULL << PRODUCER_SHIFT) - 1)) != next[id]++)
+            {
+                bench->bad++;
+            }
+        }
+        received += count;
+    }
+}
+
+/**
+ * @brief   run one configuration
+ *
+ * @param mpsc
+ * @param producers
+ * @param batch
+ * @param blocking
+ * @return int - 0 when every message came in order
+ */
+static int bench_run(bool mpsc, uint32_t producers, uint32_t batch, bool blocking)
+{
+    pthread_t threads[MAX_PRODUCERS];
+    producer_t args[MAX_PRODUCERS];
+    bench_t *bench = aligned_alloc(TH_CACHE_LINE_SIZE, sizeof(bench_t));
+    struct timespec begin, end;
+    double elapsed_ns;
+    int rc;
+
+    memset(bench, 0, sizeof(bench_t));
+    bench->mpsc = mpsc;
+    bench->blocking = blocking;
+    bench->batch = batch;
+    bench->producers = producers;
+    if(mpsc)
+    {
+        th_mpsc_ring_init(&bench->mpsc_ring, RING_CAPACITY, blocking);
+    }
+    else
+    {
+        th_spsc_ring_init(&bench->spsc, RING_CAPACITY, blocking);
+    }
+
+    bench_pin(0);
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for(uint32_t i = 0; i < producers; i++)
+    {
+        args[i].bench = bench;
+        args[i].id = i;
+        args[i].count = MESSAGES / producers + (i < MESSAGES % producers);
+        pthread_create(&threads[i], NULL, producer_fn, &args[i]);
+    }
+    bench_consume(bench);
+    for(uint32_t i = 0; i < producers; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    elapsed_ns = (end.tv_sec - begin.tv_sec) * 1e9 + (end.tv_nsec - begin.tv_nsec);
+    printf("%-5s %-9u %-6u %-9s %10.2f %10.2f   %s\n", mpsc ? "mpsc" : "spsc", producers, batch,
+            blocking ? "blocking" : "spinning", elapsed_ns / MESSAGES, MESSAGES * 1e3 / elapsed_ns,
+            bench->bad ? "FAILED" : "ok");
+    rc = bench->bad ? 1 : 0;
+
+    if(mpsc)
+    {
+        th_mpsc_ring_destroy(&bench->mpsc_ring);
+    }
+    else
+    {
+        th_spsc_ring_destroy(&bench->spsc);
+    }
+    free(bench);
+    return rc;
+}
+
+int main(int argc, char **argv)
+{
+    int rc = 0;
+
+    printf("%-5s %-9s %-6s %-9s %10s %10s\n", "ring", "producers", "batch", "mode", "ns/msg", "Mmsg/s");
+    for(uint32_t batch = 1; batch <= MAX_BATCH; batch *= MAX_BATCH)
+    {
+        rc |= bench_run(false, 1, batch, false);
+        rc |= bench_run(false, 1, batch, true);
+        for(uint32_t producers = 1; producers <= MAX_PRODUCERS; producers *= 2)
+        {
+            rc |= bench_run(true, producers, batch, false);
+            rc |= bench_run(true, producers, batch, true);
+        }
+    }
+    return rc;
+}
@@ -0,0 +1,184 @@
+/**
+ * @file rwlock_app.c
+ * @author agent
+ * @brief  benchmark of big-reader lock against pthread_rwlock_t:
+ *         1 to 128 reader threads look up a small route table while one writer
+ *         updates it now and then, read throughput is reported per lock and reader count
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "threadlib.h"
+#include "th_rwlock.h"
+
+#define MAX_READERS         128
+#define READ_OPS            200000      /* lookups per reader */
+#define ROUTES_COUNT        64
+#define WRITER_PERIOD_US    100         /* writer updates a route this often */
+
+typedef enum bench_lock_type_
+{
+    BENCH_PTHREAD_RWLOCK,
+    BENCH_BRLOCK_PREFER_READER,
+    BENCH_BRLOCK_PREFER_WRITER,
+    BENCH_LOCK_TYPES,
+}bench_lock_type_t;
+
+static const char *bench_lock_names[BENCH_LOCK_TYPES] =
+{
+    "pthread_rwlock_t",
+    "th_rwlock reader pref",
+    "th_rwlock writer pref",
+};
+
+typedef struct bench_
+{
+    bench_lock_type_t type;
+    pthread_rwlock_t pthread_lock;
+    th_rwlock_t *brlock;
+    uint32_t routes[ROUTES_COUNT];
+    _Atomic bool start;
+    _Atomic bool stop;
+    _Atomic uint64_t writes;
+}bench_t;
+
+static void bench_read_lock(bench_t *bench)
+{
+    if(bench->type == BENCH_PTHREAD_RWLOCK)
+    {
+        pthread_rwlock_rdlock(&bench->pthread_lock);
+    }
+    else
+    {
+        th_rwlock_rdlock(bench->brlock);
+    }
+}
+
+static void bench_read_unlock(bench_t *bench)
+{
+    if(bench->type == BENCH_PTHREAD_RWLOCK)
+    {
+        pthread_rwlock_unlock(&bench->pthread_lock);
+    }
+    else
+    {
+        th_rwlock_rdunlock(bench->brlock);
+    }
+}
+
+static void *reader_fn(void *arg)
+{
+    bench_t *bench = (bench_t *) arg;
+    uint64_t sum = 0;
+
+    while(!atomic_load(&bench->start))
+    {
+        sched_yield();
+    }
+
+    for(uint32_t i = 0; i < READ_OPS; i++)
+    {
+        bench_read_lock(bench);
+        sum += bench->routes[i & (ROUTES_COUNT - 1)];
+        bench_read_unlock(bench);
+    }
+    return (void *)(uintptr_t)sum;
+}
+
+static void *writer_fn(void *arg)
+{
+    bench_t *bench = (bench_t *) arg;
+    uint32_t i = 0;
+
+    while(!atomic_load(&bench->stop))
+    {
+        if(bench->type == BENCH_PTHREAD_RWLOCK)
+        {
+            pthread_rwlock_wrlock(&bench->pthread_lock);
+            bench->routes[i++ & (ROUTES_COUNT - 1)]++;
+            pthread_rwlock_unlock(&bench->pthread_lock);
+        }
+        else
+        {
+            th_rwlock_wrlock(bench->brlock);
+            bench->routes[i++ & (ROUTES_COUNT - 1)]++;
+            th_rwlock_wrunlock(bench->brlock);
+        }
+        atomic_fetch_add(&bench->writes, 1);
+        usleep(WRITER_PERIOD_US);
+    }
+    return NULL;
+}
+
+/**
+ * @brief   run readers and one writer on one lock type
+ *
+ * @param type
+ * @param readers_count
+ * @param writes - writes done during the run
+ * @return double - mean nano seconds per read lookup, all readers together
+ */
+static double bench_run(bench_lock_type_t type, uint32_t readers_count, uint64_t *writes)
+{
+    static pthread_t readers[MAX_READERS];
+    pthread_t writer;
+    struct timespec begin, end;
+    bench_t *bench = calloc(1, sizeof(bench_t));
+    double elapsed_ns;
+
+    bench->type = type;
+    pthread_rwlock_init(&bench->pthread_lock, NULL);
+    bench->brlock = aligned_alloc(TH_CACHE_LINE_SIZE, sizeof(th_rwlock_t));
+    th_rwlock_init(bench->brlock,
+            type == BENCH_BRLOCK_PREFER_WRITER ? TH_RWLOCK_PREFER_WRITER : TH_RWLOCK_PREFER_READER, true);
+
+    for(uint32_t i = 0; i < readers_count; i++)
+    {
+        pthread_create(&readers[i], NULL, reader_fn, bench);
+    }
+    pthread_create(&writer, NULL, writer_fn, bench);
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    atomic_store(&bench->start, true);
+    for(uint32_t i = 0; i < readers_count; i++)
+    {
+        pthread_join(readers[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    atomic_store(&bench->stop, true);
+    pthread_join(writer, NULL);
+
+    elapsed_ns = (end.tv_sec - begin.tv_sec) * 1e9 + (end.tv_nsec - begin.tv_nsec);
+    *writes = atomic_load(&bench->writes);
+
+    pthread_rwlock_destroy(&bench->pthread_lock);
+    free(bench->brlock);
+    free(bench);
+    return elapsed_ns / ((double)readers_count * READ_OPS);
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t writes;
+    double ns_per_read;
+
+    printf("%-8s %-24s %12s %14s %8s\n", "readers", "lock", "ns/read", "Mreads/s", "writes");
+    for(uint32_t readers_count = 1; readers_count <= MAX_READERS; readers_count *= 2)
+    {
+        for(int type = 0; type < BENCH_LOCK_TYPES; type++)
+        {
+            ns_per_read = bench_run(type, readers_count, &writes);
+            printf("%-8u %-24s %12.2f %14.2f %8lu\n", readers_count, bench_lock_names[type],
+                    ns_per_read, 1e3 / ns_per_read, writes);
+        }
+    }
+    return 0;
+}
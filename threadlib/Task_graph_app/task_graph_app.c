@@ -0,0 +1,72 @@
+/**
+ * @file task_graph_app.c
+ * @author agent
+ * @brief  demo of task graph executor: a diamond pipeline built once and run many times
+ * 
+ *                  +--> decode_audio --+
+ *         read --> |                   +--> mux --> write
+ *                  +--> decode_video --+
+ * 
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "threadlib.h"
+#include "task_graph.h"
+
+#define RUNS_COUNT  20
+
+/* each stage simulate work by sleeping arg micro seconds */
+static void *stage_fn(void *arg)
+{
+    usleep((useconds_t)(uintptr_t)arg);
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    thread_pool_t *th_pool = calloc(1, sizeof(thread_pool_t));
+    task_graph_t graph;
+    task_graph_node_t *read, *decode_audio, *decode_video, *mux, *write;
+
+    thread_pool_init(th_pool);
+    thread_pool_insert_new_thread(th_pool, thread_create(NULL, "worker1"));
+    thread_pool_insert_new_thread(th_pool, thread_create(NULL, "worker2"));
+
+    /* build graph once */
+    task_graph_init(&graph, th_pool);
+    read = task_graph_add_node(&graph, "read", stage_fn, (void *)1000);
+    decode_audio = task_graph_add_node(&graph, "decode_audio", stage_fn, (void *)2000);
+    decode_video = task_graph_add_node(&graph, "decode_video", stage_fn, (void *)8000);
+    mux = task_graph_add_node(&graph, "mux", stage_fn, (void *)1500);
+    write = task_graph_add_node(&graph, "write", stage_fn, (void *)1000);
+
+    task_graph_node_depends_on(decode_audio, read);
+    task_graph_node_depends_on(decode_video, read);
+    task_graph_node_depends_on(mux, decode_audio);
+    task_graph_node_depends_on(mux, decode_video);
+    task_graph_node_depends_on(write, mux);
+
+    /* read after write would close a cycle, graph must refuse it */
+    if(task_graph_node_depends_on(read, write) || task_graph_node_depends_on(read, read))
+    {
+        printf("cycle accepted\n");
+        return 1;
+    }
+
+    /* run it many times, no allocation per run */
+    for(int i = 0; i < RUNS_COUNT; i++)
+    {
+        task_graph_run(&graph);
+    }
+
+    task_graph_critical_path_report(&graph, stdout);
+    task_graph_destroy(&graph);
+    return 0;
+}
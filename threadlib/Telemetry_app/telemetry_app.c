@@ -0,0 +1,190 @@
+/**
+ * @file telemetry_app.c
+ * @author agent
+ * @brief  thread pool telemetry: runs tasks through dispatch and submit while workers are held
+ *         busy, so rejections and backlogged submits are known exactly, then checks a snapshot
+ *         and the dumped report against the counts the app kept itself
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "threadlib.h"
+
+#ifndef THREADLIB_TELEMETRY
+#error "telemetry app needs threadlib built with THREADLIB_TELEMETRY, see make telemetry_app"
+#endif
+
+#define WORKERS             2
+#define REJECTED            10
+#define SUBMITS             50
+#define DISPATCHES          200
+#define REPORT_PATH         "telemetry_report"
+
+typedef struct app_counts_
+{
+    uint64_t dispatched;                        /* dispatches accepted */
+    uint64_t rejected;                          /* dispatches returned false */
+    uint64_t submitted;
+}app_counts_t;
+
+static _Atomic bool gate_open = false;
+static _Atomic uint64_t works_run = 0;
+
+/* hold worker busy until gate opens */
+static void *gate_work_fn(void *arg)
+{
+    while(!atomic_load(&gate_open))
+    {
+        usleep(1000);
+    }
+    atomic_fetch_add(&works_run, 1);
+    return NULL;
+}
+
+static void *short_work_fn(void *arg)
+{
+    atomic_fetch_add(&works_run, 1);
+    return NULL;
+}
+
+/**
+ * @brief   snapshot once workers recorded every completed task
+ *
+ * @param th_pool
+ * @param snapshot
+ * @param completed - tasks expected complete
+ * @return true - snapshot reached completed within a few seconds
+ */
+static bool telemetry_wait_completed(thread_pool_t *th_pool, th_pool_telemetry_snapshot_t *snapshot,
+        uint64_t completed)
+{
+    for(int i = 0; i < 5000; i++)
+    {
+        thread_pool_telemetry_snapshot(th_pool, snapshot);
+        if(snapshot->tasks_completed >= completed)
+        {
+            return snapshot->tasks_completed == completed;
+        }
+        usleep(1000);
+    }
+    return false;
+}
+
+/**
+ * @brief   read pool counters back from first line of a dumped report
+ *
+ * @param path
+ * @param counts - completed, rejections, backlogged
+ * @return true - report found and parsed
+ */
+static bool telemetry_read_report(const char *path, unsigned long counts[3])
+{
+    char line[256];
+    char *fields;
+    FILE *fptr = fopen(path, "r");
+    bool parsed = false;
+
+    if(fptr == NULL)
+    {
+        return false;
+    }
+    if(fgets(line, sizeof(line), fptr) != NULL && (fields = strstr(line, "tasks_completed=")) != NULL)
+    {
+        parsed = sscanf(fields, "tasks_completed=%lu rejections=%lu backlogged=%lu",
+                &counts[0], &counts[1], &counts[2]) == 3;
+    }
+    fclose(fptr);
+    return parsed;
+}
+
+int main(int argc, char **argv)
+{
+    thread_pool_t *th_pool = calloc(1, sizeof(thread_pool_t));
+    thread_pool_work_t *works = calloc(SUBMITS, sizeof(thread_pool_work_t));
+    th_pool_telemetry_snapshot_t *snapshot = calloc(1, sizeof(th_pool_telemetry_snapshot_t));
+    app_counts_t app = {0};
+    unsigned long report[3] = {0}, periodic[3] = {0};
+    uint64_t completed;
+    char name[32];
+    bool ok;
+    int i;
+
+    thread_pool_init(th_pool);
+    for(i = 0; i < WORKERS; i++)
+    {
+        sprintf(name, "TH_WORKER%d", i + 1);
+        thread_pool_insert_new_thread(th_pool, thread_create(NULL, name));
+    }
+
+    /* every worker held busy, dispatches are rejected and submits queue on backlog */
+    for(i = 0; i < WORKERS; i++)
+    {
+        app.dispatched += thread_pool_dispatch_thread(th_pool, gate_work_fn, NULL, false);
+    }
+    for(i = 0; i < REJECTED; i++)
+    {
+        app.rejected += !thread_pool_dispatch_thread(th_pool, short_work_fn, NULL, false);
+    }
+    for(i = 0; i < SUBMITS; i++)
+    {
+        works[i].work_fn = short_work_fn;
+        works[i].arg = NULL;
+        thread_pool_submit(th_pool, &works[i]);
+        app.submitted++;
+    }
+    atomic_store(&gate_open, true);
+    ok = telemetry_wait_completed(th_pool, snapshot, app.dispatched + app.submitted) &&
+         app.dispatched == WORKERS && app.rejected == REJECTED &&
+         snapshot->rejections == REJECTED && snapshot->backlogged == SUBMITS;
+
+    printf("busy     dispatched %lu, rejected %lu, submitted %lu, snapshot completed %lu rejections %lu backlogged %lu, %s\n",
+            app.dispatched, app.rejected, app.submitted, snapshot->tasks_completed, snapshot->rejections,
+            snapshot->backlogged, ok ? "ok" : "FAILED");
+
+    /* blocking dispatches, a worker still on its way back to the pool rejects one now and then */
+    for(i = 0; i < DISPATCHES; i++)
+    {
+        while(!thread_pool_dispatch_thread(th_pool, short_work_fn, NULL, true))
+        {
+            app.rejected++;
+            usleep(100);
+        }
+        app.dispatched++;
+    }
+    completed = app.dispatched + app.submitted;
+    ok = telemetry_wait_completed(th_pool, snapshot, completed) && ok;
+    ok = ok && snapshot->rejections == app.rejected && snapshot->backlogged == SUBMITS &&
+         atomic_load(&works_run) == completed &&
+         atomic_load(&snapshot->queue_latency.total_count) == completed &&
+         atomic_load(&snapshot->run_time.total_count) == completed;
+
+    printf("snapshot completed %lu, rejections %lu, backlogged %lu, queue latency p50 %lu ns p99 %lu ns, %s\n",
+            snapshot->tasks_completed, snapshot->rejections, snapshot->backlogged,
+            th_histogram_percentile(&snapshot->queue_latency, 50),
+            th_histogram_percentile(&snapshot->queue_latency, 99), ok ? "ok" : "FAILED");
+
+    /* report dumped once, then by the dumper thread */
+    ok = thread_pool_telemetry_dump(th_pool, REPORT_PATH) == 0 && telemetry_read_report(REPORT_PATH, report) &&
+         report[0] == completed && report[1] == app.rejected && report[2] == SUBMITS && ok;
+    unlink(REPORT_PATH);
+
+    thread_pool_telemetry_start_dump(th_pool, REPORT_PATH, 10);
+    usleep(50 * 1000);
+    thread_pool_telemetry_stop_dump(th_pool);
+    ok = telemetry_read_report(REPORT_PATH, periodic) && periodic[0] == completed && ok;
+    unlink(REPORT_PATH);
+
+    printf("report   completed %lu, rejections %lu, backlogged %lu, periodic completed %lu, %s\n",
+            report[0], report[1], report[2], periodic[0], ok ? "ok" : "FAILED");
+
+    free(snapshot);
+    free(works);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file timer_wheel_app.c
+ * @author agent
+ * @brief  demo of timer wheel: one-shot, periodic and cancelled timers
+ *         plus a million pending timeouts served by one timer thread
+ * @version 0.1
+ * @date 2026-10-18
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "threadlib.h"
+#include "timer_wheel.h"
+
+#define PENDING_TIMERS_COUNT    1000000
+
+static _Atomic uint32_t periodic_count;
+
+static void *one_shot_fn(void *arg)
+{
+    printf("one-shot timer %s expired\n", (char *)arg);
+    return NULL;
+}
+
+static void *periodic_fn(void *arg)
+{
+    printf("periodic timer %s expired %u\n", (char *)arg, atomic_fetch_add(&periodic_count, 1) + 1);
+    return NULL;
+}
+
+static void *never_fn(void *arg)
+{
+    printf("cancelled timer expired, this must not happen\n");
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    thread_pool_t *th_pool = calloc(1, sizeof(thread_pool_t));
+    timer_wheel_t *wheel = calloc(1, sizeof(timer_wheel_t));
+    wheel_timer_t one_shot, periodic, cancelled;
+    wheel_timer_t *pending = calloc(PENDING_TIMERS_COUNT, sizeof(wheel_timer_t));
+    uint64_t start_ns;
+    uint32_t cancelled_count = 0;
+
+    /* two workers run expired timers */
+    thread_pool_init(th_pool);
+    thread_pool_insert_new_thread(th_pool, thread_create(NULL, "worker1"));
+    thread_pool_insert_new_thread(th_pool, thread_create(NULL, "worker2"));
+
+    timer_wheel_init(wheel, th_pool, 1);
+    timer_wheel_start(wheel);
+
+    wheel_timer_init(&one_shot, one_shot_fn, "T1");
+    timer_wheel_add(wheel, &one_shot, 500, 0);
+
+    wheel_timer_init(&periodic, periodic_fn, "T2");
+    timer_wheel_add(wheel, &periodic, 200, 200);
+
+    wheel_timer_init(&cancelled, never_fn, "T3");
+    timer_wheel_add(wheel, &cancelled, 300, 0);
+    timer_wheel_cancel(wheel, &cancelled);
+
+    /* a million long timeouts, armed and cancelled in O(1) each */
+    start_ns = th_now_ns();
+    for(uint32_t i = 0; i < PENDING_TIMERS_COUNT; i++)
+    {
+        wheel_timer_init(&pending[i], never_fn, NULL);
+        timer_wheel_add(wheel, &pending[i], 60000 + i % 600000, 0);
+    }
+    printf("armed %u timers in %lu ms\n", PENDING_TIMERS_COUNT,
+            (unsigned long)((th_now_ns() - start_ns) / 1000000));
+
+    sleep(1);
+
+    start_ns = th_now_ns();
+    for(uint32_t i = 0; i < PENDING_TIMERS_COUNT; i++)
+    {
+        cancelled_count += timer_wheel_cancel(wheel, &pending[i]);
+    }
+    printf("cancelled %u timers in %lu ms\n", cancelled_count,
+            (unsigned long)((th_now_ns() - start_ns) / 1000000));
+
+    timer_wheel_cancel(wheel, &periodic);
+    timer_wheel_stop(wheel);
+    printf("periodic timer fired %u times\n", atomic_load(&periodic_count));
+    return 0;
+}
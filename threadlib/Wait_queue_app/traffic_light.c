@@ -11,21 +11,33 @@ void traffic_light_init(traffic_light_t *traffic_light)
     for(int i = 0; i<MAX_DIRECTION; i++)
     {
         traffic_light->traffic_light_faces[i].color = RED;
+        th_seqcount_init(&traffic_light->traffic_light_faces[i].color_seq);
         pthread_mutex_init(&traffic_light->traffic_light_faces[i].mutex, NULL);
-        wait_queue_init(&traffic_light->traffic_light_faces[i].wq);
+        TH_LOCK_PROF_NAME(&traffic_light->traffic_light_faces[i].mutex, "traffic light face mutex");
+        wait_queue_init_mode(&traffic_light->traffic_light_faces[i].wq, WAIT_QUEUE_FIFO);
     }
 }
 void traffic_light_set_status(traffic_light_t *traffic_light, direction_t dir,
         traffic_light_color color)
 {
-    traffic_light->traffic_light_faces[dir].color = color;
+    /* caller holds face mutex, which serialises writers */
+    TH_SEQCOUNT_WRITE(&traffic_light->traffic_light_faces[dir].color_seq,
+            &traffic_light->traffic_light_faces[dir].color, &color);
     
-    /* if light is green - let all blocked traffic flow */
-    if(color == GREEN)
-    {
-        /* signal traffics waiting in wait_queue with no locking - locking handled already */
-        wait_queue_broadcast(&traffic_light->traffic_light_faces[dir].wq, false);
-    }
+    /**
+     * wakeup waiters on any change, traffic flows on green and yellow, 
+     * light monitor reports every change
+     * signal traffics waiting in wait_queue with no locking - locking handled already
+     */
+    wait_queue_broadcast(&traffic_light->traffic_light_faces[dir].wq, false);
+}
+traffic_light_color traffic_light_get_status(traffic_light_t *traffic_light, direction_t dir)
+{
+    traffic_light_color color;
+
+    TH_SEQCOUNT_READ(&traffic_light->traffic_light_faces[dir].color_seq,
+            &color, &traffic_light->traffic_light_faces[dir].color);
+    return color;
 }
 
 /**************************************** Traffic Light functions END ****************************************/
@@ -66,7 +78,7 @@ static bool traffic_check_stop_condition(void *arg, pthread_mutex_t **mutex)
     if(mutex != NULL)
     {
         *mutex = &traffic->traffic_light->traffic_light_faces[traffic->traffic_direction].mutex;
-        pthread_mutex_lock(*mutex);
+        TH_MUTEX_LOCK(*mutex);
     }
 
     /* check traffic facing light color */
@@ -77,54 +89,66 @@ static bool traffic_check_stop_condition(void *arg, pthread_mutex_t **mutex)
     return false;
 }
 /**
- * @brief   traffic function callback
- *          this function is run the traffic routine
+ * @brief   traffic continuation, run on a pool thread once traffic light is not red
+ *          traffic light mutex is held on entry
  * 
  * @param arg       traffic_t - traffic object 
  * @return void* 
  */
-static void *traffic_function_cb(void *arg)
+static void *traffic_flow_cb(void *arg)
 {
     traffic_t *traffic = (traffic_t *) arg;
     traffic_light_t *traffic_light = traffic->traffic_light;
-    static char log_buff[256];
+    char log_buff[256];
 
-    while(1)
+    /**
+     * traffic not stopping in traffic light 
+     * simulate traffic flowing by writing to file
+     */
+    if(traffic_light->traffic_light_faces[traffic->traffic_direction].color == GREEN)
+    {
+        traffic->traffic_status = TRAFFIC_RUN_NORMAL;
+        sprintf(log_buff, "Traffic %s is flowing \n", traffic->name);
+    }
+    else
     {
-        /* test and stop if traffic light is red */
-        wait_queue_test_and_wait(&traffic_light->traffic_light_faces[traffic->traffic_direction].wq, 
-            traffic->stop_traffic, arg);
+        traffic->traffic_status = TRAFFIC_RUN_SLOW;
+        sprintf(log_buff, "Traffic %s is slowing \n", traffic->name);
+    }
+    
+    file_write(log_buff);
+    /* exit critical section - release traffic light mutex */
+    TH_MUTEX_UNLOCK(&traffic_light->traffic_light_faces[traffic->traffic_direction].mutex);
 
+    /* drive on, back at the light once drive timer expires */
+    timer_wheel_add(traffic->timer_wheel, &traffic->drive_timer, TRAFFIC_DRIVE_MS, 0);
+    return NULL;
+}
 
-        /**
-         * traffic not stopping in traffic light 
-         * simulate traffic flowing by writing to file
-         */
-        if(traffic->traffic_light->traffic_light_faces[traffic->traffic_direction].color == GREEN)
-        {
-            sprintf(log_buff, "Traffic %s is flowing \n",traffic->thread->name);
-        }
+/**
+ * @brief   drive timer expiry, traffic arrives at light face again
+ *          test and stop if traffic light is red, no thread blocks either way
+ * 
+ * @param arg       traffic_t - traffic object 
+ * @return void* 
+ */
+static void *traffic_arrive_cb(void *arg)
+{
+    traffic_t *traffic = (traffic_t *) arg;
 
-        if(traffic->traffic_light->traffic_light_faces[traffic->traffic_direction].color == YELLOW)
-        {
-            sprintf(log_buff, "Traffic %s is slowing \n",traffic->thread->name);
-        }
-        
-        file_write(log_buff);
-        /* exit critical section - release traffic light mutex */
-        pthread_mutex_unlock(&traffic_light->traffic_light_faces[traffic->traffic_direction].mutex);
-        
-        sleep(2);
-    }
+    traffic->traffic_status = TRAFFIC_STOP;
+    wait_queue_test_and_wait_async(&traffic->waiter);
+    return NULL;
 }
 
-void traffic_init(traffic_t *traffic, direction_t traffic_dir, traffic_light_t *traffic_light)
+void traffic_init(traffic_t *traffic, direction_t traffic_dir, traffic_light_t *traffic_light,
+        thread_pool_t *th_pool, timer_wheel_t *timer_wheel)
 {
     static int east_traffic_number = 1;
     static int west_traffic_number = 1;
     static int north_traffic_number = 1;
     static int south_traffic_number = 1;
-    char traffic_name[32];
+    char *traffic_name = traffic->name;
 
     switch (traffic_dir)
     {
@@ -160,24 +184,120 @@ void traffic_init(traffic_t *traffic, direction_t traffic_dir, traffic_light_t *
         }
     }
 
-    traffic->thread = thread_create(NULL, traffic_name);
     traffic->traffic_direction = traffic_dir;
     traffic->traffic_light = traffic_light;
     traffic->traffic_status = TRAFFIC_RUN_NORMAL;
     traffic->stop_traffic = traffic_check_stop_condition;
+    traffic->timer_wheel = timer_wheel;
 
+    traffic->waiter.wq = &traffic_light->traffic_light_faces[traffic_dir].wq;
+    traffic->waiter.wait_queue_block_fn_cb = traffic->stop_traffic;
+    traffic->waiter.cont_fn = traffic_flow_cb;
+    traffic->waiter.arg = traffic;
+    traffic->waiter.th_pool = th_pool;
+
+    wheel_timer_init(&traffic->drive_timer, traffic_arrive_cb, traffic);
 }
-void traffic_run(traffic_t *traffic, void*(*traffic_function)(void* ))
+void traffic_run(traffic_t *traffic)
 {
-    thread_run(traffic->thread, traffic_function, traffic);
+    traffic_arrive_cb(traffic);
 }
 
 
 /**************************************** Traffic functions END ****************************************/
 
 
+/**************************************** Light Monitor BEGIN ****************************************/
+
+static const char *direction_names[MAX_DIRECTION] = { "East", "West", "North", "South" };
+static const char *color_names[MAX_TRAFFIC_LIGHT_COLOR] = { "Red", "Yellow", "Green" };
+
+/**
+ * @brief   light face watched by monitor
+ * 
+ */
+typedef struct light_face_watch_
+{
+    traffic_light_t *traffic_light;
+    direction_t direction;
+    traffic_light_color last_color;     /* color monitor reported last */
+}light_face_watch_t;
+
+/**
+ * @brief   block monitor while face color did not change since last report
+ *          compatible with wait_queue_t test condition function signature 
+ * 
+ * @param arg       light_face_watch_t - watched face 
+ * @param mutex     traffic light face mutex 
+ * @return true     no change 
+ *         false    color changed 
+ */
+static bool light_monitor_check_no_change(void *arg, pthread_mutex_t **mutex)
+{
+    light_face_watch_t *watch = (light_face_watch_t *) arg;
+    traffic_light_face_t *face = &watch->traffic_light->traffic_light_faces[watch->direction];
+
+    if(mutex != NULL)
+    {
+        *mutex = &face->mutex;
+        TH_MUTEX_LOCK(*mutex);
+    }
+    return face->color == watch->last_color;
+}
+
+/**
+ * @brief   light monitor thread, one thread waits on all four faces at once 
+ *          and logs every color change
+ * 
+ * @param arg       traffic_light_t - traffic light 
+ * @return void* 
+ */
+static void *light_monitor_fn(void *arg)
+{
+    traffic_light_t *traffic_light = (traffic_light_t *) arg;
+    light_face_watch_t watches[MAX_DIRECTION];
+    wait_queue_any_t entries[MAX_DIRECTION];
+    static char log_buff[256];
+    uint32_t fired;
+
+    for(int i = 0; i < MAX_DIRECTION; i++)
+    {
+        watches[i].traffic_light = traffic_light;
+        watches[i].direction = i;
+        watches[i].last_color = RED;
+    }
+
+    while(1)
+    {
+        for(int i = 0; i < MAX_DIRECTION; i++)
+        {
+            entries[i].wq = &traffic_light->traffic_light_faces[i].wq;
+            entries[i].wait_queue_block_fn_cb = light_monitor_check_no_change;
+            entries[i].arg = &watches[i];
+        }
+
+        /* returns with changed face mutex held */
+        wait_queue_wait_any(entries, MAX_DIRECTION, NULL, &fired);
+
+        watches[fired].last_color = traffic_light->traffic_light_faces[fired].color;
+        sprintf(log_buff, "Light %s turned %s \n", direction_names[fired], color_names[watches[fired].last_color]);
+        file_write(log_buff);
+
+        TH_MUTEX_UNLOCK(&traffic_light->traffic_light_faces[fired].mutex);
+    }
+    return NULL;
+}
+
+/**************************************** Light Monitor END ****************************************/
+
+
 /**************************************** Application BEGIN ****************************************/
 
+/* traffics launched when not given on command line */
+#define TRAFFIC_DEFAULT_COUNT   8
+/* pool threads moving traffics */
+#define TRAFFIC_POOL_THREADS    4
+
 void user_menu(traffic_light_t *traffic_light) {
 
     int choice ;
@@ -186,6 +306,14 @@ void user_menu(traffic_light_t *traffic_light) {
 
     while (1) {
 
+        /* current colors, read without stopping traffic on face mutexes */
+        printf("Lights :");
+        for(int i = 0; i < MAX_DIRECTION; i++)
+        {
+            printf(" %s %s", direction_names[i], color_names[traffic_light_get_status(traffic_light, i)]);
+        }
+        printf("\n");
+
         printf("Traffic light Operation : \n");
         printf ("1. East : Red \n");
         printf ("2. East : Yellow \n");
@@ -199,6 +327,9 @@ void user_menu(traffic_light_t *traffic_light) {
         printf ("10. South : Red \n");
         printf ("11. South : Yellow \n");
         printf ("12. South : Green \n");
+#ifdef THREADLIB_LOCK_PROFILE
+        printf ("13. Lock contention report \n");
+#endif
         printf ("Enter Choice : ");
 
         scanf("%d", &choice);
@@ -241,15 +372,20 @@ void user_menu(traffic_light_t *traffic_light) {
                 case 12:
                     dirn = SOUTH ; col = GREEN;
                     break;
+#ifdef THREADLIB_LOCK_PROFILE
+                case 13:
+                    th_lock_prof_report(stdout, 10);
+                    continue;
+#endif
                 default : ;
         }
 
         /* lock mutex (shared resource) */
-        pthread_mutex_lock(&traffic_light->traffic_light_faces[dirn].mutex);
+        TH_MUTEX_LOCK(&traffic_light->traffic_light_faces[dirn].mutex);
         
         traffic_light_set_status(traffic_light, dirn, col);
         
-        pthread_mutex_unlock(&traffic_light->traffic_light_faces[dirn].mutex);
+        TH_MUTEX_UNLOCK(&traffic_light->traffic_light_faces[dirn].mutex);
 
     } // while ends
 }
@@ -260,51 +396,36 @@ int main(int argc, char **argv) {
 
     traffic_light = calloc(1 , sizeof(traffic_light_t));
 
-    /* launching traffics */
-
-    /* traffic 1 */
-    traffic_t *traffic1 = calloc(1, sizeof(traffic_light_t));
-    traffic_init(traffic1, EAST, traffic_light);
-    traffic_run(traffic1, traffic_function_cb);
-
-    /* traffic 2 */
-    traffic_t *traffic2 = calloc(1, sizeof(traffic_light_t));
-    traffic_init(traffic2, EAST, traffic_light);
-    traffic_run(traffic2, traffic_function_cb);
-
-    /* traffic 3 */
-    traffic_t *traffic3 = calloc(1, sizeof(traffic_light_t));
-    traffic_init(traffic3, WEST, traffic_light);
-    traffic_run(traffic3, traffic_function_cb);
-
-    /* traffic 4 */
-    traffic_t *traffic4 = calloc(1, sizeof(traffic_light_t));
-    traffic_init(traffic4, WEST, traffic_light);
-    traffic_run(traffic4, traffic_function_cb);
-
-    /* traffic 5 */
-    traffic_t *traffic5 = calloc(1, sizeof(traffic_light_t));
-    traffic_init(traffic5, NORTH, traffic_light);
-    traffic_run(traffic5, traffic_function_cb);
-
-    /* traffic 6 */
-    traffic_t *traffic6 = calloc(1, sizeof(traffic_light_t));
-    traffic_init(traffic6, NORTH, traffic_light);
-    traffic_run(traffic6, traffic_function_cb);
-
-    /* traffic 7 */
-    traffic_t *traffic7 = calloc(1, sizeof(traffic_light_t));
-    traffic_init(traffic7, SOUTH, traffic_light);
-    traffic_run(traffic7, traffic_function_cb);
-
-    /* traffic 8 */
-    traffic_t *traffic8 = calloc(1, sizeof(traffic_light_t));
-    traffic_init(traffic8, SOUTH, traffic_light);
-    traffic_run(traffic8, traffic_function_cb);
-
-    /* initiate traffic light */
+    /* initiate traffic light before anyone waits on its faces */
     traffic_light_init(traffic_light);
 
+    /* a few pool threads move all traffics, a timer wheel times their driving */
+    thread_pool_t *th_pool = calloc(1, sizeof(thread_pool_t));
+    timer_wheel_t *timer_wheel = calloc(1, sizeof(timer_wheel_t));
+    char worker_name[32];
+
+    thread_pool_init(th_pool);
+    for(int i = 0; i < TRAFFIC_POOL_THREADS; i++)
+    {
+        sprintf(worker_name, "TH_WORKER%d", i + 1);
+        thread_pool_insert_new_thread(th_pool, thread_create(NULL, worker_name));
+    }
+    timer_wheel_init(timer_wheel, th_pool, 100);
+    timer_wheel_start(timer_wheel);
+
+    /* launching traffics, spread over all directions */
+    int traffic_count = argc > 1 ? atoi(argv[1]) : TRAFFIC_DEFAULT_COUNT;
+    traffic_t *traffics = calloc(traffic_count, sizeof(traffic_t));
+
+    for(int i = 0; i < traffic_count; i++)
+    {
+        traffic_init(&traffics[i], i % MAX_DIRECTION, traffic_light, th_pool, timer_wheel);
+        traffic_run(&traffics[i]);
+    }
+
+    /* light monitor */
+    thread_run(thread_create(NULL, "TH_MONITOR"), light_monitor_fn, traffic_light);
+
     user_menu(traffic_light);
 
     pthread_exit(0);
@@ -4,6 +4,8 @@
 #include "stdbool.h"
 #include "glthread.h"
 #include "threadlib.h"
+#include "timer_wheel.h"
+#include "th_seqlock.h"
 
 
 /**************************************** Traffic Light BEGIN ****************************************/
@@ -37,7 +39,8 @@ typedef enum
 
 typedef struct traffic_light_face_
 {
-    traffic_light_color color;
+    traffic_light_color color;          /* written under mutex, read under mutex or color_seq */
+    th_seqcount_t color_seq;            /* color readers not holding mutex */
     pthread_mutex_t mutex;
     wait_queue_t wq;
 
@@ -65,23 +68,35 @@ void traffic_light_init(traffic_light_t *traffic_light);
 void traffic_light_set_status(traffic_light_t *traffic_light, direction_t dir,
         traffic_light_color color);
 
+/**
+ * @brief get traffic light face color without taking face mutex
+ * 
+ * @param traffic_light 
+ * @param dir 
+ * @return traffic_light_color 
+ */
+traffic_light_color traffic_light_get_status(traffic_light_t *traffic_light, direction_t dir);
+
 
 /**************************************** Traffic Light END ****************************************/
 
 /**************************************** Traffic BEGIN ****************************************/
 
-/* thread data structure */
+/* traffic data structure */
 
 /**
- * @brief   car traffics in traffic light will be simulated with threads
- *          each thread will be act as a traffic moving
- *          Threads must know:
+ * @brief   car traffics in traffic light are asynchronous wait queue waiters,
+ *          a car waiting at a red light is a continuation queued on the light face,
+ *          not a blocked thread, so a few pool threads move any number of cars
+ *          Traffic must know:
  *              - direction which they are moving
  *              - Their own state: moving or waiting
- *              - The traffic light color in thread direction
+ *              - The traffic light color in traffic direction
  * 
  */
 
+/* time a car drives before it is back at the light */
+#define TRAFFIC_DRIVE_MS    2000
 
 /* enum for thread status */
 typedef enum
@@ -92,16 +107,19 @@ typedef enum
 }traffic_status;
 
 /**
- * @brief   thread private data , moving traffic data structure
+ * @brief   traffic private data , moving traffic data structure
  * 
  */
 typedef struct traffic_
 {
+    char name[32];
     direction_t traffic_direction;
     traffic_status traffic_status;        
-    thread_t *thread;                   /* thread object */
     traffic_light_t *traffic_light;     /* main application resources */
     wait_queue_condn_fn stop_traffic;   /* function that test and stop traffic */
+    wait_queue_async_t waiter;          /* car waiting at light face */
+    wheel_timer_t drive_timer;          /* car driving after passing the light */
+    timer_wheel_t *timer_wheel;
 
 }traffic_t;
 
@@ -111,16 +129,18 @@ typedef struct traffic_
  * @param traffic 
  * @param traffic_dir 
  * @param traffic_light 
+ * @param th_pool           pool running traffic continuations
+ * @param timer_wheel       wheel timing traffic driving
  */
-void traffic_init(traffic_t *traffic, direction_t traffic_dir, traffic_light_t *traffic_light);
+void traffic_init(traffic_t *traffic, direction_t traffic_dir, traffic_light_t *traffic_light,
+        thread_pool_t *th_pool, timer_wheel_t *timer_wheel);
 
 /**
- * @brief   start run and start flow traffic 
+ * @brief   start flow traffic, traffic arrives at its light face 
  * 
  * @param traffic               traffic_t object 
- * @param traffic_function      traffic run function pointer
  */
-void traffic_run(traffic_t *traffic, void*(*traffic_function)(void* ));
+void traffic_run(traffic_t *traffic);
 
 /**************************************** Traffic END ****************************************/
 
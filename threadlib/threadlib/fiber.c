@@ -0,0 +1,373 @@
+/**
+ * @file fiber.c
+ * @author agent
+ * @brief  This file implements stackful fibers multiplexed on thread pool workers
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "fiber.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <sys/mman.h>
+
+/**
+ * fiber may resume on a different worker than the one it parked on,
+ * thread local variables are only accessed through the noinline helpers below
+ * so compiler never cache a thread local address across a context switch
+ */
+static __thread fiber_t *current_fiber;         /* fiber running on this worker */
+static __thread ucontext_t *worker_ctx;         /* scheduler loop context of this worker */
+
+/*********** private helper functions BEGIN **********/
+
+__attribute__((noinline)) static ucontext_t *fiber_worker_ctx(void)
+{
+    return worker_ctx;
+}
+
+__attribute__((noinline)) static void fiber_set_current(fiber_t *fiber, ucontext_t *ctx)
+{
+    current_fiber = fiber;
+    worker_ctx = ctx;
+}
+
+/**
+ * @brief   allocate fiber stack with a PROT_NONE guard page below it,
+ *          stack overflow fault on guard page instead of corrupting memory
+ *
+ * @param stack_size - usable stack size, page aligned
+ * @return void* - mapping base (guard page)
+ */
+static void *fiber_stack_alloc(size_t stack_size)
+{
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    void *base;
+
+    base = mmap(NULL, stack_size + page_size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    assert(base != MAP_FAILED);
+    mprotect(base, page_size, PROT_NONE);
+    return base;
+}
+
+/**
+ * @brief   append fiber to scheduler run queue, caller holds sched->mutex
+ *
+ * @param sched
+ * @param fiber
+ */
+static void fiber_run_queue_push(fiber_sched_t *sched, fiber_t *fiber)
+{
+    init_glthread(&fiber->glue);
+    fiber->state = FIBER_READY;
+    glthread_list_add_last(&sched->run_queue, &fiber->glue);
+}
+
+/**
+ * @brief   pop first fiber from scheduler run queue, caller holds sched->mutex
+ *
+ * @param sched
+ * @return fiber_t* - NULL if run queue empty
+ */
+static fiber_t *fiber_run_queue_pop(fiber_sched_t *sched)
+{
+    glthread_t *node = glthread_list_dequeue_first(&sched->run_queue);
+
+    return node != NULL ? glue_to_fiber(node) : NULL;
+}
+
+/**
+ * @brief   make parked fiber ready and wakeup an idle worker
+ *
+ * @param fiber
+ */
+static void fiber_make_ready(fiber_t *fiber)
+{
+    fiber_sched_t *sched = fiber->sched;
+
+    TH_MUTEX_LOCK(&sched->mutex);
+    fiber_run_queue_push(sched, fiber);
+    pthread_cond_signal(&sched->cv);
+    TH_MUTEX_UNLOCK(&sched->mutex);
+}
+
+/**
+ * @brief   first function run on fiber stack
+ *          makecontext only pass int arguments, fiber pointer is split in two halves
+ *
+ * @param hi - fiber pointer upper 32 bits
+ * @param lo - fiber pointer lower 32 bits
+ */
+static void fiber_trampoline(uint32_t hi, uint32_t lo)
+{
+    fiber_t *fiber = (fiber_t *)(((uintptr_t)hi << 32) | (uintptr_t)lo);
+
+    fiber->fiber_fn(fiber->arg);
+
+    /* back to worker for good, worker recycle the fiber */
+    fiber->state = FIBER_DONE;
+    swapcontext(&fiber->ctx, fiber_worker_ctx());
+}
+
+/**
+ * @brief   scheduler loop, run on thread pool worker
+ *          pick ready fibers and run them until they park, yield or finish
+ *
+ * @param arg - fiber_sched_t - pointer
+ * @return void*
+ */
+static void *fiber_worker_fn(void *arg)
+{
+    fiber_sched_t *sched = (fiber_sched_t *) arg;
+    ucontext_t sched_ctx;
+    pthread_mutex_t *unlock_mutex;
+    fiber_t *fiber;
+
+    TH_MUTEX_LOCK(&sched->mutex);
+    while(1)
+    {
+        /* block worker while nothing to run */
+        while(IS_GLTHREAD_LIST_T_EMPTY(&sched->run_queue) && !sched->shutdown)
+        {
+            TH_COND_WAIT(&sched->cv, &sched->mutex);
+        }
+        fiber = fiber_run_queue_pop(sched);
+        if(fiber == NULL)
+        {
+            break;
+        }
+        TH_MUTEX_UNLOCK(&sched->mutex);
+
+        /* switch to fiber */
+        fiber->state = FIBER_RUNNING;
+        fiber_set_current(fiber, &sched_ctx);
+        swapcontext(&sched_ctx, &fiber->ctx);
+        fiber_set_current(NULL, NULL);
+
+        /* fiber switched out */
+        switch(fiber->state)
+        {
+            case FIBER_PARKED:
+            {
+                /* fiber is in wait list now, wakers can see it only after mutex released */
+                unlock_mutex = fiber->unlock_mutex;
+                fiber->unlock_mutex = NULL;
+                TH_MUTEX_UNLOCK(unlock_mutex);
+                TH_MUTEX_LOCK(&sched->mutex);
+                break;
+            }
+            case FIBER_READY:
+            {
+                /* yielded */
+                TH_MUTEX_LOCK(&sched->mutex);
+                fiber_run_queue_push(sched, fiber);
+                break;
+            }
+            case FIBER_DONE:
+            default:
+            {
+                TH_MUTEX_LOCK(&sched->mutex);
+                glthread_add_next(&sched->free_list, &fiber->glue);
+                sched->fiber_count--;
+                if(sched->fiber_count == 0)
+                {
+                    pthread_cond_broadcast(&sched->done_cv);
+                }
+                break;
+            }
+        }
+    }
+
+    /* shutdown, return worker to thread pool */
+    sched->worker_count--;
+    pthread_cond_broadcast(&sched->done_cv);
+    TH_MUTEX_UNLOCK(&sched->mutex);
+    return NULL;
+}
+
+/*********** private helper functions END ***********/
+
+void fiber_sched_init(fiber_sched_t *sched, size_t stack_size)
+{
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+
+    if(stack_size == 0)
+    {
+        stack_size = FIBER_DEFAULT_STACK_SIZE;
+    }
+    init_glthread_list(&sched->run_queue);
+    init_glthread(&sched->free_list);
+    sched->stack_size = (stack_size + page_size - 1) & ~(page_size - 1);
+    sched->fiber_count = 0;
+    sched->worker_count = 0;
+    sched->shutdown = false;
+    pthread_mutex_init(&sched->mutex, NULL);
+    TH_LOCK_PROF_NAME(&sched->mutex, "fiber_sched_t mutex");
+    pthread_cond_init(&sched->cv, NULL);
+    pthread_cond_init(&sched->done_cv, NULL);
+}
+
+uint32_t fiber_sched_start(fiber_sched_t *sched, thread_pool_t *th_pool, uint32_t worker_count)
+{
+    uint32_t started = 0;
+
+    for(uint32_t i = 0; i < worker_count; i++)
+    {
+        /* count worker before it runs, it decrement on exit */
+        TH_MUTEX_LOCK(&sched->mutex);
+        sched->worker_count++;
+        TH_MUTEX_UNLOCK(&sched->mutex);
+
+        if(!thread_pool_dispatch_thread(th_pool, fiber_worker_fn, sched, false))
+        {
+            TH_MUTEX_LOCK(&sched->mutex);
+            sched->worker_count--;
+            TH_MUTEX_UNLOCK(&sched->mutex);
+            break;
+        }
+        started++;
+    }
+    return started;
+}
+
+void fiber_sched_join(fiber_sched_t *sched)
+{
+    TH_MUTEX_LOCK(&sched->mutex);
+    while(sched->fiber_count > 0)
+    {
+        TH_COND_WAIT(&sched->done_cv, &sched->mutex);
+    }
+
+    /* stop workers */
+    sched->shutdown = true;
+    pthread_cond_broadcast(&sched->cv);
+    while(sched->worker_count > 0)
+    {
+        TH_COND_WAIT(&sched->done_cv, &sched->mutex);
+    }
+    TH_MUTEX_UNLOCK(&sched->mutex);
+}
+
+void fiber_sched_destroy(fiber_sched_t *sched)
+{
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    glthread_t *node;
+    fiber_t *fiber;
+
+    assert(sched->fiber_count == 0 && sched->worker_count == 0);
+
+    while((node = dequeue_glthread_first(&sched->free_list)) != NULL)
+    {
+        fiber = glue_to_fiber(node);
+        munmap(fiber->stack, fiber->stack_size + page_size);
+        free(fiber);
+    }
+    pthread_mutex_destroy(&sched->mutex);
+    pthread_cond_destroy(&sched->cv);
+    pthread_cond_destroy(&sched->done_cv);
+}
+
+fiber_t *fiber_create(fiber_sched_t *sched, char *name, void *(*fiber_fn)(void *), void *arg)
+{
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    glthread_t *node;
+    fiber_t *fiber = NULL;
+
+    /* reuse finished fiber and its stack */
+    TH_MUTEX_LOCK(&sched->mutex);
+    node = dequeue_glthread_first(&sched->free_list);
+    TH_MUTEX_UNLOCK(&sched->mutex);
+
+    if(node != NULL)
+    {
+        fiber = glue_to_fiber(node);
+    }
+    else
+    {
+        fiber = calloc(1, sizeof(fiber_t));
+        fiber->stack_size = sched->stack_size;
+        fiber->stack = fiber_stack_alloc(fiber->stack_size);
+    }
+
+    strncpy(fiber->name, name, sizeof(fiber->name) - 1);
+    fiber->fiber_fn = fiber_fn;
+    fiber->arg = arg;
+    fiber->sched = sched;
+    fiber->unlock_mutex = NULL;
+
+    /* fiber context start at trampoline on top of its own stack */
+    getcontext(&fiber->ctx);
+    fiber->ctx.uc_stack.ss_sp = (char *)fiber->stack + page_size;
+    fiber->ctx.uc_stack.ss_size = fiber->stack_size;
+    fiber->ctx.uc_link = NULL;
+    makecontext(&fiber->ctx, (void (*)(void))fiber_trampoline, 2,
+                (uint32_t)((uintptr_t)fiber >> 32), (uint32_t)(uintptr_t)fiber);
+
+    TH_MUTEX_LOCK(&sched->mutex);
+    sched->fiber_count++;
+    fiber_run_queue_push(sched, fiber);
+    pthread_cond_signal(&sched->cv);
+    TH_MUTEX_UNLOCK(&sched->mutex);
+
+    return fiber;
+}
+
+__attribute__((noinline)) fiber_t *fiber_self(void)
+{
+    return current_fiber;
+}
+
+void fiber_yield(void)
+{
+    fiber_t *fiber = fiber_self();
+
+    assert(fiber != NULL);
+    fiber->state = FIBER_READY;
+    swapcontext(&fiber->ctx, fiber_worker_ctx());
+}
+
+void fiber_wait(glthread_list_t *wait_list, pthread_mutex_t *mutex)
+{
+    fiber_t *fiber = fiber_self();
+
+    assert(fiber != NULL);
+    init_glthread(&fiber->glue);
+    glthread_list_add_last(wait_list, &fiber->glue);
+
+    /* worker release mutex after switch, so a waker never resume a fiber still on its stack */
+    fiber->state = FIBER_PARKED;
+    fiber->unlock_mutex = mutex;
+    swapcontext(&fiber->ctx, fiber_worker_ctx());
+
+    /* woken up, possibly on another worker */
+    TH_MUTEX_LOCK(mutex);
+}
+
+bool fiber_wake_one(glthread_list_t *wait_list)
+{
+    glthread_t *node = glthread_list_dequeue_first(wait_list);
+
+    if(node == NULL)
+    {
+        return false;
+    }
+    fiber_make_ready(glue_to_fiber(node));
+    return true;
+}
+
+uint32_t fiber_wake_all(glthread_list_t *wait_list)
+{
+    uint32_t count = 0;
+
+    while(fiber_wake_one(wait_list))
+    {
+        count++;
+    }
+    return count;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file fiber.h
+ * @author agent
+ * @brief  This file defines stackful fibers (user space threads) multiplexed
+ *         on thread pool workers (M:N scheduling).
+ *         Fibers blocking on threadlib wait queues or barriers yield the worker
+ *         instead of blocking it.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIBER__
+#define __FIBER__
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <ucontext.h>
+#include "glthread.h"
+#include "threadlib.h"
+
+/* default fiber stack size, guard page is added below it */
+#define FIBER_DEFAULT_STACK_SIZE    (64 * 1024)
+
+typedef enum
+{
+    FIBER_READY,            /* in scheduler run queue */
+    FIBER_RUNNING,          /* running on a worker */
+    FIBER_PARKED,           /* blocked in a wait list, worker released */
+    FIBER_DONE,             /* fiber function returned, object back in scheduler free list */
+}fiber_state_t;
+
+struct fiber_sched_;
+
+typedef struct fiber_
+{
+    char name[32];                              /* fiber name */
+    ucontext_t ctx;                             /* saved fiber context */
+    void *(*fiber_fn)(void *);                  /* fiber work function */
+    void *arg;                                  /* fiber work args */
+    void *stack;                                /* mmaped stack, lowest page is guard page */
+    size_t stack_size;                          /* stack size excluding guard page */
+    fiber_state_t state;
+    pthread_mutex_t *unlock_mutex;              /* mutex released by worker once fiber switched out */
+    struct fiber_sched_ *sched;                 /* owner scheduler */
+    glthread_t glue;                            /* run queue, wait list or free list node */
+}fiber_t;
+GLTHREAD_TO_STRUCT(glue_to_fiber, fiber_t, glue);
+
+/**
+ * @brief fiber scheduler, fibers run queue shared by its pool workers
+ *
+ */
+typedef struct fiber_sched_
+{
+    glthread_list_t run_queue;                  /* ready fibers, FIFO */
+    glthread_t free_list;                       /* finished fibers with stacks, ready for reuse */
+    size_t stack_size;                          /* stack size of fibers created by scheduler */
+    uint32_t fiber_count;                       /* live fibers */
+    uint32_t worker_count;                      /* workers running scheduler loop */
+    bool shutdown;                              /* workers exit when run queue drains */
+    pthread_mutex_t mutex;
+    pthread_cond_t cv;                          /* idle workers wait for ready fibers */
+    pthread_cond_t done_cv;                     /* fiber_sched_join waits for fibers and workers */
+}fiber_sched_t;
+
+/**
+ * @brief initiate fiber scheduler
+ *
+ * @note  mutex stays a pthread mutex, idle workers and fiber_sched_join() sleep on
+ *        condition variables bound to it
+ *
+ * @param sched
+ * @param stack_size - fiber stack size, 0 for FIBER_DEFAULT_STACK_SIZE
+ */
+void fiber_sched_init(fiber_sched_t *sched, size_t stack_size);
+
+/**
+ * @brief   dispatch scheduler loop on thread pool workers
+ *
+ * @param sched
+ * @param th_pool
+ * @param worker_count - number of pool threads to run fibers on
+ * @return uint32_t    - number of workers started, limited by idle threads in pool
+ */
+uint32_t fiber_sched_start(fiber_sched_t *sched, thread_pool_t *th_pool, uint32_t worker_count);
+
+/**
+ * @brief   wait for all fibers to finish, then stop workers (they return to the pool)
+ *
+ * @param sched
+ */
+void fiber_sched_join(fiber_sched_t *sched);
+
+/**
+ * @brief   destroy scheduler, release pooled fiber stacks
+ *
+ * @note    scheduler must be joined
+ *
+ * @param sched
+ */
+void fiber_sched_destroy(fiber_sched_t *sched);
+
+/**
+ * @brief   create fiber and make it ready to run
+ *
+ * @param sched
+ * @param name
+ * @param fiber_fn
+ * @param arg
+ * @return fiber_t* - fiber owned by scheduler, valid until fiber_fn return
+ */
+fiber_t *fiber_create(fiber_sched_t *sched, char *name, void *(*fiber_fn)(void *), void *arg);
+
+/**
+ * @brief   current fiber
+ *
+ * @return fiber_t* - NULL if caller is not running in a fiber
+ */
+fiber_t *fiber_self(void);
+
+/**
+ * @brief   give worker to another ready fiber, current fiber stays ready
+ *
+ */
+void fiber_yield(void);
+
+/**
+ * @brief   block current fiber in a wait list
+ *
+ * @note    caller holds `mutex` which protects `wait_list`, fiber is appended to wait_list,
+ *          mutex released after fiber switched out and locked again before return,
+ *          same contract as pthread_cond_wait()
+ *
+ * @param wait_list
+ * @param mutex
+ */
+void fiber_wait(glthread_list_t *wait_list, pthread_mutex_t *mutex);
+
+/**
+ * @brief   wake first fiber in wait list, caller holds wait list mutex
+ *
+ * @param wait_list
+ * @return true - a fiber was woken
+ */
+bool fiber_wake_one(glthread_list_t *wait_list);
+
+/**
+ * @brief   wake all fibers in wait list, caller holds wait list mutex
+ *
+ * @param wait_list
+ * @return uint32_t - number of fibers woken
+ */
+uint32_t fiber_wake_all(glthread_list_t *wait_list);
+
+#endif /* __FIBER__ */
@@ -0,0 +1,396 @@
+/**
+ * @file parking_lot.c
+ * @author agent
+ * @brief  This file implements global parking lot and byte lock / condition on top of it
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "parking_lot.h"
+#include "th_park.h"
+#include "th_telemetry.h"
+#include "glthread.h"
+#include "th_lock_prof.h"
+#include <errno.h>
+#include <sched.h>
+
+/* bucket lock states */
+#define PARKING_LOT_UNLOCKED        0
+#define PARKING_LOT_LOCKED          1
+#define PARKING_LOT_CONTENDED       2
+
+/**
+ * @brief   parked thread record, lives on parked thread stack
+ *
+ */
+typedef struct parking_lot_waiter_
+{
+    glthread_t glue;                            /* bucket queue node, unlinked by unparker */
+    const void *key;
+    th_parker_t *parker;                        /* parked thread parker */
+}parking_lot_waiter_t;
+GLTHREAD_TO_STRUCT(glue_to_parking_lot_waiter, parking_lot_waiter_t, glue);
+
+/**
+ * @brief   hash bucket, one cache line each so unrelated keys do not share lock line
+ *
+ */
+typedef struct parking_lot_bucket_
+{
+    _Alignas(TH_CACHE_LINE_SIZE) _Atomic uint32_t lock;    /* futex lock, PARKING_LOT_* states */
+    glthread_list_t waiters;                    /* parked threads of all keys hashed here, oldest first */
+}parking_lot_bucket_t;
+
+/**
+ * @brief   byte condition wait, park argument
+ *
+ */
+typedef struct th_byte_cond_wait_
+{
+    th_byte_cond_t *cond;
+    th_byte_lock_t *lock;                       /* NULL when mutex is used */
+    pthread_mutex_t *mutex;
+}th_byte_cond_wait_t;
+
+static parking_lot_bucket_t parking_lot_table[PARKING_LOT_BUCKETS];
+
+/*********** private helper functions BEGIN **********/
+
+/**
+ * @brief   bucket of key, fibonacci hashing of the address
+ *
+ * @param key
+ * @return parking_lot_bucket_t*
+ */
+static parking_lot_bucket_t *parking_lot_bucket(const void *key)
+{
+    uint64_t hash = ((uint64_t)(uintptr_t)key) * 0x9E3779B97F4A7C15ULL;
+
+    return &parking_lot_table[hash >> (64 - __builtin_ctz(PARKING_LOT_BUCKETS))];
+}
+
+/**
+ * @brief   lock bucket, futex mutex with contended state (only sleepers pay a syscall)
+ *
+ * @param bucket
+ */
+static void parking_lot_bucket_lock(parking_lot_bucket_t *bucket)
+{
+    uint32_t state = PARKING_LOT_UNLOCKED;
+
+    if(atomic_compare_exchange_strong_explicit(&bucket->lock, &state, PARKING_LOT_LOCKED,
+                memory_order_acquire, memory_order_relaxed))
+    {
+        return;
+    }
+
+    /* hold times are a few list operations, yield once before sleeping */
+    sched_yield();
+    while(atomic_exchange_explicit(&bucket->lock, PARKING_LOT_CONTENDED, memory_order_acquire) != PARKING_LOT_UNLOCKED)
+    {
+        th_futex_wait(&bucket->lock, PARKING_LOT_CONTENDED);
+    }
+}
+
+/**
+ * @brief   unlock bucket
+ *
+ * @param bucket
+ */
+static void parking_lot_bucket_unlock(parking_lot_bucket_t *bucket)
+{
+    if(atomic_exchange_explicit(&bucket->lock, PARKING_LOT_UNLOCKED, memory_order_release) == PARKING_LOT_CONTENDED)
+    {
+        th_futex_wake(&bucket->lock, 1);
+    }
+}
+
+/**
+ * @brief   byte lock park validation, sleep only while lock is held with parked bit set
+ *
+ * @param arg - th_byte_lock_t
+ * @return true
+ */
+static bool th_byte_lock_validate(void *arg)
+{
+    th_byte_lock_t *lock = (th_byte_lock_t *) arg;
+
+    return atomic_load_explicit(&lock->state, memory_order_relaxed) == (TH_BYTE_LOCK_LOCKED | TH_BYTE_LOCK_PARKED);
+}
+
+/**
+ * @brief   byte lock unpark callback, release lock and keep parked bit if more lockers sleep
+ *
+ * @param arg - th_byte_lock_t
+ * @param unparked
+ * @param more_waiters
+ */
+static void th_byte_lock_unpark_cb(void *arg, uint32_t unparked, bool more_waiters)
+{
+    th_byte_lock_t *lock = (th_byte_lock_t *) arg;
+
+    (void) unparked;
+    atomic_store_explicit(&lock->state, more_waiters ? TH_BYTE_LOCK_PARKED : 0, memory_order_release);
+}
+
+/**
+ * @brief   byte condition park validation, mark waiters under bucket lock
+ *
+ * @param arg - th_byte_cond_wait_t
+ * @return true
+ */
+static bool th_byte_cond_validate(void *arg)
+{
+    th_byte_cond_wait_t *wait = (th_byte_cond_wait_t *) arg;
+
+    atomic_store(&wait->cond->has_waiters, 1);
+    return true;
+}
+
+/**
+ * @brief   byte condition unpark callback, clear waiters mark once queue drained
+ *
+ * @param arg - th_byte_cond_t
+ * @param unparked
+ * @param more_waiters
+ */
+static void th_byte_cond_unpark_cb(void *arg, uint32_t unparked, bool more_waiters)
+{
+    th_byte_cond_t *cond = (th_byte_cond_t *) arg;
+
+    (void) unparked;
+    atomic_store_explicit(&cond->has_waiters, more_waiters ? 1 : 0, memory_order_relaxed);
+}
+
+/**
+ * @brief   byte condition before sleep, release the lock of the waited condition
+ *
+ * @param arg - th_byte_cond_wait_t
+ */
+static void th_byte_cond_unlock(void *arg)
+{
+    th_byte_cond_wait_t *wait = (th_byte_cond_wait_t *) arg;
+
+    if(wait->lock != NULL)
+    {
+        th_byte_lock_unlock(wait->lock);
+    }
+    else
+    {
+        TH_MUTEX_UNLOCK(wait->mutex);
+    }
+}
+
+/*********** private helper functions END ***********/
+
+int parking_lot_park(const void *key, parking_lot_validate_fn validate,
+        parking_lot_before_sleep_fn before_sleep, void *arg, const struct timespec *deadline)
+{
+    parking_lot_bucket_t *bucket = parking_lot_bucket(key);
+    parking_lot_waiter_t waiter;
+    int rc;
+
+    waiter.key = key;
+    waiter.parker = th_parker_self();
+    init_glthread(&waiter.glue);
+
+    parking_lot_bucket_lock(bucket);
+    if(validate != NULL && !validate(arg))
+    {
+        parking_lot_bucket_unlock(bucket);
+        return EAGAIN;
+    }
+    glthread_list_add_last(&bucket->waiters, &waiter.glue);
+    parking_lot_bucket_unlock(bucket);
+
+    if(before_sleep != NULL)
+    {
+        before_sleep(arg);
+    }
+
+    for(;;)
+    {
+        rc = th_park_until(waiter.parker, deadline);
+
+        /* unparker unlinks and unparks under bucket lock */
+        parking_lot_bucket_lock(bucket);
+        if(IS_GLTHREAD_LIST_EMPTY(&waiter.glue))
+        {
+            parking_lot_bucket_unlock(bucket);
+            if(rc == ETIMEDOUT)
+            {
+                /* unparked right at the deadline, consume wakeup */
+                th_park(waiter.parker);
+            }
+            return 0;
+        }
+        if(rc == ETIMEDOUT)
+        {
+            glthread_list_remove(&bucket->waiters, &waiter.glue);
+            parking_lot_bucket_unlock(bucket);
+            return ETIMEDOUT;
+        }
+        parking_lot_bucket_unlock(bucket);
+    }
+}
+
+uint32_t parking_lot_unpark(const void *key, uint32_t count, parking_lot_unpark_fn callback, void *arg)
+{
+    parking_lot_bucket_t *bucket = parking_lot_bucket(key);
+    parking_lot_waiter_t *waiter;
+    glthread_t *curr;
+    uint32_t unparked = 0;
+    bool more_waiters = false;
+
+    parking_lot_bucket_lock(bucket);
+    ITERATE_GLTHREAD_BEGIN(GLTHREAD_LIST_HEAD(&bucket->waiters), curr)
+    {
+        waiter = glue_to_parking_lot_waiter(curr);
+        if(waiter->key != key)
+        {
+            continue;
+        }
+        if(unparked == count)
+        {
+            more_waiters = true;
+            break;
+        }
+        glthread_list_remove(&bucket->waiters, &waiter->glue);
+        /* waiter may return as soon as it is unparked, touch nothing of it afterwards */
+        th_unpark(waiter->parker);
+        unparked++;
+    } ITERATE_GLTHREAD_END(GLTHREAD_LIST_HEAD(&bucket->waiters), curr);
+
+    if(callback != NULL)
+    {
+        callback(arg, unparked, more_waiters);
+    }
+    parking_lot_bucket_unlock(bucket);
+    return unparked;
+}
+
+void th_byte_lock_init(th_byte_lock_t *lock)
+{
+    atomic_init(&lock->state, 0);
+}
+
+bool th_byte_lock_trylock(th_byte_lock_t *lock)
+{
+    uint8_t state = atomic_load_explicit(&lock->state, memory_order_relaxed);
+
+    while(!(state & TH_BYTE_LOCK_LOCKED))
+    {
+        if(atomic_compare_exchange_weak_explicit(&lock->state, &state, state | TH_BYTE_LOCK_LOCKED,
+                    memory_order_acquire, memory_order_relaxed))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void th_byte_lock_lock(th_byte_lock_t *lock)
+{
+    uint8_t state = 0;
+    uint32_t spin = 0;
+
+    /* fast path - uncontended */
+    if(atomic_compare_exchange_strong_explicit(&lock->state, &state, TH_BYTE_LOCK_LOCKED,
+                memory_order_acquire, memory_order_relaxed))
+    {
+        return;
+    }
+
+    for(;;)
+    {
+        state = atomic_load_explicit(&lock->state, memory_order_relaxed);
+
+        /* lock free, take it even if others are parked (barging keeps lock hot) */
+        if(!(state & TH_BYTE_LOCK_LOCKED))
+        {
+            if(atomic_compare_exchange_weak_explicit(&lock->state, &state, state | TH_BYTE_LOCK_LOCKED,
+                        memory_order_acquire, memory_order_relaxed))
+            {
+                return;
+            }
+            continue;
+        }
+
+        /* nobody parked yet, holder may release soon */
+        if(!(state & TH_BYTE_LOCK_PARKED) && spin < TH_BYTE_LOCK_SPIN_COUNT)
+        {
+            spin++;
+            sched_yield();
+            continue;
+        }
+
+        if(!(state & TH_BYTE_LOCK_PARKED) &&
+           !atomic_compare_exchange_weak_explicit(&lock->state, &state, state | TH_BYTE_LOCK_PARKED,
+                    memory_order_relaxed, memory_order_relaxed))
+        {
+            continue;
+        }
+
+        parking_lot_park(lock, th_byte_lock_validate, NULL, lock, NULL);
+    }
+}
+
+void th_byte_lock_unlock(th_byte_lock_t *lock)
+{
+    uint8_t state = TH_BYTE_LOCK_LOCKED;
+
+    /* fast path - nobody parked */
+    if(atomic_compare_exchange_strong_explicit(&lock->state, &state, 0,
+                memory_order_release, memory_order_relaxed))
+    {
+        return;
+    }
+
+    /* release under bucket lock so the parked bit stays exact */
+    parking_lot_unpark(lock, 1, th_byte_lock_unpark_cb, lock);
+}
+
+void th_byte_cond_init(th_byte_cond_t *cond)
+{
+    atomic_init(&cond->has_waiters, 0);
+}
+
+int th_byte_cond_wait(th_byte_cond_t *cond, th_byte_lock_t *lock, const struct timespec *deadline)
+{
+    th_byte_cond_wait_t wait = { cond, lock, NULL };
+    int rc;
+
+    /* waiters mark is set under bucket lock while lock is still held, so no signal is lost */
+    rc = parking_lot_park(cond, th_byte_cond_validate, th_byte_cond_unlock, &wait, deadline);
+    th_byte_lock_lock(lock);
+    return rc;
+}
+
+int th_byte_cond_wait_mutex(th_byte_cond_t *cond, pthread_mutex_t *mutex, const struct timespec *deadline)
+{
+    th_byte_cond_wait_t wait = { cond, NULL, mutex };
+    int rc;
+
+    rc = parking_lot_park(cond, th_byte_cond_validate, th_byte_cond_unlock, &wait, deadline);
+    TH_MUTEX_LOCK(mutex);
+    return rc;
+}
+
+void th_byte_cond_signal(th_byte_cond_t *cond)
+{
+    if(atomic_load(&cond->has_waiters))
+    {
+        parking_lot_unpark(cond, 1, th_byte_cond_unpark_cb, cond);
+    }
+}
+
+void th_byte_cond_broadcast(th_byte_cond_t *cond)
+{
+    if(atomic_load(&cond->has_waiters))
+    {
+        parking_lot_unpark(cond, UINT32_MAX, th_byte_cond_unpark_cb, cond);
+    }
+}
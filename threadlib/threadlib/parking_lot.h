@@ -0,0 +1,170 @@
+/**
+ * @file parking_lot.h
+ * @author agent
+ * @brief  This file defines global parking lot, a hashed table of wait queues keyed by address,
+ *         so wait objects need no condition variable or mutex of their own.
+ *         byte lock and byte condition built on it take one byte each,
+ *         bucket locks are only taken by threads that actually sleep or wake sleepers
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __PARKING_LOT__
+#define __PARKING_LOT__
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/* buckets in parking lot table, power of two */
+#define PARKING_LOT_BUCKETS         512
+
+/* byte lock state bits */
+#define TH_BYTE_LOCK_LOCKED         1
+#define TH_BYTE_LOCK_PARKED         2
+/* lock attempts before a contended locker parks */
+#define TH_BYTE_LOCK_SPIN_COUNT     40
+
+/**
+ * @brief   park validation, called under bucket lock before queueing
+ *
+ * @return true - go to sleep, false - abort park
+ */
+typedef bool (*parking_lot_validate_fn)(void *arg);
+
+/**
+ * @brief   called once thread is queued and bucket lock released, before sleeping
+ *          (e.g. to release the lock protecting the waited condition)
+ */
+typedef void (*parking_lot_before_sleep_fn)(void *arg);
+
+/**
+ * @brief   called under bucket lock once unpark picked its waiters
+ *
+ * @param arg
+ * @param unparked - number of threads unparked
+ * @param more_waiters - threads still parked on the key
+ */
+typedef void (*parking_lot_unpark_fn)(void *arg, uint32_t unparked, bool more_waiters);
+
+/**
+ * @brief   sleep on key until unparked
+ *
+ * @note    validate and queueing are atomic with respect to unparking on the same key,
+ *          a thread that checked its condition in validate never misses the wakeup
+ *
+ * @param key - any address, usually the wait object itself
+ * @param validate - NULL to always park
+ * @param before_sleep - NULL for none
+ * @param arg - passed to validate and before_sleep
+ * @param deadline - absolute CLOCK_MONOTONIC time, NULL to wait forever
+ * @return int - 0 unparked, EAGAIN validate refused, ETIMEDOUT
+ */
+int parking_lot_park(const void *key, parking_lot_validate_fn validate,
+        parking_lot_before_sleep_fn before_sleep, void *arg, const struct timespec *deadline);
+
+/**
+ * @brief   wakeup up to count threads parked on key, oldest first
+ *
+ * @param key
+ * @param count - UINT32_MAX for all
+ * @param callback - NULL for none
+ * @param arg - passed to callback
+ * @return uint32_t - threads unparked
+ */
+uint32_t parking_lot_unpark(const void *key, uint32_t count, parking_lot_unpark_fn callback, void *arg);
+
+/**
+ * @brief   one byte mutex, uncontended lock and unlock are a single compare exchange
+ *
+ */
+typedef struct th_byte_lock_
+{
+    _Atomic uint8_t state;                      /* TH_BYTE_LOCK_* bits */
+}th_byte_lock_t;
+
+/**
+ * @brief   one byte condition variable, used with th_byte_lock_t
+ *
+ */
+typedef struct th_byte_cond_
+{
+    _Atomic uint8_t has_waiters;                /* set while threads are parked on it */
+}th_byte_cond_t;
+
+/**
+ * @brief initiate byte lock
+ *
+ * @param lock
+ */
+void th_byte_lock_init(th_byte_lock_t *lock);
+
+/**
+ * @brief lock byte lock, spin a little then park
+ *
+ * @param lock
+ */
+void th_byte_lock_lock(th_byte_lock_t *lock);
+
+/**
+ * @brief   try lock byte lock
+ *
+ * @param lock
+ * @return true - locked
+ */
+bool th_byte_lock_trylock(th_byte_lock_t *lock);
+
+/**
+ * @brief   unlock byte lock, parking lot is only touched when a locker is parked
+ *
+ * @param lock
+ */
+void th_byte_lock_unlock(th_byte_lock_t *lock);
+
+/**
+ * @brief initiate byte condition
+ *
+ * @param cond
+ */
+void th_byte_cond_init(th_byte_cond_t *cond);
+
+/**
+ * @brief   release lock and sleep on condition, lock is held again on return
+ *
+ * @param cond
+ * @param lock - held by caller
+ * @param deadline - absolute CLOCK_MONOTONIC time, NULL to wait forever
+ * @return int - 0, ETIMEDOUT
+ */
+int th_byte_cond_wait(th_byte_cond_t *cond, th_byte_lock_t *lock, const struct timespec *deadline);
+
+/**
+ * @brief   th_byte_cond_wait() with a pthread mutex, for conditions guarded by application mutex
+ *
+ * @param cond
+ * @param mutex - held by caller
+ * @param deadline - absolute CLOCK_MONOTONIC time, NULL to wait forever
+ * @return int - 0, ETIMEDOUT
+ */
+int th_byte_cond_wait_mutex(th_byte_cond_t *cond, pthread_mutex_t *mutex, const struct timespec *deadline);
+
+/**
+ * @brief   wakeup one waiter, nothing but a load when nobody waits
+ *
+ * @param cond
+ */
+void th_byte_cond_signal(th_byte_cond_t *cond);
+
+/**
+ * @brief   wakeup all waiters, nothing but a load when nobody waits
+ *
+ * @param cond
+ */
+void th_byte_cond_broadcast(th_byte_cond_t *cond);
+
+#endif /* __PARKING_LOT__ */
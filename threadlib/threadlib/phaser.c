@@ -0,0 +1,242 @@
+/**
+ * @file phaser.c
+ * @author agent
+ * @brief  This file implements tiered phaser over futex wait words
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "phaser.h"
+#include "th_lock_prof.h"
+#include <assert.h>
+
+/* phaser state word fields */
+#define PHASER_UNARRIVED(state)     ((uint32_t)((state) & 0xFFFF))
+#define PHASER_PARTIES(state)       ((uint32_t)(((state) >> 16) & 0xFFFF))
+#define PHASER_PHASE(state)         ((uint32_t)((state) >> 32))
+#define PHASER_STATE(phase, parties, unarrived)                                             \
+    (((uint64_t)(phase) << 32) | ((uint64_t)(parties) << 16) | (uint64_t)(unarrived))
+
+/*********** private helper functions BEGIN **********/
+
+/**
+ * @brief   load phaser state, sub-phaser state is first brought to root phase
+ *
+ * @note    a sub-phaser whose parties all arrived keeps the old phase until root advances,
+ *          the first operation after that starts the new phase with all parties unarrived
+ *
+ * @param phaser
+ * @return uint64_t - state
+ */
+static uint64_t phaser_load_state(phaser_t *phaser)
+{
+    uint64_t state = atomic_load_explicit(&phaser->state, memory_order_acquire);
+    uint64_t next;
+    uint32_t root_phase;
+
+    if(phaser->root == phaser)
+    {
+        return state;
+    }
+
+    while(PHASER_UNARRIVED(state) == 0 &&
+          PHASER_PHASE(state) != (root_phase = PHASER_PHASE(atomic_load_explicit(&phaser->root->state, memory_order_acquire))))
+    {
+        next = PHASER_STATE(root_phase, PHASER_PARTIES(state), PHASER_PARTIES(state));
+        if(atomic_compare_exchange_weak_explicit(&phaser->state, &state, next,
+                    memory_order_acq_rel, memory_order_acquire))
+        {
+            return next;
+        }
+    }
+    return state;
+}
+
+/**
+ * @brief   add parties to current phase
+ *
+ * @param phaser
+ * @param parties
+ * @return uint32_t - phase registered at
+ */
+static uint32_t phaser_do_register(phaser_t *phaser, uint32_t parties)
+{
+    uint64_t state, next;
+    uint32_t phase;
+
+    for(;;)
+    {
+        state = phaser_load_state(phaser);
+        phase = PHASER_PHASE(state);
+
+        if(phaser->root != phaser && PHASER_PARTIES(state) == 0)
+        {
+            /* empty sub-phaser joins its parent first, once */
+            TH_LOCK(&phaser->mutex);
+            if(PHASER_PARTIES(phaser_load_state(phaser)) == 0)
+            {
+                phase = phaser_do_register(phaser->parent, 1);
+                atomic_store_explicit(&phaser->state, PHASER_STATE(phase, parties, parties), memory_order_release);
+                TH_UNLOCK(&phaser->mutex);
+                return phase;
+            }
+            TH_UNLOCK(&phaser->mutex);
+            continue;
+        }
+
+        assert(PHASER_PARTIES(state) + parties <= PHASER_MAX_PARTIES);
+
+        if(phaser->root != phaser && PHASER_UNARRIVED(state) == 0)
+        {
+            /* sub-phaser already reported this phase to its parent, join next phase */
+            phaser_await_advance(phaser, phase);
+            continue;
+        }
+
+        next = PHASER_STATE(phase, PHASER_PARTIES(state) + parties, PHASER_UNARRIVED(state) + parties);
+        if(atomic_compare_exchange_weak_explicit(&phaser->state, &state, next,
+                    memory_order_acq_rel, memory_order_relaxed))
+        {
+            return phase;
+        }
+    }
+}
+
+/**
+ * @brief   arrive at current phase, last arrival advance root phase
+ *          or arrive at parent for a sub-phaser
+ *
+ * @param phaser
+ * @param deregister - leave phaser too
+ * @return uint32_t - phase arrived at
+ */
+static uint32_t phaser_do_arrive(phaser_t *phaser, bool deregister)
+{
+    uint64_t state, next;
+    uint32_t phase, parties, unarrived;
+
+    for(;;)
+    {
+        state = phaser_load_state(phaser);
+        phase = PHASER_PHASE(state);
+
+        /* more arrivals than registered parties */
+        assert(PHASER_UNARRIVED(state) > 0);
+
+        parties = PHASER_PARTIES(state) - (deregister ? 1 : 0);
+        unarrived = PHASER_UNARRIVED(state) - 1;
+
+        if(unarrived > 0 || phaser->root != phaser)
+        {
+            next = PHASER_STATE(phase, parties, unarrived);
+        }
+        else
+        {
+            /* root last arrival, open next phase */
+            next = PHASER_STATE(phase + 1, parties, parties);
+        }
+
+        if(atomic_compare_exchange_weak_explicit(&phaser->state, &state, next,
+                    memory_order_acq_rel, memory_order_relaxed))
+        {
+            break;
+        }
+    }
+
+    if(unarrived == 0)
+    {
+        if(phaser->root == phaser)
+        {
+            /* advances of consecutive phases may publish out of order */
+            th_wait_word_advance(&phaser->phase_word, phase + 1);
+        }
+        else
+        {
+            /* whole sub-phaser arrived, it counts as one arrival of its parent */
+            phaser_do_arrive(phaser->parent, parties == 0);
+        }
+    }
+    return phase;
+}
+
+/*********** private helper functions END ***********/
+
+void phaser_init(phaser_t *phaser, phaser_t *parent, uint32_t parties)
+{
+    phaser_init_lock(phaser, parent, parties, TH_LOCK_PTHREAD);
+}
+
+void phaser_init_lock(phaser_t *phaser, phaser_t *parent, uint32_t parties, th_lock_type_t lock_type)
+{
+    uint32_t phase = 0;
+
+    assert(parties <= PHASER_MAX_PARTIES);
+
+    phaser->parent = parent;
+    phaser->root = parent ? parent->root : phaser;
+    th_lock_init(&phaser->mutex, lock_type);
+    TH_LOCK_PROF_NAME(&phaser->mutex, "phaser_t mutex");
+    th_wait_word_init(&phaser->phase_word, 0);
+    th_spin_budget_init(&phaser->budget);
+
+    if(parent != NULL)
+    {
+        phase = parties ? phaser_do_register(parent, 1) : phaser_get_phase(parent);
+    }
+    atomic_init(&phaser->state, PHASER_STATE(phase, parties, parties));
+}
+
+uint32_t phaser_register(phaser_t *phaser)
+{
+    return phaser_do_register(phaser, 1);
+}
+
+uint32_t phaser_bulk_register(phaser_t *phaser, uint32_t parties)
+{
+    if(parties == 0)
+    {
+        return phaser_get_phase(phaser);
+    }
+    return phaser_do_register(phaser, parties);
+}
+
+uint32_t phaser_arrive(phaser_t *phaser)
+{
+    return phaser_do_arrive(phaser, false);
+}
+
+uint32_t phaser_arrive_and_deregister(phaser_t *phaser)
+{
+    return phaser_do_arrive(phaser, true);
+}
+
+uint32_t phaser_await_advance(phaser_t *phaser, uint32_t phase)
+{
+    th_wait_word_t *phase_word = &phaser->root->phase_word;
+
+    th_wait_word_wait_until(phase_word, phase + 1, &phaser->budget);
+    return atomic_load_explicit(&phase_word->value, memory_order_acquire);
+}
+
+uint32_t phaser_arrive_and_await_advance(phaser_t *phaser)
+{
+    return phaser_await_advance(phaser, phaser_do_arrive(phaser, false));
+}
+
+uint32_t phaser_get_phase(phaser_t *phaser)
+{
+    return PHASER_PHASE(phaser_load_state(phaser));
+}
+
+uint32_t phaser_get_parties(phaser_t *phaser)
+{
+    return PHASER_PARTIES(phaser_load_state(phaser));
+}
+
+void phaser_destroy(phaser_t *phaser)
+{
+    th_lock_destroy(&phaser->mutex);
+}
@@ -0,0 +1,139 @@
+/**
+ * @file phaser.h
+ * @author agent
+ * @brief  This file defines phaser, a reusable barrier whose parties register and
+ *         deregister between phases, phasers can be tiered so arrivals spread over
+ *         several counters instead of one
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __PHASER__
+#define __PHASER__
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include "th_park.h"
+#include "th_lock.h"
+
+/* parties per phaser, tier phasers to go beyond */
+#define PHASER_MAX_PARTIES          0xFFFF
+
+/**
+ * phaser state word: phase (32 bits) | parties (16 bits) | unarrived (16 bits)
+ * a sub-phaser counts as one party of its parent while it has parties,
+ * it arrives at its parent when its own unarrived count reach zero,
+ * root advances the phase, sub-phasers pick up the new phase on their next operation
+ */
+typedef struct phaser_
+{
+    _Atomic uint64_t state;                     /* packed phase, parties and unarrived */
+    struct phaser_ *parent;                     /* NULL for root */
+    struct phaser_ *root;                       /* root of phaser tree, itself for root */
+    th_lock_t mutex;                            /* sub-phaser first registration with parent */
+    th_wait_word_t phase_word;                  /* root only, phase waiters sleep on it */
+    th_spin_budget_t budget;                    /* adaptive spin before sleeping on futex */
+}phaser_t;
+
+/**
+ * @brief initiate phaser
+ *
+ * @param phaser
+ * @param parent - parent phaser, NULL for root
+ * @param parties - initial parties, a sub-phaser with parties registers with its parent
+ */
+void phaser_init(phaser_t *phaser, phaser_t *parent, uint32_t parties);
+
+/**
+ * @brief   initiate phaser with lock type of its registration mutex
+ *
+ * @note    first registration of an empty sub-phaser holds its mutex while registering with
+ *          the parent, so one thread holds a lock per tier, queue lock types allow
+ *          TH_LOCK_MAX_HELD tiers
+ *
+ * @param phaser
+ * @param parent - parent phaser, NULL for root
+ * @param parties - initial parties, a sub-phaser with parties registers with its parent
+ * @param lock_type
+ */
+void phaser_init_lock(phaser_t *phaser, phaser_t *parent, uint32_t parties, th_lock_type_t lock_type);
+
+/**
+ * @brief   add one party for the current phase
+ *
+ * @param phaser
+ * @return uint32_t - phase registered at
+ */
+uint32_t phaser_register(phaser_t *phaser);
+
+/**
+ * @brief   add parties for the current phase
+ *
+ * @param phaser
+ * @param parties
+ * @return uint32_t - phase registered at
+ */
+uint32_t phaser_bulk_register(phaser_t *phaser, uint32_t parties);
+
+/**
+ * @brief   arrive at current phase without waiting (split-phase),
+ *          wait later with phaser_await_advance()
+ *
+ * @param phaser
+ * @return uint32_t - phase arrived at
+ */
+uint32_t phaser_arrive(phaser_t *phaser);
+
+/**
+ * @brief   arrive at current phase and leave the phaser
+ *
+ * @param phaser
+ * @return uint32_t - phase arrived at
+ */
+uint32_t phaser_arrive_and_deregister(phaser_t *phaser);
+
+/**
+ * @brief   block until phaser phase moves past phase, spin then sleep on futex
+ *
+ * @param phaser
+ * @param phase - phase returned by arrive
+ * @return uint32_t - new phase
+ */
+uint32_t phaser_await_advance(phaser_t *phaser, uint32_t phase);
+
+/**
+ * @brief   arrive and wait for all other parties, as barrier wait
+ *
+ * @param phaser
+ * @return uint32_t - new phase
+ */
+uint32_t phaser_arrive_and_await_advance(phaser_t *phaser);
+
+/**
+ * @brief   current phase
+ *
+ * @param phaser
+ * @return uint32_t
+ */
+uint32_t phaser_get_phase(phaser_t *phaser);
+
+/**
+ * @brief   registered parties, a sub-phaser counts as one party of its parent
+ *
+ * @param phaser
+ * @return uint32_t
+ */
+uint32_t phaser_get_parties(phaser_t *phaser);
+
+/**
+ * @brief destroy phaser
+ *
+ * @param phaser
+ */
+void phaser_destroy(phaser_t *phaser);
+
+#endif /* __PHASER__ */
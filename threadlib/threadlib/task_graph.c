@@ -0,0 +1,384 @@
+/**
+ * @file task_graph.c
+ * @author agent
+ * @brief  This file implements task dependency graph (DAG) executor over thread pool
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "task_graph.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/*********** private helper functions BEGIN **********/
+
+static void *task_graph_worker_fn(void *arg);
+
+/**
+ * @brief   node mean run time over all graph runs
+ *
+ * @param node
+ * @return uint64_t
+ */
+static uint64_t task_graph_node_mean_ns(task_graph_node_t *node)
+{
+    return node->run_count ? node->total_run_ns / node->run_count : 0;
+}
+
+/**
+ * @brief   hand ready node to thread pool, or keep it in caller local ready list
+ *
+ * @param node
+ * @param ready_list - caller local ready list head
+ */
+static void task_graph_node_schedule(task_graph_node_t *node, task_graph_node_t **ready_list)
+{
+    if(!thread_pool_dispatch_thread(node->graph->th_pool, task_graph_worker_fn, node, false))
+    {
+        /* no idle thread, caller runs it */
+        node->ready_next = *ready_list;
+        *ready_list = node;
+    }
+}
+
+/**
+ * @brief   run node, then release its successors
+ *
+ * @param node
+ * @param ready_list - caller local ready list head, ready successors not dispatched are pushed here
+ */
+static void task_graph_node_run(task_graph_node_t *node, task_graph_node_t **ready_list)
+{
+    task_graph_t *graph = node->graph;
+    task_graph_node_t *successor;
+    bool keep_one = true;
+    uint64_t start_ns = th_now_ns();
+
+    node->task_fn(node->arg);
+
+    node->last_run_ns = th_now_ns() - start_ns;
+    node->total_run_ns += node->last_run_ns;
+    node->run_count++;
+
+    for(uint32_t i = 0; i < node->successor_count; i++)
+    {
+        successor = node->successors[i];
+
+        /* last predecessor to complete make successor ready */
+        if(atomic_fetch_sub_explicit(&successor->pending_count, 1, memory_order_acq_rel) != 1)
+        {
+            continue;
+        }
+
+        if(keep_one)
+        {
+            /* continue on this worker with the first ready successor, no handoff */
+            successor->ready_next = *ready_list;
+            *ready_list = successor;
+            keep_one = false;
+        }
+        else
+        {
+            task_graph_node_schedule(successor, ready_list);
+        }
+    }
+
+    /* last node of the run wakeup task_graph_run() */
+    if(atomic_fetch_sub_explicit(&graph->remaining_count, 1, memory_order_acq_rel) == 1)
+    {
+        TH_MUTEX_LOCK(&graph->mutex);
+        graph->running = false;
+        pthread_cond_signal(&graph->cv);
+        TH_MUTEX_UNLOCK(&graph->mutex);
+    }
+}
+
+/**
+ * @brief   drain local ready list
+ *
+ * @param ready_list
+ */
+static void task_graph_run_ready_list(task_graph_node_t *ready_list)
+{
+    task_graph_node_t *node;
+
+    while(ready_list != NULL)
+    {
+        node = ready_list;
+        ready_list = node->ready_next;
+        task_graph_node_run(node, &ready_list);
+    }
+}
+
+/**
+ * @brief   thread pool work function, run dispatched node and everything it keeps local
+ *
+ * @param arg - task_graph_node_t - pointer
+ * @return void*
+ */
+static void *task_graph_worker_fn(void *arg)
+{
+    task_graph_node_t *node = (task_graph_node_t *) arg;
+
+    node->ready_next = NULL;
+    task_graph_run_ready_list(node);
+    return NULL;
+}
+
+/**
+ * @brief   check if target can be reached from node following successor edges (build phase)
+ *
+ * @param node
+ * @param target
+ * @return true - path node -> ... -> target exists
+ */
+static bool task_graph_node_reaches(task_graph_node_t *node, task_graph_node_t *target)
+{
+    task_graph_t *graph = node->graph;
+    task_graph_node_t **stack = malloc(graph->node_count * sizeof(task_graph_node_t *));
+    bool *visited = calloc(graph->node_count, sizeof(bool));
+    task_graph_node_t *successor;
+    uint32_t depth = 0;
+    bool found = false;
+
+    /* iterative depth first search, each node pushed at most once */
+    stack[depth++] = node;
+    visited[node->index] = true;
+    while(depth != 0 && !found)
+    {
+        node = stack[--depth];
+        for(uint32_t i = 0; i < node->successor_count; i++)
+        {
+            successor = node->successors[i];
+            if(successor == target)
+            {
+                found = true;
+                break;
+            }
+            if(!visited[successor->index])
+            {
+                visited[successor->index] = true;
+                stack[depth++] = successor;
+            }
+        }
+    }
+
+    free(stack);
+    free(visited);
+    return found;
+}
+
+/*********** private helper functions END ***********/
+
+void task_graph_init(task_graph_t *graph, thread_pool_t *th_pool)
+{
+    graph->nodes = NULL;
+    graph->node_count = 0;
+    graph->node_capacity = 0;
+    graph->th_pool = th_pool;
+    atomic_init(&graph->remaining_count, 0);
+    graph->last_run_ns = 0;
+    graph->run_count = 0;
+    graph->running = false;
+    pthread_mutex_init(&graph->mutex, NULL);
+    TH_LOCK_PROF_NAME(&graph->mutex, "task_graph_t mutex");
+    pthread_cond_init(&graph->cv, NULL);
+}
+
+task_graph_node_t *task_graph_add_node(task_graph_t *graph, char *name,
+        void *(*task_fn)(void *), void *arg)
+{
+    task_graph_node_t *node = calloc(1, sizeof(task_graph_node_t));
+
+    assert(!graph->running);
+
+    strncpy(node->name, name, sizeof(node->name) - 1);
+    node->task_fn = task_fn;
+    node->arg = arg;
+    node->graph = graph;
+    atomic_init(&node->pending_count, 0);
+
+    if(graph->node_count == graph->node_capacity)
+    {
+        graph->node_capacity = graph->node_capacity ? graph->node_capacity * 2 : 8;
+        graph->nodes = realloc(graph->nodes, graph->node_capacity * sizeof(task_graph_node_t *));
+    }
+    node->index = graph->node_count;
+    graph->nodes[graph->node_count++] = node;
+    return node;
+}
+
+bool task_graph_node_depends_on(task_graph_node_t *node, task_graph_node_t *predecessor)
+{
+    assert(node->graph == predecessor->graph);
+    assert(!node->graph->running);
+
+    /* edge predecessor -> node closes a cycle if node already leads to predecessor,
+       the cycle nodes would never get ready and task_graph_run() would never return */
+    if(node == predecessor || task_graph_node_reaches(node, predecessor))
+    {
+        return false;
+    }
+
+    if(predecessor->successor_count == predecessor->successor_capacity)
+    {
+        predecessor->successor_capacity = predecessor->successor_capacity ? predecessor->successor_capacity * 2 : 4;
+        predecessor->successors = realloc(predecessor->successors,
+                predecessor->successor_capacity * sizeof(task_graph_node_t *));
+    }
+    predecessor->successors[predecessor->successor_count++] = node;
+    node->predecessor_count++;
+    return true;
+}
+
+void task_graph_run(task_graph_t *graph)
+{
+    task_graph_node_t *ready_list = NULL;
+    task_graph_node_t *node;
+    uint64_t start_ns;
+
+    if(graph->node_count == 0)
+    {
+        return;
+    }
+
+    TH_MUTEX_LOCK(&graph->mutex);
+    assert(!graph->running);
+    graph->running = true;
+    TH_MUTEX_UNLOCK(&graph->mutex);
+
+    /* reset run state, all of it must be visible before first node is dispatched */
+    for(uint32_t i = 0; i < graph->node_count; i++)
+    {
+        node = graph->nodes[i];
+        atomic_store_explicit(&node->pending_count, node->predecessor_count, memory_order_relaxed);
+    }
+    atomic_store_explicit(&graph->remaining_count, graph->node_count, memory_order_release);
+
+    start_ns = th_now_ns();
+
+    /* release root nodes */
+    for(uint32_t i = 0; i < graph->node_count; i++)
+    {
+        node = graph->nodes[i];
+        if(node->predecessor_count == 0)
+        {
+            task_graph_node_schedule(node, &ready_list);
+        }
+    }
+
+    /* caller helps with roots the pool could not take */
+    task_graph_run_ready_list(ready_list);
+
+    TH_MUTEX_LOCK(&graph->mutex);
+    while(graph->running)
+    {
+        TH_COND_WAIT(&graph->cv, &graph->mutex);
+    }
+    TH_MUTEX_UNLOCK(&graph->mutex);
+
+    graph->last_run_ns = th_now_ns() - start_ns;
+    graph->run_count++;
+}
+
+uint64_t task_graph_critical_path_report(task_graph_t *graph, FILE *fptr)
+{
+    task_graph_node_t **order = calloc(graph->node_count + 1, sizeof(task_graph_node_t *));
+    uint32_t *in_degree = calloc(graph->node_count + 1, sizeof(uint32_t));
+    task_graph_node_t *node, *successor, *end = NULL, *bottleneck = NULL;
+    uint32_t head = 0, tail = 0;
+    uint64_t mean_ns, total_ns = 0;
+
+    /* longest path over topological order (Kahn), in_degree indexed by node index */
+    for(uint32_t i = 0; i < graph->node_count; i++)
+    {
+        node = graph->nodes[i];
+        node->path_ns = 0;
+        node->path_prev = NULL;
+        in_degree[i] = node->predecessor_count;
+        if(node->predecessor_count == 0)
+        {
+            order[tail++] = node;
+        }
+    }
+
+    while(head < tail)
+    {
+        node = order[head++];
+        mean_ns = task_graph_node_mean_ns(node);
+        node->path_ns += mean_ns;
+        total_ns += mean_ns;
+        if(end == NULL || node->path_ns > end->path_ns)
+        {
+            end = node;
+        }
+
+        for(uint32_t i = 0; i < node->successor_count; i++)
+        {
+            successor = node->successors[i];
+            if(successor->path_prev == NULL || node->path_ns > successor->path_ns)
+            {
+                successor->path_ns = node->path_ns;
+                successor->path_prev = node;
+            }
+
+            if(--in_degree[successor->index] == 0)
+            {
+                order[tail++] = successor;
+            }
+        }
+    }
+
+    fprintf(fptr, "task graph: %u nodes, %lu runs, last run %lu ns, sum of node times %lu ns\n",
+            graph->node_count, (unsigned long)graph->run_count,
+            (unsigned long)graph->last_run_ns, (unsigned long)total_ns);
+
+    /* task_graph_node_depends_on() refuses edges closing a cycle, every node is ordered */
+    assert(tail == graph->node_count);
+
+    if(end == NULL)
+    {
+        free(order);
+        free(in_degree);
+        return 0;
+    }
+
+    fprintf(fptr, "critical path %lu ns (end node first):\n", (unsigned long)end->path_ns);
+    for(node = end; node != NULL; node = node->path_prev)
+    {
+        mean_ns = task_graph_node_mean_ns(node);
+        if(bottleneck == NULL || mean_ns > task_graph_node_mean_ns(bottleneck))
+        {
+            bottleneck = node;
+        }
+        fprintf(fptr, "  %-32s mean %lu ns (%.1f%%)\n", node->name, (unsigned long)mean_ns,
+                end->path_ns ? 100.0 * (double)mean_ns / (double)end->path_ns : 0.0);
+    }
+    fprintf(fptr, "slowest stage on critical path: %s\n", bottleneck->name);
+
+    total_ns = end->path_ns;
+    free(order);
+    free(in_degree);
+    return total_ns;
+}
+
+void task_graph_destroy(task_graph_t *graph)
+{
+    assert(!graph->running);
+
+    for(uint32_t i = 0; i < graph->node_count; i++)
+    {
+        free(graph->nodes[i]->successors);
+        free(graph->nodes[i]);
+    }
+    free(graph->nodes);
+    graph->nodes = NULL;
+    graph->node_count = 0;
+    graph->node_capacity = 0;
+    pthread_mutex_destroy(&graph->mutex);
+    pthread_cond_destroy(&graph->cv);
+}
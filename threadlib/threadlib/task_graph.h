@@ -0,0 +1,131 @@
+/**
+ * @file task_graph.h
+ * @author agent
+ * @brief  This file defines task dependency graph (DAG) executor over thread pool.
+ *         graph is built once, then run many times without memory allocation
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __TASK_GRAPH__
+#define __TASK_GRAPH__
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "threadlib.h"
+
+struct task_graph_;
+
+typedef struct task_graph_node_
+{
+    char name[32];                              /* node name, used in reports */
+    void *(*task_fn)(void *);                   /* node work function */
+    void *arg;                                  /* node work args */
+    struct task_graph_ *graph;                  /* owner graph */
+    uint32_t index;                             /* position in graph nodes array */
+
+    /* graph edges, built once */
+    struct task_graph_node_ **successors;       /* nodes depending on this node */
+    uint32_t successor_count;
+    uint32_t successor_capacity;
+    uint32_t predecessor_count;                 /* number of nodes this node depends on */
+
+    /* run state */
+    _Atomic uint32_t pending_count;             /* predecessors not completed yet in current run */
+    struct task_graph_node_ *ready_next;        /* worker local ready list link */
+
+    /* statistics, written by the worker running the node */
+    uint64_t last_run_ns;                       /* run time in last graph run */
+    uint64_t total_run_ns;                      /* run time summed over all runs */
+    uint64_t run_count;                         /* number of runs */
+
+    /* critical path computation */
+    uint64_t path_ns;                           /* longest path ending at this node */
+    struct task_graph_node_ *path_prev;         /* predecessor on that path */
+}task_graph_node_t;
+
+typedef struct task_graph_
+{
+    task_graph_node_t **nodes;                  /* all nodes, in insertion order */
+    uint32_t node_count;
+    uint32_t node_capacity;
+    thread_pool_t *th_pool;                     /* ready nodes run here */
+    _Atomic uint32_t remaining_count;           /* nodes not completed yet in current run */
+    uint64_t last_run_ns;                       /* wall time of last graph run */
+    uint64_t run_count;                         /* number of graph runs */
+    bool running;
+    pthread_mutex_t mutex;
+    pthread_cond_t cv;                          /* task_graph_run waits for last node */
+}task_graph_t;
+
+/**
+ * @brief initiate empty task graph
+ *
+ * @param graph
+ * @param th_pool - thread pool running ready nodes
+ */
+void task_graph_init(task_graph_t *graph, thread_pool_t *th_pool);
+
+/**
+ * @brief add node to graph (build phase)
+ *
+ * @param graph
+ * @param name
+ * @param task_fn
+ * @param arg
+ * @return task_graph_node_t* - node owned by graph
+ */
+task_graph_node_t *task_graph_add_node(task_graph_t *graph, char *name,
+        void *(*task_fn)(void *), void *arg);
+
+/**
+ * @brief declare that node can only start after predecessor completed (build phase)
+ *
+ * @note  the dependency is rejected when it would close a cycle, so every added
+ *        graph stays acyclic and task_graph_run() always completes
+ *
+ * @param node
+ * @param predecessor
+ * @return true  - dependency added
+ *         false - node is predecessor or predecessor already depends on node, not added
+ */
+bool task_graph_node_depends_on(task_graph_node_t *node, task_graph_node_t *predecessor);
+
+/**
+ * @brief   run all graph nodes respecting dependencies, block caller until last node completes
+ *
+ * @note    a node becomes ready when its pending count reach zero, ready nodes are dispatched
+ *          to the thread pool, a worker finishing a node keeps running one ready successor itself,
+ *          nodes the pool has no idle thread for run on the current worker (or caller).
+ *          no memory is allocated, graph can be run again once this call returns
+ *
+ * @param graph
+ */
+void task_graph_run(task_graph_t *graph);
+
+/**
+ * @brief   compute critical path from node mean run times and print report
+ *
+ * @note    critical path is the dependency chain with the longest total run time,
+ *          it bounds graph run time no matter how many workers are used
+ *
+ * @param graph
+ * @param fptr - output stream, e.g. stdout
+ * @return uint64_t - critical path length in nano seconds
+ */
+uint64_t task_graph_critical_path_report(task_graph_t *graph, FILE *fptr);
+
+/**
+ * @brief   free graph nodes and edges
+ *
+ * @param graph
+ */
+void task_graph_destroy(task_graph_t *graph);
+
+#endif /* __TASK_GRAPH__ */
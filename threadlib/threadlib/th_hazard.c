@@ -0,0 +1,181 @@
+/**
+ * @file th_hazard.c
+ * @author agent
+ * @brief  This file implements hazard pointer domain, records and amortized retire list scans
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "th_hazard.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*********** private helper functions BEGIN **********/
+
+/**
+ * @brief   qsort / bsearch compare of hazard pointers
+ *
+ * @param a
+ * @param b
+ * @return int
+ */
+static int th_hp_ptr_cmp(const void *a, const void *b)
+{
+    uintptr_t x = (uintptr_t)*(void * const *)a;
+    uintptr_t y = (uintptr_t)*(void * const *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * @brief   retired nodes that trigger next scan of record
+ *
+ * @param record
+ * @return uint32_t
+ */
+static inline uint32_t th_hp_scan_at(th_hp_record_t *record)
+{
+    th_hp_domain_t *domain = record->domain;
+
+    return domain->scan_threshold + atomic_load_explicit(&domain->record_count, memory_order_relaxed) * TH_HP_SLOTS;
+}
+
+/*********** private helper functions END ***********/
+
+void th_hp_domain_init(th_hp_domain_t *domain, uint32_t scan_threshold)
+{
+    atomic_init(&domain->records, NULL);
+    atomic_init(&domain->record_count, 0);
+    domain->scan_threshold = scan_threshold ? scan_threshold : TH_HP_SCAN_THRESHOLD;
+}
+
+void th_hp_domain_destroy(th_hp_domain_t *domain)
+{
+    th_hp_record_t *record, *next_record;
+    th_hp_head_t *head, *next;
+
+    for(record = atomic_load(&domain->records); record != NULL; record = next_record)
+    {
+        next_record = record->next;
+        for(head = record->retired; head != NULL; head = next)
+        {
+            next = head->next;
+            head->func(head);
+        }
+        free(record);
+    }
+    atomic_store(&domain->records, NULL);
+    atomic_store(&domain->record_count, 0);
+}
+
+th_hp_record_t *th_hp_acquire(th_hp_domain_t *domain)
+{
+    th_hp_record_t *record;
+    bool expected;
+
+    for(record = atomic_load(&domain->records); record != NULL; record = record->next)
+    {
+        expected = false;
+        if(!atomic_load_explicit(&record->active, memory_order_relaxed) &&
+           atomic_compare_exchange_strong(&record->active, &expected, true))
+        {
+            return record;
+        }
+    }
+
+    record = aligned_alloc(TH_CACHE_LINE_SIZE, sizeof(th_hp_record_t));
+    memset(record, 0, sizeof(th_hp_record_t));
+    for(uint32_t i = 0; i < TH_HP_SLOTS; i++)
+    {
+        atomic_init(&record->hazard[i], NULL);
+    }
+    atomic_init(&record->active, true);
+    record->domain = domain;
+    record->retired = NULL;
+    record->retired_count = 0;
+
+    /* counted before published, a scan never sees more records than it counted */
+    atomic_fetch_add(&domain->record_count, 1);
+    record->next = atomic_load(&domain->records);
+    while(!atomic_compare_exchange_weak(&domain->records, &record->next, record));
+    return record;
+}
+
+void th_hp_release(th_hp_record_t *record)
+{
+    for(uint32_t i = 0; i < TH_HP_SLOTS; i++)
+    {
+        th_hp_clear(record, i);
+    }
+    if(record->retired_count != 0)
+    {
+        th_hp_scan(record);
+    }
+    atomic_store_explicit(&record->active, false, memory_order_release);
+}
+
+void th_hp_retire(th_hp_record_t *record, void *node, th_hp_head_t *head, void (*func)(th_hp_head_t *head))
+{
+    head->node = node;
+    head->func = func;
+    head->next = record->retired;
+    record->retired = head;
+
+    /* amortized, threshold above hazard count so each scan frees scan_threshold nodes at least */
+    if(++record->retired_count >= th_hp_scan_at(record))
+    {
+        th_hp_scan(record);
+    }
+}
+
+uint32_t th_hp_scan(th_hp_record_t *record)
+{
+    th_hp_domain_t *domain = record->domain;
+    th_hp_record_t *curr;
+    th_hp_head_t *head, *next, *kept = NULL;
+    void **hazards;
+    void *ptr;
+    uint32_t capacity, count = 0, kept_count = 0, freed = 0;
+
+    /* nodes were unlinked before retire, hazards are loaded after */
+    atomic_thread_fence(memory_order_seq_cst);
+
+    curr = atomic_load(&domain->records);
+    capacity = atomic_load(&domain->record_count) * TH_HP_SLOTS;
+    hazards = malloc(sizeof(void *) * (capacity ? capacity : 1));
+
+    for(; curr != NULL && count < capacity; curr = curr->next)
+    {
+        for(uint32_t i = 0; i < TH_HP_SLOTS; i++)
+        {
+            if((ptr = atomic_load(&curr->hazard[i])) != NULL)
+            {
+                hazards[count++] = ptr;
+            }
+        }
+    }
+    qsort(hazards, count, sizeof(void *), th_hp_ptr_cmp);
+
+    for(head = record->retired; head != NULL; head = next)
+    {
+        next = head->next;
+        ptr = head->node;
+        if(count != 0 && bsearch(&ptr, hazards, count, sizeof(void *), th_hp_ptr_cmp) != NULL)
+        {
+            head->next = kept;
+            kept = head;
+            kept_count++;
+            continue;
+        }
+        head->func(head);
+        freed++;
+    }
+
+    record->retired = kept;
+    record->retired_count = kept_count;
+    free(hazards);
+    return freed;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file th_hazard.h
+ * @author agent
+ * @brief  This file defines hazard pointers, safe memory reclamation for lock-free structures:
+ *         a thread publishes the node it is about to dereference in one of its hazard slots,
+ *         removed nodes are retired and freed only once no slot holds them.
+ *         unlike grace periods (th_rcu.h), a preempted reader holds back only the few nodes
+ *         it protects, not every node retired after it
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __TH_HAZARD__
+#define __TH_HAZARD__
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "th_telemetry.h"
+
+/* hazard slots per thread record */
+#define TH_HP_SLOTS                 4
+/* retired nodes per thread that trigger a scan, on top of the hazard slots in use */
+#define TH_HP_SCAN_THRESHOLD        64
+
+/**
+ * @brief   retired node link, embedded in the node to reclaim
+ *
+ */
+typedef struct th_hp_head_
+{
+    struct th_hp_head_ *next;
+    void *node;                                 /* node address, as published in hazard slots */
+    void (*func)(struct th_hp_head_ *head);     /* called once no hazard slot holds the node, usually frees it */
+}th_hp_head_t;
+
+struct th_hp_domain_;
+
+/**
+ * @brief   per thread hazard record, owned by one thread between th_hp_acquire() and th_hp_release(),
+ *          records are never freed before domain, released ones are reused
+ *
+ */
+typedef struct th_hp_record_
+{
+    /* read by every scan, written by owner only */
+    _Alignas(TH_CACHE_LINE_SIZE) void *_Atomic hazard[TH_HP_SLOTS];
+
+    _Alignas(TH_CACHE_LINE_SIZE) struct th_hp_record_ *next;   /* next record in domain, immutable once published */
+    _Atomic bool active;
+    struct th_hp_domain_ *domain;
+    th_hp_head_t *retired;                      /* nodes retired by owner, not yet freed */
+    uint32_t retired_count;
+}th_hp_record_t;
+
+typedef struct th_hp_domain_
+{
+    _Atomic(th_hp_record_t *) records;          /* push only list */
+    _Atomic uint32_t record_count;
+    uint32_t scan_threshold;
+}th_hp_domain_t;
+
+/**
+ * @brief   initiate hazard pointer domain
+ *
+ * @note    a thread scans once it retired scan_threshold nodes more than the hazard slots of
+ *          the domain, so every scan frees at least scan_threshold nodes and costs O(1) per node.
+ *          larger threshold, fewer scans and more memory held
+ *
+ * @param domain
+ * @param scan_threshold - 0 for TH_HP_SCAN_THRESHOLD
+ */
+void th_hp_domain_init(th_hp_domain_t *domain, uint32_t scan_threshold);
+
+/**
+ * @brief   free every retired node and all records, no thread may use domain anymore
+ *
+ * @param domain
+ */
+void th_hp_domain_destroy(th_hp_domain_t *domain);
+
+/**
+ * @brief   take a hazard record for calling thread, reuse a released one if any
+ *
+ * @param domain
+ * @return th_hp_record_t*
+ */
+th_hp_record_t *th_hp_acquire(th_hp_domain_t *domain);
+
+/**
+ * @brief   clear hazards, scan retired nodes and give record back to domain,
+ *          nodes still protected stay on record for its next owner
+ *
+ * @param record
+ */
+void th_hp_release(th_hp_record_t *record);
+
+/**
+ * @brief   retire node removed from its structure, func runs once no hazard slot holds it
+ *
+ * @param record
+ * @param node - removed node, must be unreachable for new readers
+ * @param head - embedded in node
+ * @param func
+ */
+void th_hp_retire(th_hp_record_t *record, void *node, th_hp_head_t *head, void (*func)(th_hp_head_t *head));
+
+/**
+ * @brief   free retired nodes of record no hazard slot holds, th_hp_retire() calls it past threshold
+ *
+ * @param record
+ * @return uint32_t - nodes freed
+ */
+uint32_t th_hp_scan(th_hp_record_t *record);
+
+/**
+ * @brief   load pointer from src and publish it in hazard slot, once it returns the node
+ *          can be dereferenced until slot is cleared or reused
+ *
+ * @note    store then reload, both sequentially consistent, pairs with the scan loading
+ *          hazard slots after the node was unlinked: either scan sees the hazard, or
+ *          the reload sees src changed and publishes again
+ *
+ * @param record
+ * @param slot - 0 .. TH_HP_SLOTS - 1
+ * @param src - shared pointer, cast as (void *_Atomic *)
+ * @return void* - protected pointer, may be NULL
+ */
+static inline void *th_hp_protect(th_hp_record_t *record, uint32_t slot, void *_Atomic *src)
+{
+    void *ptr = atomic_load(src);
+    void *again;
+
+    for(;;)
+    {
+        atomic_store(&record->hazard[slot], ptr);
+        again = atomic_load(src);
+        if(again == ptr)
+        {
+            return ptr;
+        }
+        ptr = again;
+    }
+}
+
+/**
+ * @brief   publish pointer already known to be safe (e.g. protected in another slot)
+ *
+ * @param record
+ * @param slot
+ * @param ptr
+ */
+static inline void th_hp_set(th_hp_record_t *record, uint32_t slot, void *ptr)
+{
+    atomic_store(&record->hazard[slot], ptr);
+}
+
+/**
+ * @brief   drop protection of slot
+ *
+ * @param record
+ * @param slot
+ */
+static inline void th_hp_clear(th_hp_record_t *record, uint32_t slot)
+{
+    atomic_store_explicit(&record->hazard[slot], NULL, memory_order_release);
+}
+
+#endif /* __TH_HAZARD__ */
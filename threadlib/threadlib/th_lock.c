@@ -0,0 +1,399 @@
+/**
+ * @file th_lock.c
+ * @author agent
+ * @brief  This file implements MCS and CLH queue locks, adaptive mutex and selectable lock
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "th_lock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <assert.h>
+
+/* th_lock_t queue nodes of calling thread, bit i of used mask set while node i is queued */
+static __thread th_mcs_node_t th_lock_mcs_nodes[TH_LOCK_MAX_HELD];
+static __thread uint32_t th_lock_mcs_used = 0;
+static __thread th_clh_node_t *th_lock_clh_nodes[TH_LOCK_MAX_HELD];
+static __thread uint32_t th_lock_clh_used = 0;
+
+/* frees CLH nodes of exiting threads */
+static pthread_key_t th_lock_clh_key;
+static pthread_once_t th_lock_clh_once = PTHREAD_ONCE_INIT;
+
+static const char *th_lock_type_names[TH_LOCK_TYPES] =
+{
+    "pthread_mutex",
+    "byte_lock",
+    "adaptive",
+    "mcs",
+    "clh",
+};
+
+/*********** private helper functions BEGIN **********/
+
+/**
+ * @brief   adaptive mutex contended path, spin while budget lasts then sleep
+ *
+ * @param mutex
+ */
+static void th_adaptive_mutex_lock_slow(th_adaptive_mutex_t *mutex)
+{
+    uint32_t expected;
+    uint64_t start_ns = th_now_ns();
+
+    /* spin only while holder runs, every round lost to another locker spins again */
+    for(uint32_t i = 0; i < TH_LOCK_ADAPTIVE_RETRIES; i++)
+    {
+        if(!th_spin_wait_while_equal(&mutex->locked, 1, &mutex->budget))
+        {
+            break;
+        }
+        expected = 0;
+        if(atomic_compare_exchange_strong(&mutex->locked, &expected, 1))
+        {
+            th_spin_budget_update(&mutex->budget, th_now_ns() - start_ns);
+            return;
+        }
+    }
+
+    /* counted before compare exchange, unlock stores 0 then reads count, so one of them sees the other */
+    atomic_fetch_add(&mutex->sleepers, 1);
+    for(;;)
+    {
+        expected = 0;
+        if(atomic_compare_exchange_strong(&mutex->locked, &expected, 1))
+        {
+            break;
+        }
+        th_futex_wait(&mutex->locked, 1);
+    }
+    atomic_fetch_sub_explicit(&mutex->sleepers, 1, memory_order_relaxed);
+    th_spin_budget_update(&mutex->budget, th_now_ns() - start_ns);
+}
+
+/**
+ * @brief   wait a moment, successor was between joining the queue and linking in
+ *
+ * @param spins
+ */
+static inline void th_lock_link_wait(uint32_t *spins)
+{
+    if(++(*spins) < TH_LOCK_LINK_SPIN_COUNT)
+    {
+        TH_CPU_RELAX();
+    }
+    else
+    {
+        sched_yield();
+    }
+}
+
+/**
+ * @brief   thread exit destructor, free CLH nodes of exiting thread
+ *
+ * @note    every node in th_lock_clh_nodes is owned by this thread alone
+ *
+ * @param arg
+ */
+static void th_lock_clh_free_nodes(void *arg)
+{
+    (void) arg;
+    for(uint32_t i = 0; i < TH_LOCK_MAX_HELD; i++)
+    {
+        free(th_lock_clh_nodes[i]);
+        th_lock_clh_nodes[i] = NULL;
+    }
+}
+
+static void th_lock_clh_key_create(void)
+{
+    pthread_key_create(&th_lock_clh_key, th_lock_clh_free_nodes);
+}
+
+/**
+ * @brief   free queue node slot of calling thread
+ *
+ * @param used - used mask
+ * @return uint32_t - slot index
+ */
+static inline uint32_t th_lock_node_slot(uint32_t *used)
+{
+    uint32_t slot = (uint32_t)__builtin_ctz(~(*used));
+
+    /* no node left, a queue lock can not be taken without one, release builds too */
+    if(slot >= TH_LOCK_MAX_HELD)
+    {
+        fprintf(stderr, "th_lock: more than %u queue locks held by one thread\n", TH_LOCK_MAX_HELD);
+        abort();
+    }
+    *used |= 1u << slot;
+    return slot;
+}
+
+/**
+ * @brief   CLH node for slot of calling thread, allocated on first use
+ *
+ * @param slot
+ * @return th_clh_node_t*
+ */
+static th_clh_node_t *th_lock_clh_node(uint32_t slot)
+{
+    if(th_lock_clh_nodes[slot] == NULL)
+    {
+        pthread_once(&th_lock_clh_once, th_lock_clh_key_create);
+        /* any non NULL value, so destructor runs at thread exit */
+        pthread_setspecific(th_lock_clh_key, th_lock_clh_nodes);
+        th_lock_clh_nodes[slot] = th_clh_node_create();
+    }
+    return th_lock_clh_nodes[slot];
+}
+
+/*********** private helper functions END ***********/
+
+void th_adaptive_mutex_init(th_adaptive_mutex_t *mutex)
+{
+    atomic_init(&mutex->locked, 0);
+    atomic_init(&mutex->sleepers, 0);
+    th_spin_budget_init(&mutex->budget);
+}
+
+bool th_adaptive_mutex_lock(th_adaptive_mutex_t *mutex)
+{
+    uint32_t expected = 0;
+
+    if(atomic_compare_exchange_strong(&mutex->locked, &expected, 1))
+    {
+        return false;
+    }
+    th_adaptive_mutex_lock_slow(mutex);
+    return true;
+}
+
+void th_adaptive_mutex_unlock(th_adaptive_mutex_t *mutex)
+{
+    atomic_store(&mutex->locked, 0);
+    if(atomic_load(&mutex->sleepers) != 0)
+    {
+        th_futex_wake(&mutex->locked, 1);
+    }
+}
+
+void th_mcs_lock_init(th_mcs_lock_t *lock)
+{
+    atomic_init(&lock->tail, NULL);
+    th_spin_budget_init(&lock->budget);
+}
+
+bool th_mcs_lock_lock(th_mcs_lock_t *lock, th_mcs_node_t *node)
+{
+    th_mcs_node_t *pred;
+
+    atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+    th_wait_word_init(&node->granted, 0);
+
+    pred = atomic_exchange(&lock->tail, node);
+    if(pred == NULL)
+    {
+        return false;
+    }
+
+    /* link behind predecessor, then wait on own node only */
+    atomic_store_explicit(&pred->next, node, memory_order_release);
+    th_wait_word_wait_until(&node->granted, 1, &lock->budget);
+    return true;
+}
+
+void th_mcs_lock_unlock(th_mcs_lock_t *lock, th_mcs_node_t *node)
+{
+    th_mcs_node_t *next = atomic_load_explicit(&node->next, memory_order_acquire);
+    th_mcs_node_t *expected;
+    uint32_t spins = 0;
+
+    if(next == NULL)
+    {
+        /* no waiter, lock is free again */
+        expected = node;
+        if(atomic_compare_exchange_strong(&lock->tail, &expected, NULL))
+        {
+            return;
+        }
+        /* a waiter swapped the tail, wait for it to link in */
+        while((next = atomic_load_explicit(&node->next, memory_order_acquire)) == NULL)
+        {
+            th_lock_link_wait(&spins);
+        }
+    }
+
+    /* one store on successor line, futex wake only if it sleeps */
+    th_wait_word_store(&next->granted, 1);
+}
+
+th_clh_node_t *th_clh_node_create(void)
+{
+    th_clh_node_t *node = aligned_alloc(TH_CACHE_LINE_SIZE, sizeof(th_clh_node_t));
+
+    th_wait_word_init(&node->released, 1);
+    node->pred = NULL;
+    return node;
+}
+
+void th_clh_lock_init(th_clh_lock_t *lock)
+{
+    atomic_init(&lock->tail, th_clh_node_create());
+    th_spin_budget_init(&lock->budget);
+}
+
+void th_clh_lock_destroy(th_clh_lock_t *lock)
+{
+    th_clh_node_t *tail = atomic_load(&lock->tail);
+
+    assert(atomic_load(&tail->released.value) == 1);
+    free(tail);
+    atomic_store(&lock->tail, NULL);
+}
+
+bool th_clh_lock_lock(th_clh_lock_t *lock, th_clh_node_t *node)
+{
+    atomic_store_explicit(&node->released.value, 0, memory_order_relaxed);
+    node->pred = atomic_exchange(&lock->tail, node);
+    if(atomic_load_explicit(&node->pred->released.value, memory_order_acquire) == 1)
+    {
+        return false;
+    }
+    th_wait_word_wait_until(&node->pred->released, 1, &lock->budget);
+    return true;
+}
+
+void th_clh_lock_unlock(th_clh_lock_t *lock, th_clh_node_t **node)
+{
+    th_clh_node_t *pred = (*node)->pred;
+
+    (void) lock;
+    /* predecessor node is no longer watched by anyone, it becomes ours */
+    th_wait_word_store(&(*node)->released, 1);
+    *node = pred;
+}
+
+void th_lock_init(th_lock_t *lock, th_lock_type_t type)
+{
+    lock->type = type;
+    lock->holder_node = NULL;
+    switch(type)
+    {
+        case TH_LOCK_PTHREAD:
+            pthread_mutex_init(&lock->mutex, NULL);
+            break;
+        case TH_LOCK_BYTE:
+            th_byte_lock_init(&lock->byte_lock);
+            break;
+        case TH_LOCK_ADAPTIVE:
+            th_adaptive_mutex_init(&lock->adaptive);
+            break;
+        case TH_LOCK_MCS:
+            th_mcs_lock_init(&lock->mcs);
+            break;
+        case TH_LOCK_CLH:
+            th_clh_lock_init(&lock->clh);
+            break;
+        default:
+            assert(0);
+    }
+}
+
+void th_lock_destroy(th_lock_t *lock)
+{
+    if(lock->type == TH_LOCK_PTHREAD)
+    {
+        pthread_mutex_destroy(&lock->mutex);
+    }
+    else if(lock->type == TH_LOCK_CLH)
+    {
+        th_clh_lock_destroy(&lock->clh);
+    }
+}
+
+bool th_lock_lock(th_lock_t *lock)
+{
+    th_mcs_node_t *mcs_node;
+    th_clh_node_t *clh_node;
+    bool contended = false;
+
+    switch(lock->type)
+    {
+        case TH_LOCK_PTHREAD:
+            if(pthread_mutex_trylock(&lock->mutex) != 0)
+            {
+                pthread_mutex_lock(&lock->mutex);
+                contended = true;
+            }
+            break;
+        case TH_LOCK_BYTE:
+            if(!th_byte_lock_trylock(&lock->byte_lock))
+            {
+                th_byte_lock_lock(&lock->byte_lock);
+                contended = true;
+            }
+            break;
+        case TH_LOCK_ADAPTIVE:
+            contended = th_adaptive_mutex_lock(&lock->adaptive);
+            break;
+        case TH_LOCK_MCS:
+            mcs_node = &th_lock_mcs_nodes[th_lock_node_slot(&th_lock_mcs_used)];
+            contended = th_mcs_lock_lock(&lock->mcs, mcs_node);
+            lock->holder_node = mcs_node;
+            break;
+        case TH_LOCK_CLH:
+            clh_node = th_lock_clh_node(th_lock_node_slot(&th_lock_clh_used));
+            contended = th_clh_lock_lock(&lock->clh, clh_node);
+            lock->holder_node = clh_node;
+            break;
+        default:
+            assert(0);
+    }
+    return contended;
+}
+
+void th_lock_unlock(th_lock_t *lock)
+{
+    th_mcs_node_t *mcs_node;
+    th_clh_node_t *clh_node;
+    uint32_t slot;
+
+    switch(lock->type)
+    {
+        case TH_LOCK_PTHREAD:
+            pthread_mutex_unlock(&lock->mutex);
+            break;
+        case TH_LOCK_BYTE:
+            th_byte_lock_unlock(&lock->byte_lock);
+            break;
+        case TH_LOCK_ADAPTIVE:
+            th_adaptive_mutex_unlock(&lock->adaptive);
+            break;
+        case TH_LOCK_MCS:
+            /* read holder node before release, next holder overwrites it */
+            mcs_node = (th_mcs_node_t *) lock->holder_node;
+            slot = (uint32_t)(mcs_node - th_lock_mcs_nodes);
+            th_mcs_lock_unlock(&lock->mcs, mcs_node);
+            th_lock_mcs_used &= ~(1u << slot);
+            break;
+        case TH_LOCK_CLH:
+            clh_node = (th_clh_node_t *) lock->holder_node;
+            for(slot = 0; th_lock_clh_nodes[slot] != clh_node; slot++);
+            th_clh_lock_unlock(&lock->clh, &th_lock_clh_nodes[slot]);
+            th_lock_clh_used &= ~(1u << slot);
+            break;
+        default:
+            assert(0);
+    }
+}
+
+const char *th_lock_type_name(th_lock_type_t type)
+{
+    return type < TH_LOCK_TYPES ? th_lock_type_names[type] : "unknown";
+}
@@ -0,0 +1,241 @@
+/**
+ * @file th_lock.h
+ * @author agent
+ * @brief  This file defines queue locks and an adaptive mutex for contended critical sections:
+ *         MCS and CLH waiters queue up and each one waits on its own cache line, so a release
+ *         touches only the next waiter line instead of every waiter re-reading one shared word.
+ *         adaptive mutex spins for a tuned time before sleeping.
+ *         th_lock_t wraps them all (and pthread mutex, byte lock) behind one api, so a
+ *         threadlib structure picks its lock type at init
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __TH_LOCK__
+#define __TH_LOCK__
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "th_park.h"
+#include "th_telemetry.h"
+#include "parking_lot.h"
+
+/* th_lock_t queue locks one thread can hold at once (per thread queue nodes) */
+#define TH_LOCK_MAX_HELD            8
+/* adaptive mutex spin rounds lost to other lockers before it sleeps */
+#define TH_LOCK_ADAPTIVE_RETRIES    4
+/* releaser spins this many times for its successor to link in, then yields */
+#define TH_LOCK_LINK_SPIN_COUNT     100
+
+/**
+ * @brief   adaptive mutex, spins while holder runs, sleeps on futex once the wait
+ *          outgrows its spin budget. budget is tuned from observed waits
+ *
+ */
+typedef struct th_adaptive_mutex_
+{
+    _Atomic uint32_t locked;                    /* futex word, 1 while held */
+    _Atomic uint32_t sleepers;                  /* lockers sleeping in kernel, unlock wakes one if any */
+    th_spin_budget_t budget;
+}th_adaptive_mutex_t;
+
+/**
+ * @brief   MCS queue node, one per waiting thread, waiter sleeps on its own node
+ *
+ */
+typedef struct th_mcs_node_
+{
+    _Alignas(TH_CACHE_LINE_SIZE) _Atomic(struct th_mcs_node_ *) next;     /* successor, linked after it queued */
+    th_wait_word_t granted;                     /* set by predecessor on release */
+}th_mcs_node_t;
+
+/**
+ * @brief   MCS lock, tail of waiters queue, NULL when free
+ *
+ */
+typedef struct th_mcs_lock_
+{
+    _Atomic(th_mcs_node_t *) tail;
+    th_spin_budget_t budget;
+}th_mcs_lock_t;
+
+/**
+ * @brief   CLH queue node, waiter waits on its predecessor node.
+ *          nodes move between threads: on unlock a thread gives its node to the lock
+ *          and takes its predecessor one, so nodes are allocated (th_clh_node_create())
+ *
+ */
+typedef struct th_clh_node_
+{
+    _Alignas(TH_CACHE_LINE_SIZE) th_wait_word_t released;     /* 1 once owner released the lock */
+    struct th_clh_node_ *pred;                  /* node waited on, taken by owner on unlock */
+}th_clh_node_t;
+
+/**
+ * @brief   CLH lock, tail of waiters queue, always points to a node (released when free)
+ *
+ */
+typedef struct th_clh_lock_
+{
+    _Atomic(th_clh_node_t *) tail;
+    th_spin_budget_t budget;
+}th_clh_lock_t;
+
+typedef enum th_lock_type_
+{
+    TH_LOCK_PTHREAD,                /* pthread_mutex_t, waiters share glibc lock word */
+    TH_LOCK_BYTE,                   /* th_byte_lock_t, parks on parking lot */
+    TH_LOCK_ADAPTIVE,               /* th_adaptive_mutex_t */
+    TH_LOCK_MCS,                    /* th_mcs_lock_t, FIFO */
+    TH_LOCK_CLH,                    /* th_clh_lock_t, FIFO */
+    TH_LOCK_TYPES,
+}th_lock_type_t;
+
+/**
+ * @brief   lock of type picked at init, MCS and CLH nodes come from the
+ *          calling thread, up to TH_LOCK_MAX_HELD queue locks held at once,
+ *          taking one more aborts
+ *
+ */
+typedef struct th_lock_
+{
+    th_lock_type_t type;
+    union
+    {
+        pthread_mutex_t mutex;
+        th_byte_lock_t byte_lock;
+        th_adaptive_mutex_t adaptive;
+        th_mcs_lock_t mcs;
+        th_clh_lock_t clh;
+    };
+    void *holder_node;                          /* queue node of holder, written by holder only */
+}th_lock_t;
+
+/**
+ * @brief initiate adaptive mutex
+ *
+ * @param mutex
+ */
+void th_adaptive_mutex_init(th_adaptive_mutex_t *mutex);
+
+/**
+ * @brief   lock adaptive mutex, one compare exchange when free
+ *
+ * @param mutex
+ * @return true - mutex was held, caller waited
+ */
+bool th_adaptive_mutex_lock(th_adaptive_mutex_t *mutex);
+
+/**
+ * @brief   unlock adaptive mutex, futex wake only when a locker sleeps
+ *
+ * @param mutex
+ */
+void th_adaptive_mutex_unlock(th_adaptive_mutex_t *mutex);
+
+/**
+ * @brief initiate MCS lock
+ *
+ * @param lock
+ */
+void th_mcs_lock_init(th_mcs_lock_t *lock);
+
+/**
+ * @brief   lock MCS lock, node stays queued until th_mcs_lock_unlock()
+ *
+ * @param lock
+ * @param node - caller owned, not in any queue
+ * @return true - queued behind another holder
+ */
+bool th_mcs_lock_lock(th_mcs_lock_t *lock, th_mcs_node_t *node);
+
+/**
+ * @brief   unlock MCS lock, hand it to next queued waiter
+ *
+ * @param lock
+ * @param node - node given to th_mcs_lock_lock()
+ */
+void th_mcs_lock_unlock(th_mcs_lock_t *lock, th_mcs_node_t *node);
+
+/**
+ * @brief   allocate CLH node
+ *
+ * @return th_clh_node_t*
+ */
+th_clh_node_t *th_clh_node_create(void);
+
+/**
+ * @brief   initiate CLH lock, allocate its first node
+ *
+ * @param lock
+ */
+void th_clh_lock_init(th_clh_lock_t *lock);
+
+/**
+ * @brief   free node held by CLH lock, lock must be free
+ *
+ * @param lock
+ */
+void th_clh_lock_destroy(th_clh_lock_t *lock);
+
+/**
+ * @brief   lock CLH lock
+ *
+ * @param lock
+ * @param node - caller node, allocated with th_clh_node_create()
+ * @return true - queued behind another holder
+ */
+bool th_clh_lock_lock(th_clh_lock_t *lock, th_clh_node_t *node);
+
+/**
+ * @brief   unlock CLH lock, node is left to the lock
+ *
+ * @param lock
+ * @param node - in: node given to th_clh_lock_lock(), out: node the caller owns from now on
+ */
+void th_clh_lock_unlock(th_clh_lock_t *lock, th_clh_node_t **node);
+
+/**
+ * @brief initiate lock of given type
+ *
+ * @param lock
+ * @param type
+ */
+void th_lock_init(th_lock_t *lock, th_lock_type_t type);
+
+/**
+ * @brief   destroy lock, lock must be free
+ *
+ * @param lock
+ */
+void th_lock_destroy(th_lock_t *lock);
+
+/**
+ * @brief lock
+ *
+ * @param lock
+ * @return true - lock was held by another thread, caller waited (profiler counts it contended)
+ */
+bool th_lock_lock(th_lock_t *lock);
+
+/**
+ * @brief   unlock, by locking thread
+ *
+ * @param lock
+ */
+void th_lock_unlock(th_lock_t *lock);
+
+/**
+ * @brief   lock type name, for reports
+ *
+ * @param type
+ * @return const char*
+ */
+const char *th_lock_type_name(th_lock_type_t type);
+
+#endif /* __TH_LOCK__ */
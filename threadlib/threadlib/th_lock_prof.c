@@ -0,0 +1,530 @@
+/**
+ * @file th_lock_prof.c
+ * @author agent
+ * @brief  This file implements lock contention profiler buffers and report
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "th_lock_prof.h"
+
+#ifdef THREADLIB_LOCK_PROFILE
+
+#include <stdlib.h>
+#include <string.h>
+
+/* single writer increment, report may observe it late but never torn */
+#define TH_LOCK_PROF_ADD(counter, value)                                            \
+    atomic_store_explicit(&(counter),                                               \
+        atomic_load_explicit(&(counter), memory_order_relaxed) + (value),           \
+        memory_order_relaxed)
+
+#define TH_LOCK_PROF_MAX(counter, value)                                            \
+    if((value) > atomic_load_explicit(&(counter), memory_order_relaxed))            \
+    {                                                                               \
+        atomic_store_explicit(&(counter), (value), memory_order_relaxed);           \
+    }
+
+typedef struct th_lock_prof_lock_name_
+{
+    const void *lock;
+    const char *name;
+}th_lock_prof_lock_name_t;
+
+/**
+ * @brief   one row of report, a call site or a whole lock, counters summed over threads
+ *
+ */
+typedef struct th_lock_prof_row_
+{
+    const void *lock;
+    const char *file;
+    uint32_t line;
+    uint64_t acquisitions;
+    uint64_t contended;
+    uint64_t wait_ns;
+    uint64_t max_wait_ns;
+    uint64_t hold_ns;
+    uint64_t max_hold_ns;
+}th_lock_prof_row_t;
+
+/* calling thread buffer, allocated on first acquisition */
+static __thread th_lock_prof_buffer_t *th_lock_prof_buffer = NULL;
+
+/* registry of live buffers, counters of exited threads, lock names, all under registry mutex.
+ * plain pthread mutex, never profiled */
+static pthread_mutex_t th_lock_prof_registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+static th_lock_prof_buffer_t *th_lock_prof_buffers = NULL;
+static th_lock_prof_buffer_t th_lock_prof_exited;
+static th_lock_prof_lock_name_t th_lock_prof_names[TH_LOCK_PROF_NAMES];
+
+static pthread_key_t th_lock_prof_key;
+static pthread_once_t th_lock_prof_once = PTHREAD_ONCE_INIT;
+
+/*********** private helper functions BEGIN **********/
+
+/**
+ * @brief   site entry of lock at file:line, inserted if new
+ *
+ * @note    insertion is done by buffer owner only (or under registry mutex for the exited buffer)
+ *
+ * @param buffer
+ * @param lock
+ * @param file
+ * @param line
+ * @return th_lock_prof_site_t* - NULL when table is full
+ */
+static th_lock_prof_site_t *th_lock_prof_site(th_lock_prof_buffer_t *buffer, const void *lock,
+        const char *file, uint32_t line)
+{
+    uintptr_t hash = ((uintptr_t)lock >> 4) ^ ((uintptr_t)file >> 3) ^ ((uintptr_t)line * 0x9e3779b1u);
+    th_lock_prof_site_t *site;
+    const void *key;
+
+    hash ^= hash >> 16;
+    for(uint32_t i = 0; i < TH_LOCK_PROF_SITES; i++)
+    {
+        site = &buffer->sites[(hash + i) & (TH_LOCK_PROF_SITES - 1)];
+        key = atomic_load_explicit(&site->lock, memory_order_relaxed);
+        if(key == NULL)
+        {
+            site->file = file;
+            site->line = line;
+            atomic_store_explicit(&site->lock, lock, memory_order_release);
+            return site;
+        }
+        if(key == lock && site->file == file && site->line == line)
+        {
+            return site;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief   thread exit destructor, add counters of exiting thread to exited buffer and free its buffer
+ *
+ * @param arg - th_lock_prof_buffer_t
+ */
+static void th_lock_prof_thread_exit(void *arg)
+{
+    th_lock_prof_buffer_t *buffer = (th_lock_prof_buffer_t *) arg;
+    th_lock_prof_buffer_t **link;
+    th_lock_prof_site_t *site, *merged;
+    const void *lock;
+
+    pthread_mutex_lock(&th_lock_prof_registry_mutex);
+    for(link = &th_lock_prof_buffers; *link != buffer; link = &(*link)->next);
+    *link = buffer->next;
+
+    TH_LOCK_PROF_ADD(th_lock_prof_exited.dropped, atomic_load(&buffer->dropped));
+    for(uint32_t i = 0; i < TH_LOCK_PROF_SITES; i++)
+    {
+        site = &buffer->sites[i];
+        lock = atomic_load_explicit(&site->lock, memory_order_relaxed);
+        if(lock == NULL)
+        {
+            continue;
+        }
+        merged = th_lock_prof_site(&th_lock_prof_exited, lock, site->file, site->line);
+        if(merged == NULL)
+        {
+            TH_LOCK_PROF_ADD(th_lock_prof_exited.dropped, atomic_load(&site->acquisitions));
+            continue;
+        }
+        TH_LOCK_PROF_ADD(merged->acquisitions, atomic_load(&site->acquisitions));
+        TH_LOCK_PROF_ADD(merged->contended, atomic_load(&site->contended));
+        TH_LOCK_PROF_ADD(merged->wait_ns, atomic_load(&site->wait_ns));
+        TH_LOCK_PROF_ADD(merged->hold_ns, atomic_load(&site->hold_ns));
+        TH_LOCK_PROF_MAX(merged->max_wait_ns, atomic_load(&site->max_wait_ns));
+        TH_LOCK_PROF_MAX(merged->max_hold_ns, atomic_load(&site->max_hold_ns));
+    }
+    pthread_mutex_unlock(&th_lock_prof_registry_mutex);
+
+    th_lock_prof_buffer = NULL;
+    free(buffer);
+}
+
+static void th_lock_prof_key_create(void)
+{
+    pthread_key_create(&th_lock_prof_key, th_lock_prof_thread_exit);
+}
+
+/**
+ * @brief   buffer of calling thread, allocated and registered on first use
+ *
+ * @return th_lock_prof_buffer_t*
+ */
+static th_lock_prof_buffer_t *th_lock_prof_self(void)
+{
+    th_lock_prof_buffer_t *buffer = th_lock_prof_buffer;
+
+    if(buffer != NULL)
+    {
+        return buffer;
+    }
+
+    buffer = calloc(1, sizeof(th_lock_prof_buffer_t));
+    pthread_once(&th_lock_prof_once, th_lock_prof_key_create);
+    pthread_setspecific(th_lock_prof_key, buffer);
+
+    pthread_mutex_lock(&th_lock_prof_registry_mutex);
+    buffer->next = th_lock_prof_buffers;
+    th_lock_prof_buffers = buffer;
+    pthread_mutex_unlock(&th_lock_prof_registry_mutex);
+
+    th_lock_prof_buffer = buffer;
+    return buffer;
+}
+
+/**
+ * @brief   start hold time of lock for calling thread
+ *
+ * @note    a lock already on the held list was released behind the profiler back
+ *          (e.g. application unlocked a mutex threadlib locked for it), its entry is reused
+ *
+ * @param buffer
+ * @param lock
+ * @param site
+ * @param now_ns
+ */
+static void th_lock_prof_hold(th_lock_prof_buffer_t *buffer, const void *lock,
+        th_lock_prof_site_t *site, uint64_t now_ns)
+{
+    uint32_t i;
+
+    for(i = 0; i < buffer->held_count && buffer->held[i].lock != lock; i++);
+    if(i == buffer->held_count)
+    {
+        if(buffer->held_count == TH_LOCK_PROF_MAX_HELD)
+        {
+            /* oldest one most likely was released behind our back */
+            memmove(&buffer->held[0], &buffer->held[1], sizeof(th_lock_prof_held_t) * (TH_LOCK_PROF_MAX_HELD - 1));
+            i = TH_LOCK_PROF_MAX_HELD - 1;
+        }
+        else
+        {
+            buffer->held_count++;
+        }
+    }
+    buffer->held[i].lock = lock;
+    buffer->held[i].site = site;
+    buffer->held[i].acquired_ns = now_ns;
+}
+
+/**
+ * @brief   order rows by lock, then file, then line
+ *
+ */
+static int th_lock_prof_row_key_cmp(const void *a, const void *b)
+{
+    const th_lock_prof_row_t *x = (const th_lock_prof_row_t *) a;
+    const th_lock_prof_row_t *y = (const th_lock_prof_row_t *) b;
+
+    if(x->lock != y->lock)
+    {
+        return (uintptr_t)x->lock < (uintptr_t)y->lock ? -1 : 1;
+    }
+    if(x->file != y->file)
+    {
+        return (uintptr_t)x->file < (uintptr_t)y->file ? -1 : 1;
+    }
+    return x->line < y->line ? -1 : (x->line > y->line);
+}
+
+/**
+ * @brief   order rows by wait time, then hold time, descending
+ *
+ */
+static int th_lock_prof_row_hot_cmp(const void *a, const void *b)
+{
+    const th_lock_prof_row_t *x = (const th_lock_prof_row_t *) a;
+    const th_lock_prof_row_t *y = (const th_lock_prof_row_t *) b;
+
+    if(x->wait_ns != y->wait_ns)
+    {
+        return x->wait_ns > y->wait_ns ? -1 : 1;
+    }
+    if(x->hold_ns != y->hold_ns)
+    {
+        return x->hold_ns > y->hold_ns ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief   add row counters into dst
+ *
+ * @param dst
+ * @param src
+ */
+static void th_lock_prof_row_add(th_lock_prof_row_t *dst, const th_lock_prof_row_t *src)
+{
+    dst->acquisitions += src->acquisitions;
+    dst->contended += src->contended;
+    dst->wait_ns += src->wait_ns;
+    dst->hold_ns += src->hold_ns;
+    dst->max_wait_ns = src->max_wait_ns > dst->max_wait_ns ? src->max_wait_ns : dst->max_wait_ns;
+    dst->max_hold_ns = src->max_hold_ns > dst->max_hold_ns ? src->max_hold_ns : dst->max_hold_ns;
+}
+
+/**
+ * @brief   copy used sites of buffer into rows, under registry mutex
+ *
+ * @param buffer
+ * @param rows
+ * @param count - in/out, rows used
+ */
+static void th_lock_prof_collect(th_lock_prof_buffer_t *buffer, th_lock_prof_row_t *rows, uint32_t *count)
+{
+    th_lock_prof_site_t *site;
+    th_lock_prof_row_t *row;
+    const void *lock;
+
+    for(uint32_t i = 0; i < TH_LOCK_PROF_SITES; i++)
+    {
+        site = &buffer->sites[i];
+        lock = atomic_load_explicit(&site->lock, memory_order_acquire);
+        if(lock == NULL)
+        {
+            continue;
+        }
+        row = &rows[(*count)++];
+        row->lock = lock;
+        row->file = site->file;
+        row->line = site->line;
+        row->acquisitions = atomic_load_explicit(&site->acquisitions, memory_order_relaxed);
+        row->contended = atomic_load_explicit(&site->contended, memory_order_relaxed);
+        row->wait_ns = atomic_load_explicit(&site->wait_ns, memory_order_relaxed);
+        row->max_wait_ns = atomic_load_explicit(&site->max_wait_ns, memory_order_relaxed);
+        row->hold_ns = atomic_load_explicit(&site->hold_ns, memory_order_relaxed);
+        row->max_hold_ns = atomic_load_explicit(&site->max_hold_ns, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief   report name of lock, under registry mutex
+ *
+ * @param lock
+ * @return const char*
+ */
+static const char *th_lock_prof_lock_name(const void *lock)
+{
+    for(uint32_t i = 0; i < TH_LOCK_PROF_NAMES && th_lock_prof_names[i].lock != NULL; i++)
+    {
+        if(th_lock_prof_names[i].lock == lock)
+        {
+            return th_lock_prof_names[i].name;
+        }
+    }
+    return "-";
+}
+
+static void th_lock_prof_print_row(FILE *out, const th_lock_prof_row_t *row, const char *label, uint32_t line)
+{
+    char site[64];
+
+    if(line != 0)
+    {
+        /* file name only, __FILE__ may carry the build path */
+        snprintf(site, sizeof(site), "  %s:%u", strrchr(label, '/') ? strrchr(label, '/') + 1 : label, line);
+        label = site;
+    }
+    fprintf(out, "%-36s %12lu %6.2f%% %12.3f %10lu %10.1f %12.3f %10lu %10.1f\n",
+            label, row->acquisitions,
+            row->acquisitions ? 100.0 * row->contended / row->acquisitions : 0.0,
+            row->wait_ns / 1e6, row->contended ? row->wait_ns / row->contended : 0, row->max_wait_ns / 1e3,
+            row->hold_ns / 1e6, row->acquisitions ? row->hold_ns / row->acquisitions : 0, row->max_hold_ns / 1e3);
+}
+
+/*********** private helper functions END ***********/
+
+void th_lock_prof_acquired(const void *lock, const char *file, uint32_t line, uint64_t wait_start_ns)
+{
+    th_lock_prof_buffer_t *buffer = th_lock_prof_self();
+    th_lock_prof_site_t *site = th_lock_prof_site(buffer, lock, file, line);
+    uint64_t now_ns = th_now_ns();
+    uint64_t wait_ns;
+
+    if(site == NULL)
+    {
+        TH_LOCK_PROF_ADD(buffer->dropped, 1);
+        return;
+    }
+
+    TH_LOCK_PROF_ADD(site->acquisitions, 1);
+    if(wait_start_ns != 0)
+    {
+        wait_ns = now_ns - wait_start_ns;
+        TH_LOCK_PROF_ADD(site->contended, 1);
+        TH_LOCK_PROF_ADD(site->wait_ns, wait_ns);
+        TH_LOCK_PROF_MAX(site->max_wait_ns, wait_ns);
+    }
+    th_lock_prof_hold(buffer, lock, site, now_ns);
+}
+
+void th_lock_prof_reacquired(const void *lock, const char *file, uint32_t line)
+{
+    th_lock_prof_buffer_t *buffer = th_lock_prof_self();
+    th_lock_prof_site_t *site = th_lock_prof_site(buffer, lock, file, line);
+
+    if(site != NULL)
+    {
+        th_lock_prof_hold(buffer, lock, site, th_now_ns());
+    }
+}
+
+void th_lock_prof_released(const void *lock)
+{
+    th_lock_prof_buffer_t *buffer = th_lock_prof_buffer;
+    th_lock_prof_held_t *held;
+    uint64_t hold_ns;
+
+    if(buffer == NULL)
+    {
+        return;
+    }
+
+    for(uint32_t i = buffer->held_count; i-- > 0; )
+    {
+        held = &buffer->held[i];
+        if(held->lock != lock)
+        {
+            continue;
+        }
+        hold_ns = th_now_ns() - held->acquired_ns;
+        TH_LOCK_PROF_ADD(held->site->hold_ns, hold_ns);
+        TH_LOCK_PROF_MAX(held->site->max_hold_ns, hold_ns);
+        *held = buffer->held[--buffer->held_count];
+        return;
+    }
+}
+
+void th_lock_prof_name(const void *lock, const char *name)
+{
+    pthread_mutex_lock(&th_lock_prof_registry_mutex);
+    for(uint32_t i = 0; i < TH_LOCK_PROF_NAMES; i++)
+    {
+        if(th_lock_prof_names[i].lock == NULL || th_lock_prof_names[i].lock == lock)
+        {
+            th_lock_prof_names[i].lock = lock;
+            th_lock_prof_names[i].name = name;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&th_lock_prof_registry_mutex);
+}
+
+void th_lock_prof_report(FILE *out, uint32_t top_locks)
+{
+    th_lock_prof_buffer_t *buffer;
+    th_lock_prof_row_t *sites, *locks;
+    uint32_t buffer_count = 1, site_count = 0, lock_count = 0, merged = 0;
+    uint32_t first;
+    uint64_t dropped;
+    char label[64];
+
+    pthread_mutex_lock(&th_lock_prof_registry_mutex);
+    for(buffer = th_lock_prof_buffers; buffer != NULL; buffer = buffer->next)
+    {
+        buffer_count++;
+    }
+    sites = calloc((size_t)buffer_count * TH_LOCK_PROF_SITES, sizeof(th_lock_prof_row_t));
+    dropped = atomic_load(&th_lock_prof_exited.dropped);
+    th_lock_prof_collect(&th_lock_prof_exited, sites, &site_count);
+    for(buffer = th_lock_prof_buffers; buffer != NULL; buffer = buffer->next)
+    {
+        dropped += atomic_load(&buffer->dropped);
+        th_lock_prof_collect(buffer, sites, &site_count);
+    }
+
+    /* same site seen by several threads becomes one row */
+    qsort(sites, site_count, sizeof(th_lock_prof_row_t), th_lock_prof_row_key_cmp);
+    for(uint32_t i = 0; i < site_count; i++)
+    {
+        if(merged != 0 && th_lock_prof_row_key_cmp(&sites[merged - 1], &sites[i]) == 0)
+        {
+            th_lock_prof_row_add(&sites[merged - 1], &sites[i]);
+        }
+        else
+        {
+            sites[merged++] = sites[i];
+        }
+    }
+    site_count = merged;
+
+    /* one row per lock, sites of a lock stay next to each other */
+    locks = calloc(site_count ? site_count : 1, sizeof(th_lock_prof_row_t));
+    for(uint32_t i = 0; i < site_count; i++)
+    {
+        if(lock_count == 0 || locks[lock_count - 1].lock != sites[i].lock)
+        {
+            locks[lock_count].lock = sites[i].lock;
+            locks[lock_count].line = i;         /* first site index */
+            lock_count++;
+        }
+        th_lock_prof_row_add(&locks[lock_count - 1], &sites[i]);
+    }
+    qsort(locks, lock_count, sizeof(th_lock_prof_row_t), th_lock_prof_row_hot_cmp);
+
+    fprintf(out, "%-36s %12s %7s %12s %10s %10s %12s %10s %10s\n", "lock / call site", "acquired",
+            "contend", "wait ms", "avg wait", "max us", "hold ms", "avg hold", "max us");
+    if(top_locks == 0 || top_locks > lock_count)
+    {
+        top_locks = lock_count;
+    }
+    for(uint32_t i = 0; i < top_locks; i++)
+    {
+        snprintf(label, sizeof(label), "%s %p", th_lock_prof_lock_name(locks[i].lock), locks[i].lock);
+        th_lock_prof_print_row(out, &locks[i], label, 0);
+
+        first = locks[i].line;
+        merged = first;
+        while(merged < site_count && sites[merged].lock == locks[i].lock)
+        {
+            merged++;
+        }
+        qsort(&sites[first], merged - first, sizeof(th_lock_prof_row_t), th_lock_prof_row_hot_cmp);
+        for(uint32_t j = first; j < merged; j++)
+        {
+            th_lock_prof_print_row(out, &sites[j], sites[j].file, sites[j].line);
+        }
+    }
+    if(dropped != 0)
+    {
+        fprintf(out, "acquisitions not recorded (site tables full): %lu\n", dropped);
+    }
+    pthread_mutex_unlock(&th_lock_prof_registry_mutex);
+
+    free(locks);
+    free(sites);
+}
+
+void th_lock_prof_reset(void)
+{
+    th_lock_prof_buffer_t *buffer;
+
+    pthread_mutex_lock(&th_lock_prof_registry_mutex);
+    memset(th_lock_prof_exited.sites, 0, sizeof(th_lock_prof_exited.sites));
+    atomic_store(&th_lock_prof_exited.dropped, 0);
+    for(buffer = th_lock_prof_buffers; buffer != NULL; buffer = buffer->next)
+    {
+        atomic_store(&buffer->dropped, 0);
+        for(uint32_t i = 0; i < TH_LOCK_PROF_SITES; i++)
+        {
+            /* keys stay, owner thread may be inserting right now */
+            atomic_store_explicit(&buffer->sites[i].acquisitions, 0, memory_order_relaxed);
+            atomic_store_explicit(&buffer->sites[i].contended, 0, memory_order_relaxed);
+            atomic_store_explicit(&buffer->sites[i].wait_ns, 0, memory_order_relaxed);
+            atomic_store_explicit(&buffer->sites[i].max_wait_ns, 0, memory_order_relaxed);
+            atomic_store_explicit(&buffer->sites[i].hold_ns, 0, memory_order_relaxed);
+            atomic_store_explicit(&buffer->sites[i].max_hold_ns, 0, memory_order_relaxed);
+        }
+    }
+    pthread_mutex_unlock(&th_lock_prof_registry_mutex);
+}
+
+#endif /* THREADLIB_LOCK_PROFILE */
@@ -0,0 +1,206 @@
+/**
+ * @file th_lock_prof.h
+ * @author agent
+ * @brief  This file defines the lock contention profiler: threadlib structures take their locks
+ *         through the TH_MUTEX_* / TH_COND_* / TH_LOCK macros below, which are the plain lock calls
+ *         unless THREADLIB_LOCK_PROFILE is defined. when it is, every acquisition is recorded per
+ *         lock and per call site (acquisitions, contended acquisitions, wait and hold time) in a
+ *         buffer of the acquiring thread, th_lock_prof_report() merges the buffers and ranks locks
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __TH_LOCK_PROF__
+#define __TH_LOCK_PROF__
+
+#include <pthread.h>
+#include "th_lock.h"
+
+#ifdef THREADLIB_LOCK_PROFILE
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <time.h>
+#include "th_telemetry.h"
+
+/* call sites per thread buffer (power of two), acquisitions at sites beyond are counted as dropped */
+#define TH_LOCK_PROF_SITES          256
+/* locks one thread holds at once whose hold time is tracked */
+#define TH_LOCK_PROF_MAX_HELD       16
+/* locks that can be given a name */
+#define TH_LOCK_PROF_NAMES          256
+
+/**
+ * @brief   counters of one lock at one call site, in buffer of one thread
+ *
+ * @note    single writer (owner thread), report reads them with relaxed loads.
+ *          lock is the key, stored last with release so report never sees a half written key
+ */
+typedef struct th_lock_prof_site_
+{
+    const void *_Atomic lock;                   /* NULL while entry unused */
+    const char *file;
+    uint32_t line;
+    _Atomic uint64_t acquisitions;
+    _Atomic uint64_t contended;                 /* acquisitions that found lock held */
+    _Atomic uint64_t wait_ns;
+    _Atomic uint64_t max_wait_ns;
+    _Atomic uint64_t hold_ns;                   /* attributed to the site that acquired */
+    _Atomic uint64_t max_hold_ns;
+}th_lock_prof_site_t;
+
+/**
+ * @brief   lock held by owner thread, hold time runs from acquired_ns
+ *
+ */
+typedef struct th_lock_prof_held_
+{
+    const void *lock;
+    th_lock_prof_site_t *site;
+    uint64_t acquired_ns;
+}th_lock_prof_held_t;
+
+/**
+ * @brief   per thread profile buffer, registered on first acquisition,
+ *          merged in a process wide buffer at thread exit
+ *
+ */
+typedef struct th_lock_prof_buffer_
+{
+    struct th_lock_prof_buffer_ *next;          /* registry list, under registry mutex */
+    _Atomic uint64_t dropped;                   /* acquisitions not recorded, sites table full */
+    uint32_t held_count;
+    th_lock_prof_held_t held[TH_LOCK_PROF_MAX_HELD];
+    th_lock_prof_site_t sites[TH_LOCK_PROF_SITES];
+}th_lock_prof_buffer_t;
+
+/**
+ * @brief   record acquisition of lock by calling thread, starts its hold time
+ *
+ * @param lock - lock address, identifies lock in report
+ * @param file
+ * @param line
+ * @param wait_start_ns - time contended wait began, 0 if lock was free
+ */
+void th_lock_prof_acquired(const void *lock, const char *file, uint32_t line, uint64_t wait_start_ns);
+
+/**
+ * @brief   lock taken back by a condition wait, restart its hold time, not counted as acquisition
+ *
+ * @param lock
+ * @param file
+ * @param line
+ */
+void th_lock_prof_reacquired(const void *lock, const char *file, uint32_t line);
+
+/**
+ * @brief   record hold time of lock by calling thread, nothing if it was not acquired through the profiler
+ *
+ * @param lock
+ */
+void th_lock_prof_released(const void *lock);
+
+/**
+ * @brief   name lock in report, later name replaces earlier one
+ *
+ * @param lock
+ * @param name - static string
+ */
+void th_lock_prof_name(const void *lock, const char *name);
+
+/**
+ * @brief   write lock report: locks ranked by total wait time, hottest first, each with its call sites
+ *
+ * @param out
+ * @param top_locks - locks listed, 0 for all
+ */
+void th_lock_prof_report(FILE *out, uint32_t top_locks);
+
+/**
+ * @brief   zero all counters, threads recording at the same time may lose a few updates
+ *
+ */
+void th_lock_prof_reset(void);
+
+static inline int th_lock_prof_mutex_lock(pthread_mutex_t *mutex, const char *file, uint32_t line)
+{
+    uint64_t start_ns;
+    int rc;
+
+    if(pthread_mutex_trylock(mutex) == 0)
+    {
+        th_lock_prof_acquired(mutex, file, line, 0);
+        return 0;
+    }
+    start_ns = th_now_ns();
+    rc = pthread_mutex_lock(mutex);
+    th_lock_prof_acquired(mutex, file, line, start_ns);
+    return rc;
+}
+
+static inline int th_lock_prof_mutex_unlock(pthread_mutex_t *mutex)
+{
+    th_lock_prof_released(mutex);
+    return pthread_mutex_unlock(mutex);
+}
+
+/**
+ * @brief   condition wait, hold time stops while mutex is given up
+ *
+ * @param cv
+ * @param mutex
+ * @param deadline - NULL to wait forever
+ * @param file
+ * @param line
+ * @return int - pthread_cond_wait() / pthread_cond_timedwait() result
+ */
+static inline int th_lock_prof_cond_wait(pthread_cond_t *cv, pthread_mutex_t *mutex,
+        const struct timespec *deadline, const char *file, uint32_t line)
+{
+    int rc;
+
+    th_lock_prof_released(mutex);
+    rc = deadline == NULL ? pthread_cond_wait(cv, mutex) : pthread_cond_timedwait(cv, mutex, deadline);
+    th_lock_prof_reacquired(mutex, file, line);
+    return rc;
+}
+
+static inline void th_lock_prof_lock(th_lock_t *lock, const char *file, uint32_t line)
+{
+    uint64_t start_ns = th_now_ns();
+
+    th_lock_prof_acquired(lock, file, line, th_lock_lock(lock) ? start_ns : 0);
+}
+
+static inline void th_lock_prof_unlock(th_lock_t *lock)
+{
+    th_lock_prof_released(lock);
+    th_lock_unlock(lock);
+}
+
+#define TH_MUTEX_LOCK(mutex)                    th_lock_prof_mutex_lock(mutex, __FILE__, __LINE__)
+#define TH_MUTEX_UNLOCK(mutex)                  th_lock_prof_mutex_unlock(mutex)
+#define TH_COND_WAIT(cv, mutex)                 th_lock_prof_cond_wait(cv, mutex, NULL, __FILE__, __LINE__)
+#define TH_COND_TIMEDWAIT(cv, mutex, deadline)  th_lock_prof_cond_wait(cv, mutex, deadline, __FILE__, __LINE__)
+#define TH_LOCK(lock)                           th_lock_prof_lock(lock, __FILE__, __LINE__)
+#define TH_UNLOCK(lock)                         th_lock_prof_unlock(lock)
+#define TH_LOCK_PROF_NAME(lock, name)           th_lock_prof_name(lock, name)
+
+#else
+
+#define TH_MUTEX_LOCK(mutex)                    pthread_mutex_lock(mutex)
+#define TH_MUTEX_UNLOCK(mutex)                  pthread_mutex_unlock(mutex)
+#define TH_COND_WAIT(cv, mutex)                 pthread_cond_wait(cv, mutex)
+#define TH_COND_TIMEDWAIT(cv, mutex, deadline)  pthread_cond_timedwait(cv, mutex, deadline)
+#define TH_LOCK(lock)                           th_lock_lock(lock)
+#define TH_UNLOCK(lock)                         th_lock_unlock(lock)
+#define TH_LOCK_PROF_NAME(lock, name)           ((void)0)
+
+#endif /* THREADLIB_LOCK_PROFILE */
+
+#endif /* __TH_LOCK_PROF__ */
@@ -0,0 +1,404 @@
+/**
+ * @file th_park.c
+ * @author agent
+ * @brief  This file implements futex based spin-then-park wait primitive
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "th_park.h"
+#include "th_telemetry.h"
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <sched.h>
+#include <errno.h>
+#include <stdint.h>
+
+/* clock is read once per this many spin iterations */
+#define TH_PARK_SPIN_CHECK_MASK     63
+
+static __thread th_parker_t th_parker_tls = { TH_PARKER_EMPTY, { TH_PARK_SPIN_INIT_NS } };
+
+/*********** private helper functions BEGIN **********/
+
+/**
+ * @brief   spinning only pays off when waker can run on another cpu
+ *
+ * @return true - more than one online cpu
+ */
+static bool th_park_can_spin(void)
+{
+    static _Atomic int cpu_count = 0;
+    int count = atomic_load_explicit(&cpu_count, memory_order_relaxed);
+
+    if(count == 0)
+    {
+        count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        count = count > 0 ? count : 1;
+        atomic_store_explicit(&cpu_count, count, memory_order_relaxed);
+    }
+    return count > 1;
+}
+
+/**
+ * @brief   spin until *word != value or budget is used up
+ *
+ * @param word
+ * @param value
+ * @param spin_ns - spin budget
+ * @return true - word changed while spinning
+ */
+static bool th_spin_while_equal(_Atomic uint32_t *word, uint32_t value, uint32_t spin_ns)
+{
+    uint64_t deadline_ns;
+    uint32_t i;
+
+    if(spin_ns == 0 || !th_park_can_spin())
+    {
+        return false;
+    }
+
+    deadline_ns = th_now_ns() + spin_ns;
+    for(i = 1; ; i++)
+    {
+        if(atomic_load_explicit(word, memory_order_acquire) != value)
+        {
+            return true;
+        }
+        TH_CPU_RELAX();
+        if((i & TH_PARK_SPIN_CHECK_MASK) == 0 && th_now_ns() >= deadline_ns)
+        {
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief   yield cpu a few rounds until *word != value
+ *
+ * @param word
+ * @param value
+ * @return true - word changed while yielding
+ */
+static bool th_yield_while_equal(_Atomic uint32_t *word, uint32_t value)
+{
+    for(uint32_t i = 0; i < TH_PARK_YIELD_COUNT; i++)
+    {
+        sched_yield();
+        if(atomic_load_explicit(word, memory_order_acquire) != value)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief   spin budget to use for next wait
+ *
+ * @param budget - NULL for no spinning
+ * @return uint32_t
+ */
+static uint32_t th_spin_budget_get(th_spin_budget_t *budget)
+{
+    return budget ? atomic_load_explicit(&budget->spin_ns, memory_order_relaxed) : 0;
+}
+
+/**
+ * @brief   wrap-around safe check value reached target
+ *
+ * @param value
+ * @param target
+ * @return true
+ */
+static inline bool th_wait_word_reached(uint32_t value, uint32_t target)
+{
+    return (int32_t)(value - target) >= 0;
+}
+
+/**
+ * @brief   spin until word reach target or budget is used up
+ *
+ * @param word
+ * @param target
+ * @param spin_ns
+ * @return true - target reached while spinning
+ */
+static bool th_spin_until(th_wait_word_t *word, uint32_t target, uint32_t spin_ns)
+{
+    uint64_t deadline_ns;
+
+    if(spin_ns == 0 || !th_park_can_spin())
+    {
+        return false;
+    }
+
+    deadline_ns = th_now_ns() + spin_ns;
+    for(uint32_t i = 1; ; i++)
+    {
+        if(th_wait_word_reached(atomic_load_explicit(&word->value, memory_order_acquire), target))
+        {
+            return true;
+        }
+        TH_CPU_RELAX();
+        if((i & TH_PARK_SPIN_CHECK_MASK) == 0 && th_now_ns() >= deadline_ns)
+        {
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief   wakeup word sleepers after value change
+ *
+ * @note    value change and sleepers load are both seq_cst, pairing with the waiter
+ *          incrementing sleepers then re-reading value, so a wakeup is never lost
+ *
+ * @param word
+ */
+static void th_wait_word_wake(th_wait_word_t *word)
+{
+    if(atomic_load(&word->sleepers) != 0)
+    {
+        th_futex_wake(&word->value, INT32_MAX);
+    }
+}
+
+/*********** private helper functions END ***********/
+
+void th_futex_wait(_Atomic uint32_t *word, uint32_t value)
+{
+    syscall(SYS_futex, (uint32_t *)word, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+}
+
+int th_futex_wait_until(_Atomic uint32_t *word, uint32_t value, const struct timespec *deadline)
+{
+    if(deadline == NULL)
+    {
+        th_futex_wait(word, value);
+        return 0;
+    }
+
+    /* bitset wait takes an absolute timeout, no clock read or rearm on spurious wakeups */
+    if(syscall(SYS_futex, (uint32_t *)word, FUTEX_WAIT_BITSET_PRIVATE, value, deadline, NULL,
+                FUTEX_BITSET_MATCH_ANY) == -1 && errno == ETIMEDOUT)
+    {
+        return ETIMEDOUT;
+    }
+    return 0;
+}
+
+void th_deadline_in(struct timespec *deadline, uint64_t timeout_ns)
+{
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    timeout_ns += (uint64_t)deadline->tv_nsec;
+    deadline->tv_sec += (time_t)(timeout_ns / 1000000000ULL);
+    deadline->tv_nsec = (long)(timeout_ns % 1000000000ULL);
+}
+
+void th_futex_wake(_Atomic uint32_t *word, int32_t count)
+{
+    syscall(SYS_futex, (uint32_t *)word, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+void th_spin_budget_init(th_spin_budget_t *budget)
+{
+    atomic_init(&budget->spin_ns, TH_PARK_SPIN_INIT_NS);
+}
+
+void th_spin_budget_update(th_spin_budget_t *budget, uint64_t wait_ns)
+{
+    uint64_t target_ns = wait_ns <= TH_PARK_SPIN_MAX_NS / 2 ? wait_ns * 2 : TH_PARK_SPIN_MIN_NS;
+    int64_t budget_ns;
+
+    if(budget == NULL)
+    {
+        return;
+    }
+
+    budget_ns = (int64_t)atomic_load_explicit(&budget->spin_ns, memory_order_relaxed);
+    budget_ns += ((int64_t)target_ns - budget_ns) / 8;
+    if(budget_ns < TH_PARK_SPIN_MIN_NS)
+    {
+        budget_ns = TH_PARK_SPIN_MIN_NS;
+    }
+    if(budget_ns > TH_PARK_SPIN_MAX_NS)
+    {
+        budget_ns = TH_PARK_SPIN_MAX_NS;
+    }
+    atomic_store_explicit(&budget->spin_ns, (uint32_t)budget_ns, memory_order_relaxed);
+}
+
+bool th_spin_wait_while_equal(_Atomic uint32_t *word, uint32_t value, th_spin_budget_t *budget)
+{
+    return th_spin_while_equal(word, value, th_spin_budget_get(budget));
+}
+
+void th_futex_wait_while_equal(_Atomic uint32_t *word, uint32_t value, th_spin_budget_t *budget)
+{
+    uint64_t start_ns;
+
+    if(atomic_load_explicit(word, memory_order_acquire) != value)
+    {
+        return;
+    }
+
+    start_ns = th_now_ns();
+    if(!th_spin_while_equal(word, value, th_spin_budget_get(budget)) &&
+       !th_yield_while_equal(word, value))
+    {
+        while(atomic_load_explicit(word, memory_order_acquire) == value)
+        {
+            th_futex_wait(word, value);
+        }
+    }
+
+    th_spin_budget_update(budget, th_now_ns() - start_ns);
+}
+
+void th_wait_word_init(th_wait_word_t *word, uint32_t value)
+{
+    atomic_init(&word->value, value);
+    atomic_init(&word->sleepers, 0);
+}
+
+void th_wait_word_wait_until(th_wait_word_t *word, uint32_t target, th_spin_budget_t *budget)
+{
+    th_wait_word_wait_deadline(word, target, budget, NULL);
+}
+
+int th_wait_word_wait_deadline(th_wait_word_t *word, uint32_t target, th_spin_budget_t *budget,
+        const struct timespec *deadline)
+{
+    uint32_t value;
+    uint64_t start_ns;
+    int rc = 0;
+
+    if(th_wait_word_reached(atomic_load_explicit(&word->value, memory_order_acquire), target))
+    {
+        return 0;
+    }
+
+    start_ns = th_now_ns();
+    if(!th_spin_until(word, target, th_spin_budget_get(budget)))
+    {
+        for(uint32_t i = 0; i < TH_PARK_YIELD_COUNT; i++)
+        {
+            sched_yield();
+        }
+
+        atomic_fetch_add(&word->sleepers, 1);
+        while(!th_wait_word_reached(value = atomic_load(&word->value), target))
+        {
+            if(th_futex_wait_until(&word->value, value, deadline) == ETIMEDOUT)
+            {
+                /* target may have been reached right at the deadline */
+                rc = th_wait_word_reached(atomic_load(&word->value), target) ? 0 : ETIMEDOUT;
+                break;
+            }
+        }
+        atomic_fetch_sub_explicit(&word->sleepers, 1, memory_order_relaxed);
+    }
+
+    /* timed out waits say nothing about wakeup latency, keep them out of the budget */
+    if(rc == 0)
+    {
+        th_spin_budget_update(budget, th_now_ns() - start_ns);
+    }
+    return rc;
+}
+
+void th_wait_word_add(th_wait_word_t *word, uint32_t delta)
+{
+    atomic_fetch_add(&word->value, delta);
+    th_wait_word_wake(word);
+}
+
+void th_wait_word_advance(th_wait_word_t *word, uint32_t value)
+{
+    uint32_t current = atomic_load(&word->value);
+
+    while(!th_wait_word_reached(current, value))
+    {
+        if(atomic_compare_exchange_weak(&word->value, &current, value))
+        {
+            th_wait_word_wake(word);
+            return;
+        }
+    }
+}
+
+void th_wait_word_store(th_wait_word_t *word, uint32_t value)
+{
+    atomic_store(&word->value, value);
+    th_wait_word_wake(word);
+}
+
+void th_parker_init(th_parker_t *parker)
+{
+    atomic_init(&parker->state, TH_PARKER_EMPTY);
+    th_spin_budget_init(&parker->budget);
+}
+
+void th_park(th_parker_t *parker)
+{
+    th_park_until(parker, NULL);
+}
+
+int th_park_until(th_parker_t *parker, const struct timespec *deadline)
+{
+    uint32_t expected = TH_PARKER_EMPTY;
+    uint64_t start_ns;
+
+    /* fast path - wakeup already delivered */
+    if(atomic_load_explicit(&parker->state, memory_order_acquire) == TH_PARKER_NOTIFIED)
+    {
+        atomic_store_explicit(&parker->state, TH_PARKER_EMPTY, memory_order_relaxed);
+        return 0;
+    }
+
+    start_ns = th_now_ns();
+    if(!th_spin_while_equal(&parker->state, TH_PARKER_EMPTY, th_spin_budget_get(&parker->budget)) &&
+       !th_yield_while_equal(&parker->state, TH_PARKER_EMPTY) &&
+       atomic_compare_exchange_strong_explicit(&parker->state, &expected, TH_PARKER_PARKED,
+                memory_order_acquire, memory_order_acquire))
+    {
+        /* sleep in kernel, state stays parked over spurious wakeups */
+        while(atomic_load_explicit(&parker->state, memory_order_acquire) == TH_PARKER_PARKED)
+        {
+            if(th_futex_wait_until(&parker->state, TH_PARKER_PARKED, deadline) == ETIMEDOUT)
+            {
+                /* withdraw, unless unpark got in first */
+                expected = TH_PARKER_PARKED;
+                if(atomic_compare_exchange_strong_explicit(&parker->state, &expected, TH_PARKER_EMPTY,
+                            memory_order_acquire, memory_order_acquire))
+                {
+                    return ETIMEDOUT;
+                }
+                break;
+            }
+        }
+    }
+
+    /* only unpark can move state away from empty or parked, consume it */
+    atomic_store_explicit(&parker->state, TH_PARKER_EMPTY, memory_order_relaxed);
+    th_spin_budget_update(&parker->budget, th_now_ns() - start_ns);
+    return 0;
+}
+
+void th_unpark(th_parker_t *parker)
+{
+    if(atomic_exchange_explicit(&parker->state, TH_PARKER_NOTIFIED, memory_order_release) == TH_PARKER_PARKED)
+    {
+        th_futex_wake(&parker->state, 1);
+    }
+}
+
+th_parker_t *th_parker_self(void)
+{
+    return &th_parker_tls;
+}
@@ -0,0 +1,248 @@
+/**
+ * @file th_park.h
+ * @author agent
+ * @brief  This file defines thread parking primitive over Linux futex,
+ *         waiters spin briefly, then yield, then sleep in kernel.
+ *         spin budget adapts at runtime to how long each waiter actually waits
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __TH_PARK__
+#define __TH_PARK__
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/* cpu hint inside spin loops */
+#if defined(__x86_64__) || defined(__i386__)
+#define TH_CPU_RELAX()      __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define TH_CPU_RELAX()      __asm__ __volatile__("yield" ::: "memory")
+#else
+#define TH_CPU_RELAX()      __asm__ __volatile__("" ::: "memory")
+#endif
+
+/* spin budget bounds (nano seconds), waits longer than max never spin */
+#define TH_PARK_SPIN_MIN_NS         0
+#define TH_PARK_SPIN_MAX_NS         50000
+#define TH_PARK_SPIN_INIT_NS        2000
+/* sched_yield() rounds before sleeping in kernel */
+#define TH_PARK_YIELD_COUNT         2
+
+/* parker states */
+#define TH_PARKER_EMPTY             0
+#define TH_PARKER_NOTIFIED          1
+#define TH_PARKER_PARKED            2
+
+/**
+ * @brief   adaptive spin budget, embed in any object whose waits should tune themselves,
+ *          may be shared by several waiters (updates are relaxed, it is only a hint)
+ *
+ */
+typedef struct th_spin_budget_
+{
+    _Atomic uint32_t spin_ns;
+}th_spin_budget_t;
+
+/**
+ * @brief   one-shot wakeup token owned by one thread (like a binary semaphore)
+ *
+ * @note    only the owner thread parks on it, any thread can unpark it,
+ *          unpark before park is remembered so the next park returns immediately
+ */
+typedef struct th_parker_
+{
+    _Atomic uint32_t state;                     /* futex word: empty, notified or parked */
+    th_spin_budget_t budget;                    /* adaptive spin budget of owner */
+}th_parker_t;
+
+/**
+ * @brief   futex word counting up, waiters wait for it to reach a target,
+ *          wakers skip the futex syscall when nobody sleeps on it
+ *
+ */
+typedef struct th_wait_word_
+{
+    _Atomic uint32_t value;                     /* futex word */
+    _Atomic uint32_t sleepers;                  /* waiters sleeping in kernel */
+}th_wait_word_t;
+
+/**
+ * @brief initiate parker
+ *
+ * @param parker
+ */
+void th_parker_init(th_parker_t *parker);
+
+/**
+ * @brief   block owner thread until parker is unparked, consume the wakeup
+ *
+ * @param parker
+ */
+void th_park(th_parker_t *parker);
+
+/**
+ * @brief   th_park() bounded by an absolute deadline
+ *
+ * @note    a wakeup racing with the timeout is consumed and reported as success,
+ *          so no stale token is left for the next park
+ *
+ * @param parker
+ * @param deadline - absolute CLOCK_MONOTONIC time, NULL to wait forever
+ * @return int - 0 when unparked, ETIMEDOUT
+ */
+int th_park_until(th_parker_t *parker, const struct timespec *deadline);
+
+/**
+ * @brief   wakeup parker owner, or make its next th_park() return immediately
+ *
+ * @param parker
+ */
+void th_unpark(th_parker_t *parker);
+
+/**
+ * @brief   parker of calling thread, kept in thread local storage so its spin budget
+ *          survives across waits
+ *
+ * @return th_parker_t*
+ */
+th_parker_t *th_parker_self(void);
+
+/**
+ * @brief initiate spin budget
+ *
+ * @param budget
+ */
+void th_spin_budget_init(th_spin_budget_t *budget);
+
+/**
+ * @brief   tune spin budget from observed wait time, for waits not made with the functions below
+ *
+ * @note    budget moves 1/8 of the way toward twice the last wait, so a waiter that is
+ *          usually woken within the budget catches its wakeup while spinning,
+ *          waits longer than TH_PARK_SPIN_MAX_NS pull budget down toward zero
+ *
+ * @param budget - budget to update, NULL for none
+ * @param wait_ns - how long last wait took
+ */
+void th_spin_budget_update(th_spin_budget_t *budget, uint64_t wait_ns);
+
+/**
+ * @brief   spin phase of th_futex_wait_while_equal() alone, for waiters that must
+ *          announce themselves before sleeping. budget is not tuned, caller does it
+ *
+ * @param word
+ * @param value
+ * @param budget - spin budget to use, NULL to not spin
+ * @return true - word changed while spinning, false - budget used up (or single cpu)
+ */
+bool th_spin_wait_while_equal(_Atomic uint32_t *word, uint32_t value, th_spin_budget_t *budget);
+
+/**
+ * @brief   block while *word == value, spin then yield then futex wait
+ *
+ * @note    the waker must change *word before calling th_futex_wake()
+ *
+ * @param word
+ * @param value
+ * @param budget - spin budget to use and tune, NULL to sleep without spinning
+ */
+void th_futex_wait_while_equal(_Atomic uint32_t *word, uint32_t value, th_spin_budget_t *budget);
+
+/**
+ * @brief initiate wait word
+ *
+ * @param word
+ * @param value
+ */
+void th_wait_word_init(th_wait_word_t *word, uint32_t value);
+
+/**
+ * @brief   block until word value reach target, spin then yield then futex wait
+ *
+ * @note    comparison is wrap-around safe: value reached target when (int32_t)(value - target) >= 0
+ *
+ * @param word
+ * @param target
+ * @param budget - spin budget to use and tune, NULL to sleep without spinning
+ */
+void th_wait_word_wait_until(th_wait_word_t *word, uint32_t target, th_spin_budget_t *budget);
+
+/**
+ * @brief   th_wait_word_wait_until() bounded by an absolute deadline
+ *
+ * @param word
+ * @param target
+ * @param budget - spin budget to use and tune, NULL to sleep without spinning
+ * @param deadline - absolute CLOCK_MONOTONIC time, NULL to wait forever
+ * @return int - 0 when target reached, ETIMEDOUT
+ */
+int th_wait_word_wait_deadline(th_wait_word_t *word, uint32_t target, th_spin_budget_t *budget,
+        const struct timespec *deadline);
+
+/**
+ * @brief   add to word value (release), wakeup all its sleepers
+ *
+ * @param word
+ * @param delta
+ */
+void th_wait_word_add(th_wait_word_t *word, uint32_t delta);
+
+/**
+ * @brief   store word value (release), wakeup all its sleepers
+ *
+ * @param word
+ * @param value
+ */
+void th_wait_word_store(th_wait_word_t *word, uint32_t value);
+
+/**
+ * @brief   raise word value to at least value (wrap-around safe), wakeup all its sleepers,
+ *          for words several threads advance without ordering among them
+ *
+ * @param word
+ * @param value
+ */
+void th_wait_word_advance(th_wait_word_t *word, uint32_t value);
+
+/**
+ * @brief   futex wait syscall, return on wakeup, value mismatch or signal
+ *
+ * @param word
+ * @param value
+ */
+void th_futex_wait(_Atomic uint32_t *word, uint32_t value);
+
+/**
+ * @brief   futex wait syscall bounded by an absolute deadline
+ *
+ * @param word
+ * @param value
+ * @param deadline - absolute CLOCK_MONOTONIC time, NULL to wait forever
+ * @return int - 0, or ETIMEDOUT once deadline passed
+ */
+int th_futex_wait_until(_Atomic uint32_t *word, uint32_t value, const struct timespec *deadline);
+
+/**
+ * @brief   absolute CLOCK_MONOTONIC deadline timeout_ns from now, for the *_until() waits
+ *
+ * @param deadline
+ * @param timeout_ns
+ */
+void th_deadline_in(struct timespec *deadline, uint64_t timeout_ns);
+
+/**
+ * @brief   futex wake syscall
+ *
+ * @param word
+ * @param count - number of waiters to wake, INT32_MAX for all
+ */
+void th_futex_wake(_Atomic uint32_t *word, int32_t count);
+
+#endif /* __TH_PARK__ */
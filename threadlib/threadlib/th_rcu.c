@@ -0,0 +1,245 @@
+/**
+ * @file th_rcu.c
+ * @author agent
+ * @brief  This file implements userspace read-copy-update grace periods and batched reclamation
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "th_rcu.h"
+#include "threadlib.h"
+#include <stdlib.h>
+#include <sched.h>
+#include <unistd.h>
+#include <assert.h>
+
+/*********** private helper functions BEGIN **********/
+
+/**
+ * @brief   wait until reader is outside read side (epoch) or offline / past grace period gp (QSBR)
+ *
+ * @note    a reader that entered read side or announced a quiescent state after
+ *          gp was published holds gp or more, it can not see unlinked nodes
+ *
+ * @param reader
+ * @param gp
+ */
+static void th_rcu_wait_reader(th_rcu_reader_t *reader, uint64_t gp)
+{
+    uint64_t ctr;
+    uint32_t rounds = 0;
+
+    while((ctr = atomic_load(&reader->ctr)) != TH_RCU_OFFLINE && ctr < gp)
+    {
+        if(rounds++ < TH_RCU_YIELD_COUNT)
+        {
+            sched_yield();
+        }
+        else
+        {
+            usleep(TH_RCU_SLEEP_US);
+        }
+    }
+}
+
+/**
+ * @brief   reclaimer thread, gather a batch, wait one grace period for all of it, run it
+ *
+ * @param arg - th_rcu_t - pointer
+ * @return void*
+ */
+static void *th_rcu_reclaim_fn(void *arg)
+{
+    th_rcu_t *rcu = (th_rcu_t *) arg;
+    th_rcu_head_t *batch, *next;
+    uint32_t count;
+    struct timespec deadline;
+
+    TH_MUTEX_LOCK(&rcu->cb_mutex);
+    for(;;)
+    {
+        while(rcu->cb_queued == 0 && !rcu->stop)
+        {
+            TH_COND_WAIT(&rcu->cb_cv, &rcu->cb_mutex);
+        }
+        if(rcu->cb_queued == 0)
+        {
+            /* stopped and drained */
+            break;
+        }
+
+        /* let the batch fill, unless callers are already held back by the limit */
+        th_deadline_in(&deadline, (uint64_t)TH_RCU_BATCH_MS * 1000000ULL);
+        while(rcu->cb_queued < TH_RCU_BATCH_COUNT && rcu->cb_pending < rcu->max_pending && !rcu->stop)
+        {
+            if(TH_COND_TIMEDWAIT(&rcu->cb_cv, &rcu->cb_mutex, &deadline) != 0)
+            {
+                break;
+            }
+        }
+
+        batch = rcu->cb_head;
+        count = rcu->cb_queued;
+        rcu->cb_head = NULL;
+        rcu->cb_tail = &rcu->cb_head;
+        rcu->cb_queued = 0;
+        TH_MUTEX_UNLOCK(&rcu->cb_mutex);
+
+        /* one grace period for the whole batch */
+        th_rcu_synchronize(rcu, NULL);
+        for(; batch != NULL; batch = next)
+        {
+            next = batch->next;
+            batch->func(batch);
+        }
+
+        TH_MUTEX_LOCK(&rcu->cb_mutex);
+        rcu->cb_pending -= count;
+        pthread_cond_broadcast(&rcu->cb_room_cv);
+    }
+    TH_MUTEX_UNLOCK(&rcu->cb_mutex);
+    return NULL;
+}
+
+/*********** private helper functions END ***********/
+
+void th_rcu_init(th_rcu_t *rcu, th_rcu_flavor_t flavor, uint32_t max_pending)
+{
+    pthread_condattr_t attr;
+
+    /* grace periods start at 1, 0 is TH_RCU_OFFLINE */
+    atomic_init(&rcu->gp_ctr, 1);
+    rcu->flavor = flavor;
+    pthread_mutex_init(&rcu->gp_mutex, NULL);
+    TH_LOCK_PROF_NAME(&rcu->gp_mutex, "th_rcu_t gp_mutex");
+    init_glthread(&rcu->readers);
+
+    pthread_mutex_init(&rcu->cb_mutex, NULL);
+    TH_LOCK_PROF_NAME(&rcu->cb_mutex, "th_rcu_t cb_mutex");
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&rcu->cb_cv, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_cond_init(&rcu->cb_room_cv, NULL);
+    rcu->cb_head = NULL;
+    rcu->cb_tail = &rcu->cb_head;
+    rcu->cb_queued = 0;
+    rcu->cb_pending = 0;
+    rcu->max_pending = max_pending ? max_pending : 1;
+    rcu->stop = false;
+
+    rcu->reclaim_thread = thread_create(NULL, "rcu_reclaim");
+    thread_set_thread_attribute_joinable_or_detached(rcu->reclaim_thread, true);
+    thread_run(rcu->reclaim_thread, th_rcu_reclaim_fn, rcu);
+}
+
+void th_rcu_destroy(th_rcu_t *rcu)
+{
+    TH_MUTEX_LOCK(&rcu->cb_mutex);
+    rcu->stop = true;
+    pthread_cond_signal(&rcu->cb_cv);
+    TH_MUTEX_UNLOCK(&rcu->cb_mutex);
+
+    pthread_join(rcu->reclaim_thread->thread, NULL);
+    free(rcu->reclaim_thread);
+    rcu->reclaim_thread = NULL;
+}
+
+void th_rcu_register_reader(th_rcu_t *rcu, th_rcu_reader_t *reader)
+{
+    reader->rcu = rcu;
+    reader->nesting = 0;
+    init_glthread(&reader->glue);
+    atomic_init(&reader->ctr, TH_RCU_OFFLINE);
+
+    TH_MUTEX_LOCK(&rcu->gp_mutex);
+    glthread_add_next(&rcu->readers, &reader->glue);
+    TH_MUTEX_UNLOCK(&rcu->gp_mutex);
+
+    th_rcu_thread_online(reader);
+}
+
+void th_rcu_unregister_reader(th_rcu_reader_t *reader)
+{
+    th_rcu_t *rcu = reader->rcu;
+
+    assert(reader->nesting == 0);
+    th_rcu_thread_offline(reader);
+
+    TH_MUTEX_LOCK(&rcu->gp_mutex);
+    remove_glthread(&reader->glue);
+    TH_MUTEX_UNLOCK(&rcu->gp_mutex);
+}
+
+void th_rcu_synchronize(th_rcu_t *rcu, th_rcu_reader_t *reader)
+{
+    glthread_t *curr;
+    uint64_t gp;
+
+    if(reader != NULL)
+    {
+        assert(reader->nesting == 0);
+        /* grace period must not wait for its own caller */
+        th_rcu_thread_offline(reader);
+    }
+
+    TH_MUTEX_LOCK(&rcu->gp_mutex);
+
+    /* unlink stores ordered before new grace period, pairs with readers fences */
+    atomic_thread_fence(memory_order_seq_cst);
+    gp = atomic_fetch_add(&rcu->gp_ctr, 1) + 1;
+    atomic_thread_fence(memory_order_seq_cst);
+
+    ITERATE_GLTHREAD_BEGIN(&rcu->readers, curr)
+    {
+        th_rcu_wait_reader(glue_to_th_rcu_reader(curr), gp);
+    } ITERATE_GLTHREAD_END(&rcu->readers, curr);
+
+    /* reclaim only after readers accesses */
+    atomic_thread_fence(memory_order_seq_cst);
+    TH_MUTEX_UNLOCK(&rcu->gp_mutex);
+
+    if(reader != NULL)
+    {
+        th_rcu_thread_online(reader);
+    }
+}
+
+void th_rcu_call(th_rcu_t *rcu, th_rcu_reader_t *reader, th_rcu_head_t *head,
+        void (*func)(th_rcu_head_t *head))
+{
+    head->func = func;
+    head->next = NULL;
+
+    TH_MUTEX_LOCK(&rcu->cb_mutex);
+    if(rcu->cb_pending >= rcu->max_pending)
+    {
+        /* bound memory held by pending frees, reclaimer must not wait for us meanwhile */
+        if(reader != NULL)
+        {
+            th_rcu_thread_offline(reader);
+        }
+        pthread_cond_signal(&rcu->cb_cv);
+        while(rcu->cb_pending >= rcu->max_pending)
+        {
+            TH_COND_WAIT(&rcu->cb_room_cv, &rcu->cb_mutex);
+        }
+        if(reader != NULL)
+        {
+            th_rcu_thread_online(reader);
+        }
+    }
+
+    *rcu->cb_tail = head;
+    rcu->cb_tail = &head->next;
+    rcu->cb_pending++;
+    if(rcu->cb_queued++ == 0 || rcu->cb_queued >= TH_RCU_BATCH_COUNT)
+    {
+        /* wakeup reclaimer to start a batch, or to end its wait for a full one */
+        pthread_cond_signal(&rcu->cb_cv);
+    }
+    TH_MUTEX_UNLOCK(&rcu->cb_mutex);
+}
@@ -0,0 +1,235 @@
+/**
+ * @file th_rcu.h
+ * @author agent
+ * @brief  This file defines userspace read-copy-update: readers take no lock and write no
+ *         shared memory, writers unlink nodes then free them once every reader that could
+ *         still see them passed a quiescent state (grace period).
+ *         two flavors: QSBR, readers announce quiescent states at their pause points and
+ *         read side sections cost nothing, and epoch, readers publish the grace period
+ *         they entered in their own slot and need no quiescent state calls
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __TH_RCU__
+#define __TH_RCU__
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "glthread.h"
+#include "th_telemetry.h"
+
+/* callbacks reclaimer waits to gather before starting a grace period */
+#define TH_RCU_BATCH_COUNT          64
+/* longest a callback waits for its batch to fill */
+#define TH_RCU_BATCH_MS             10
+/* grace period waits yield this many rounds per reader, then sleep */
+#define TH_RCU_YIELD_COUNT          16
+#define TH_RCU_SLEEP_US             100
+
+/* reader counter value outside read side (epoch) or while offline (QSBR) */
+#define TH_RCU_OFFLINE              0
+
+struct thread_;
+
+typedef enum th_rcu_flavor_
+{
+    TH_RCU_QSBR,                    /* quiescent state based, readers call th_rcu_quiescent_state() */
+    TH_RCU_EPOCH,                   /* readers publish entered grace period in read lock */
+}th_rcu_flavor_t;
+
+struct th_rcu_;
+
+/**
+ * @brief   reader registration, one per thread and domain, owned by reader thread
+ *
+ */
+typedef struct th_rcu_reader_
+{
+    /* grace period seen at last quiescent state (QSBR) or at read lock (epoch), written by owner only */
+    _Alignas(TH_CACHE_LINE_SIZE) _Atomic uint64_t ctr;
+    uint32_t nesting;                           /* read side nesting */
+    struct th_rcu_ *rcu;
+    glthread_t glue;                            /* node in rcu->readers */
+}th_rcu_reader_t;
+GLTHREAD_TO_STRUCT(glue_to_th_rcu_reader, th_rcu_reader_t, glue);
+
+/**
+ * @brief   deferred free, embedded in the node to reclaim
+ *
+ */
+typedef struct th_rcu_head_
+{
+    struct th_rcu_head_ *next;
+    void (*func)(struct th_rcu_head_ *head);    /* called after a grace period, usually frees the node */
+}th_rcu_head_t;
+
+typedef struct th_rcu_
+{
+    /* read by every reader, written once per grace period */
+    _Alignas(TH_CACHE_LINE_SIZE) _Atomic uint64_t gp_ctr;
+    th_rcu_flavor_t flavor;
+
+    _Alignas(TH_CACHE_LINE_SIZE) pthread_mutex_t gp_mutex;     /* serialise grace periods and registration */
+    glthread_t readers;
+
+    /* th_rcu_call() callbacks, reclaimed in batches on background thread */
+    pthread_mutex_t cb_mutex;
+    pthread_cond_t cb_cv;                       /* reclaimer sleeps on it, CLOCK_MONOTONIC */
+    pthread_cond_t cb_room_cv;                  /* callers over the pending limit sleep on it */
+    th_rcu_head_t *cb_head;
+    th_rcu_head_t **cb_tail;
+    uint32_t cb_queued;                         /* callbacks not yet taken by reclaimer */
+    uint32_t cb_pending;                        /* callbacks not yet run, bounded by max_pending */
+    uint32_t max_pending;
+    bool stop;
+    struct thread_ *reclaim_thread;
+}th_rcu_t;
+
+/* read rcu protected pointer inside read side section */
+#define TH_RCU_DEREFERENCE(ptr)             __atomic_load_n(&(ptr), __ATOMIC_CONSUME)
+/* publish fully initialised node to readers */
+#define TH_RCU_ASSIGN_POINTER(ptr, value)   __atomic_store_n(&(ptr), (value), __ATOMIC_RELEASE)
+
+/**
+ * @brief   initiate rcu domain and start its reclaimer thread
+ *
+ * @param rcu
+ * @param flavor
+ * @param max_pending - th_rcu_call() callbacks not yet run before callers wait, bounds memory held
+ */
+void th_rcu_init(th_rcu_t *rcu, th_rcu_flavor_t flavor, uint32_t max_pending);
+
+/**
+ * @brief   run pending callbacks and stop reclaimer thread
+ *
+ * @param rcu
+ */
+void th_rcu_destroy(th_rcu_t *rcu);
+
+/**
+ * @brief   register calling thread as reader, QSBR readers start online
+ *
+ * @param rcu
+ * @param reader
+ */
+void th_rcu_register_reader(th_rcu_t *rcu, th_rcu_reader_t *reader);
+
+/**
+ * @brief   unregister reader, it must be outside read side
+ *
+ * @param reader
+ */
+void th_rcu_unregister_reader(th_rcu_reader_t *reader);
+
+/**
+ * @brief   wait until every read side section in progress at call time is over
+ *
+ * @note    caller must be outside read side, pass its QSBR reader so it goes offline meanwhile,
+ *          an online QSBR reader not passed here waits for itself forever
+ *
+ * @param rcu
+ * @param reader - calling thread reader, NULL if none
+ */
+void th_rcu_synchronize(th_rcu_t *rcu, th_rcu_reader_t *reader);
+
+/**
+ * @brief   run func(head) on reclaimer thread after a grace period, callbacks are batched
+ *          so one grace period serves many of them
+ *
+ * @note    once max_pending callbacks wait, caller blocks until reclaimer catches up.
+ *          caller must be outside read side, pass its QSBR reader so it goes offline meanwhile
+ *
+ * @param rcu
+ * @param reader - calling thread reader, NULL if none
+ * @param head
+ * @param func
+ */
+void th_rcu_call(th_rcu_t *rcu, th_rcu_reader_t *reader, th_rcu_head_t *head,
+        void (*func)(th_rcu_head_t *head));
+
+/**
+ * @brief   enter read side section, nestable.
+ *          QSBR: nothing. epoch: one store to reader own cache line and a fence
+ *
+ * @param reader
+ */
+static inline void th_rcu_read_lock(th_rcu_reader_t *reader)
+{
+    if(reader->nesting++ == 0 && reader->rcu->flavor == TH_RCU_EPOCH)
+    {
+        atomic_store_explicit(&reader->ctr,
+                atomic_load_explicit(&reader->rcu->gp_ctr, memory_order_relaxed), memory_order_relaxed);
+        /* counter visible before any read side load, pairs with fence in th_rcu_synchronize() */
+        atomic_thread_fence(memory_order_seq_cst);
+    }
+}
+
+/**
+ * @brief   leave read side section
+ *
+ * @param reader
+ */
+static inline void th_rcu_read_unlock(th_rcu_reader_t *reader)
+{
+    if(--reader->nesting == 0 && reader->rcu->flavor == TH_RCU_EPOCH)
+    {
+        atomic_store_explicit(&reader->ctr, TH_RCU_OFFLINE, memory_order_release);
+    }
+}
+
+/**
+ * @brief   QSBR reader holds no rcu protected pointer, two loads when no grace period waits
+ *
+ * @param reader
+ */
+static inline void th_rcu_quiescent_state(th_rcu_reader_t *reader)
+{
+    uint64_t gp = atomic_load_explicit(&reader->rcu->gp_ctr, memory_order_relaxed);
+
+    if(reader->rcu->flavor != TH_RCU_QSBR ||
+       atomic_load_explicit(&reader->ctr, memory_order_relaxed) == gp)
+    {
+        return;
+    }
+    /* read side loads done before announcement, next ones after it */
+    atomic_thread_fence(memory_order_seq_cst);
+    atomic_store_explicit(&reader->ctr, gp, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+/**
+ * @brief   QSBR reader stops reading for a while (e.g. before blocking), grace periods stop waiting for it
+ *
+ * @param reader
+ */
+static inline void th_rcu_thread_offline(th_rcu_reader_t *reader)
+{
+    if(reader->rcu->flavor == TH_RCU_QSBR)
+    {
+        atomic_thread_fence(memory_order_seq_cst);
+        atomic_store_explicit(&reader->ctr, TH_RCU_OFFLINE, memory_order_release);
+    }
+}
+
+/**
+ * @brief   QSBR reader reads again
+ *
+ * @param reader
+ */
+static inline void th_rcu_thread_online(th_rcu_reader_t *reader)
+{
+    if(reader->rcu->flavor == TH_RCU_QSBR)
+    {
+        atomic_store_explicit(&reader->ctr,
+                atomic_load_explicit(&reader->rcu->gp_ctr, memory_order_relaxed), memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+    }
+}
+
+#endif /* __TH_RCU__ */
@@ -0,0 +1,209 @@
+/**
+ * @file th_ring.c
+ * @author agent
+ * @brief  This file implements ring buffer setup and blocking enqueue / dequeue
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "th_ring.h"
+#include <stdlib.h>
+#include <sched.h>
+#include <assert.h>
+
+/*********** private helper functions BEGIN **********/
+
+/**
+ * @brief   smallest power of two >= value
+ *
+ * @param value
+ * @return uint32_t
+ */
+static uint32_t th_ring_round_up(uint32_t value)
+{
+    uint32_t capacity = 1;
+
+    while(capacity < value)
+    {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+/**
+ * @brief   yield cpu a few rounds until *word != value, a producer preempted between
+ *          claim and fill usually finishes meanwhile
+ *
+ * @param word
+ * @param value
+ * @return true - word changed while yielding
+ */
+static bool th_mpsc_ring_yield_while_equal(_Atomic uint32_t *word, uint32_t value)
+{
+    for(uint32_t i = 0; i < TH_PARK_YIELD_COUNT; i++)
+    {
+        sched_yield();
+        if(atomic_load_explicit(word, memory_order_acquire) != value)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief   MPSC consumer waits until head slot is filled, spin then sleep on slot sequence
+ *
+ * @param ring
+ * @param head
+ */
+static void th_mpsc_ring_wait_filled(th_mpsc_ring_t *ring, uint32_t head)
+{
+    th_mpsc_slot_t *slot = &ring->slots[head & ring->mask];
+    uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    uint64_t start_ns;
+
+    if(seq == head + 1)
+    {
+        return;
+    }
+
+    start_ns = th_now_ns();
+    if(!th_spin_wait_while_equal(&slot->seq, seq, &ring->consumer_budget) &&
+       !th_mpsc_ring_yield_while_equal(&slot->seq, seq))
+    {
+        /* flag store then seq load, producers store seq then load flag */
+        atomic_store(&ring->consumer_sleeping, 1);
+        while((seq = atomic_load(&slot->seq)) != head + 1)
+        {
+            th_futex_wait(&slot->seq, seq);
+        }
+        atomic_store_explicit(&ring->consumer_sleeping, 0, memory_order_relaxed);
+    }
+    th_spin_budget_update(&ring->consumer_budget, th_now_ns() - start_ns);
+}
+
+/*********** private helper functions END ***********/
+
+void th_spsc_ring_init(th_spsc_ring_t *ring, uint32_t capacity, bool blocking)
+{
+    ring->capacity = th_ring_round_up(capacity ? capacity : 1);
+    ring->mask = ring->capacity - 1;
+    ring->blocking = blocking;
+    ring->slots = aligned_alloc(TH_CACHE_LINE_SIZE,
+            ((sizeof(void *) * ring->capacity + TH_CACHE_LINE_SIZE - 1) / TH_CACHE_LINE_SIZE) * TH_CACHE_LINE_SIZE);
+
+    th_wait_word_init(&ring->head, 0);
+    ring->tail_cache = 0;
+    th_spin_budget_init(&ring->consumer_budget);
+    th_wait_word_init(&ring->tail, 0);
+    ring->head_cache = 0;
+    th_spin_budget_init(&ring->producer_budget);
+}
+
+void th_spsc_ring_destroy(th_spsc_ring_t *ring)
+{
+    free(ring->slots);
+    ring->slots = NULL;
+}
+
+void th_spsc_ring_enqueue_wait(th_spsc_ring_t *ring, void **msgs, uint32_t count)
+{
+    uint32_t done, tail;
+
+    assert(ring->blocking);
+    for(;;)
+    {
+        done = th_spsc_ring_enqueue_batch(ring, msgs, count);
+        msgs += done;
+        count -= done;
+        if(count == 0)
+        {
+            return;
+        }
+        if(done == 0)
+        {
+            /* full, wait for consumer to free one slot */
+            tail = atomic_load_explicit(&ring->tail.value, memory_order_relaxed);
+            th_wait_word_wait_until(&ring->head, tail + 1 - ring->capacity, &ring->producer_budget);
+        }
+    }
+}
+
+uint32_t th_spsc_ring_dequeue_wait(th_spsc_ring_t *ring, void **msgs, uint32_t max)
+{
+    uint32_t done, head;
+
+    assert(ring->blocking);
+    while((done = th_spsc_ring_dequeue_batch(ring, msgs, max)) == 0)
+    {
+        head = atomic_load_explicit(&ring->head.value, memory_order_relaxed);
+        th_wait_word_wait_until(&ring->tail, head + 1, &ring->consumer_budget);
+    }
+    return done;
+}
+
+void th_mpsc_ring_init(th_mpsc_ring_t *ring, uint32_t capacity, bool blocking)
+{
+    ring->capacity = th_ring_round_up(capacity ? capacity : 1);
+    ring->mask = ring->capacity - 1;
+    ring->blocking = blocking;
+    ring->slots = aligned_alloc(TH_CACHE_LINE_SIZE,
+            ((sizeof(th_mpsc_slot_t) * ring->capacity + TH_CACHE_LINE_SIZE - 1) / TH_CACHE_LINE_SIZE) * TH_CACHE_LINE_SIZE);
+    for(uint32_t i = 0; i < ring->capacity; i++)
+    {
+        /* free for producer of index i */
+        atomic_init(&ring->slots[i].seq, i);
+        ring->slots[i].msg = NULL;
+    }
+
+    atomic_init(&ring->tail, 0);
+    th_spin_budget_init(&ring->producer_budget);
+    th_wait_word_init(&ring->head, 0);
+    atomic_init(&ring->consumer_sleeping, 0);
+    th_spin_budget_init(&ring->consumer_budget);
+}
+
+void th_mpsc_ring_destroy(th_mpsc_ring_t *ring)
+{
+    free(ring->slots);
+    ring->slots = NULL;
+}
+
+void th_mpsc_ring_enqueue_wait(th_mpsc_ring_t *ring, void **msgs, uint32_t count)
+{
+    uint32_t done, tail;
+
+    assert(ring->blocking);
+    for(;;)
+    {
+        done = th_mpsc_ring_enqueue_batch(ring, msgs, count);
+        msgs += done;
+        count -= done;
+        if(count == 0)
+        {
+            return;
+        }
+        if(done == 0)
+        {
+            /* full at our view of tail, other producers may claim the freed slot first, then retry */
+            tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+            th_wait_word_wait_until(&ring->head, tail + 1 - ring->capacity, &ring->producer_budget);
+        }
+    }
+}
+
+uint32_t th_mpsc_ring_dequeue_wait(th_mpsc_ring_t *ring, void **msgs, uint32_t max)
+{
+    uint32_t done;
+
+    assert(ring->blocking);
+    while((done = th_mpsc_ring_dequeue_batch(ring, msgs, max)) == 0)
+    {
+        th_mpsc_ring_wait_filled(ring, atomic_load_explicit(&ring->head.value, memory_order_relaxed));
+    }
+    return done;
+}
@@ -0,0 +1,347 @@
+/**
+ * @file th_ring.h
+ * @author agent
+ * @brief  This file defines bounded lock-free ring buffers of pointers for producer / consumer hand-off:
+ *         SPSC ring, one producer and one consumer, each keeps a cached copy of the other index
+ *         and reads the shared one only when the cache says full / empty.
+ *         MPSC ring, many producers claim slots with one compare exchange on the tail, each slot
+ *         carries a sequence number that tells the consumer it is filled and producers it is free.
+ *         both move batches, and block on futex when created blocking
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __TH_RING__
+#define __TH_RING__
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "th_park.h"
+#include "th_telemetry.h"
+
+/**
+ * @brief   single producer single consumer ring, wait-free
+ *
+ * @note    indexes run freely and wrap around, slot is index & mask.
+ *          each index lives on its owner cache line with the cached copy of the other index,
+ *          so in steady state producer and consumer only share the slots themselves
+ *
+ */
+typedef struct th_spsc_ring_
+{
+    /* consumer line */
+    _Alignas(TH_CACHE_LINE_SIZE) th_wait_word_t head;     /* next slot to read, futex word blocked producer sleeps on */
+    uint32_t tail_cache;                        /* consumer copy of tail */
+    th_spin_budget_t consumer_budget;
+
+    /* producer line */
+    _Alignas(TH_CACHE_LINE_SIZE) th_wait_word_t tail;     /* next slot to write, futex word blocked consumer sleeps on */
+    uint32_t head_cache;                        /* producer copy of head */
+    th_spin_budget_t producer_budget;
+
+    /* read only after init */
+    _Alignas(TH_CACHE_LINE_SIZE) uint32_t mask;
+    uint32_t capacity;
+    bool blocking;                              /* index updates wake sleepers */
+    void **slots;
+}th_spsc_ring_t;
+
+/* MPSC slot, sequence == index when free for producer of index, index + 1 once filled */
+typedef struct th_mpsc_slot_
+{
+    _Atomic uint32_t seq;                       /* futex word blocked consumer sleeps on */
+    void *msg;
+}th_mpsc_slot_t;
+
+/**
+ * @brief   multi producer single consumer ring, bounded (Vyukov style per slot sequence numbers)
+ *
+ */
+typedef struct th_mpsc_ring_
+{
+    /* producers line */
+    _Alignas(TH_CACHE_LINE_SIZE) _Atomic uint32_t tail;   /* next index to claim */
+    th_spin_budget_t producer_budget;
+
+    /* consumer line */
+    _Alignas(TH_CACHE_LINE_SIZE) th_wait_word_t head;     /* next index to read, futex word blocked producers sleep on */
+    _Atomic uint32_t consumer_sleeping;         /* consumer sleeps on seq of head slot */
+    th_spin_budget_t consumer_budget;
+
+    /* read only after init */
+    _Alignas(TH_CACHE_LINE_SIZE) uint32_t mask;
+    uint32_t capacity;
+    bool blocking;
+    th_mpsc_slot_t *slots;
+}th_mpsc_ring_t;
+
+/**
+ * @brief   initiate SPSC ring
+ *
+ * @param ring
+ * @param capacity - rounded up to a power of two
+ * @param blocking - true to allow the *_wait() calls, index updates then check for sleepers
+ */
+void th_spsc_ring_init(th_spsc_ring_t *ring, uint32_t capacity, bool blocking);
+
+/**
+ * @brief   free ring slots, queued messages are dropped
+ *
+ * @param ring
+ */
+void th_spsc_ring_destroy(th_spsc_ring_t *ring);
+
+/**
+ * @brief   enqueue all of msgs, sleep while ring is full (blocking ring only)
+ *
+ * @param ring
+ * @param msgs
+ * @param count
+ */
+void th_spsc_ring_enqueue_wait(th_spsc_ring_t *ring, void **msgs, uint32_t count);
+
+/**
+ * @brief   dequeue at least one message, sleep while ring is empty (blocking ring only)
+ *
+ * @param ring
+ * @param msgs
+ * @param max
+ * @return uint32_t - messages dequeued, 1 .. max
+ */
+uint32_t th_spsc_ring_dequeue_wait(th_spsc_ring_t *ring, void **msgs, uint32_t max);
+
+/**
+ * @brief   initiate MPSC ring
+ *
+ * @param ring
+ * @param capacity - rounded up to a power of two
+ * @param blocking - true to allow the *_wait() calls
+ */
+void th_mpsc_ring_init(th_mpsc_ring_t *ring, uint32_t capacity, bool blocking);
+
+/**
+ * @brief   free ring slots, queued messages are dropped
+ *
+ * @param ring
+ */
+void th_mpsc_ring_destroy(th_mpsc_ring_t *ring);
+
+/**
+ * @brief   enqueue all of msgs, sleep while ring is full (blocking ring only),
+ *          messages of one call may interleave with other producers ones
+ *
+ * @param ring
+ * @param msgs
+ * @param count
+ */
+void th_mpsc_ring_enqueue_wait(th_mpsc_ring_t *ring, void **msgs, uint32_t count);
+
+/**
+ * @brief   dequeue at least one message, sleep while ring is empty (blocking ring only)
+ *
+ * @param ring
+ * @param msgs
+ * @param max
+ * @return uint32_t - messages dequeued, 1 .. max
+ */
+uint32_t th_mpsc_ring_dequeue_wait(th_mpsc_ring_t *ring, void **msgs, uint32_t max);
+
+/*********** SPSC fast path, inline **********/
+
+/**
+ * @brief   publish new index of ring side, wakeup other side only on blocking rings
+ *
+ * @param word
+ * @param value
+ * @param blocking
+ */
+static inline void th_ring_publish(th_wait_word_t *word, uint32_t value, bool blocking)
+{
+    if(blocking)
+    {
+        th_wait_word_store(word, value);
+    }
+    else
+    {
+        atomic_store_explicit(&word->value, value, memory_order_release);
+    }
+}
+
+/**
+ * @brief   enqueue up to count messages, producer side only
+ *
+ * @param ring
+ * @param msgs
+ * @param count
+ * @return uint32_t - messages enqueued, 0 when ring is full
+ */
+static inline uint32_t th_spsc_ring_enqueue_batch(th_spsc_ring_t *ring, void **msgs, uint32_t count)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail.value, memory_order_relaxed);
+    uint32_t room = ring->capacity - (tail - ring->head_cache);
+
+    if(room < count)
+    {
+        /* cache says full, look at consumer index */
+        ring->head_cache = atomic_load_explicit(&ring->head.value, memory_order_acquire);
+        room = ring->capacity - (tail - ring->head_cache);
+        count = count < room ? count : room;
+        if(count == 0)
+        {
+            return 0;
+        }
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        ring->slots[(tail + i) & ring->mask] = msgs[i];
+    }
+    th_ring_publish(&ring->tail, tail + count, ring->blocking);
+    return count;
+}
+
+/**
+ * @brief   dequeue up to max messages, consumer side only
+ *
+ * @param ring
+ * @param msgs
+ * @param max
+ * @return uint32_t - messages dequeued, 0 when ring is empty
+ */
+static inline uint32_t th_spsc_ring_dequeue_batch(th_spsc_ring_t *ring, void **msgs, uint32_t max)
+{
+    uint32_t head = atomic_load_explicit(&ring->head.value, memory_order_relaxed);
+    uint32_t ready = ring->tail_cache - head;
+    uint32_t count;
+
+    if(ready < max)
+    {
+        /* cache says empty or short, look at producer index */
+        ring->tail_cache = atomic_load_explicit(&ring->tail.value, memory_order_acquire);
+        ready = ring->tail_cache - head;
+        if(ready == 0)
+        {
+            return 0;
+        }
+    }
+
+    count = max < ready ? max : ready;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        msgs[i] = ring->slots[(head + i) & ring->mask];
+    }
+    th_ring_publish(&ring->head, head + count, ring->blocking);
+    return count;
+}
+
+static inline bool th_spsc_ring_enqueue(th_spsc_ring_t *ring, void *msg)
+{
+    return th_spsc_ring_enqueue_batch(ring, &msg, 1) == 1;
+}
+
+static inline bool th_spsc_ring_dequeue(th_spsc_ring_t *ring, void **msg)
+{
+    return th_spsc_ring_dequeue_batch(ring, msg, 1) == 1;
+}
+
+/*********** MPSC fast path, inline **********/
+
+/**
+ * @brief   enqueue up to count messages in consecutive slots, any thread
+ *
+ * @note    a claim covers only slots the consumer already freed (head ahead enough), so
+ *          the slots can be filled right away, each one is published by its sequence number
+ *
+ * @param ring
+ * @param msgs
+ * @param count
+ * @return uint32_t - messages enqueued, 0 when ring is full
+ */
+static inline uint32_t th_mpsc_ring_enqueue_batch(th_mpsc_ring_t *ring, void **msgs, uint32_t count)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t room;
+    th_mpsc_slot_t *slot;
+
+    do
+    {
+        room = ring->capacity - (tail - atomic_load_explicit(&ring->head.value, memory_order_acquire));
+        if((int32_t)room <= 0)
+        {
+            return 0;
+        }
+        count = count < room ? count : room;
+    } while(!atomic_compare_exchange_weak_explicit(&ring->tail, &tail, tail + count,
+                memory_order_relaxed, memory_order_relaxed));
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        slot = &ring->slots[(tail + i) & ring->mask];
+        slot->msg = msgs[i];
+        if(ring->blocking)
+        {
+            /* seq store then sleeping flag load, consumer does the reverse, one sees the other */
+            atomic_store(&slot->seq, tail + i + 1);
+            if(atomic_load(&ring->consumer_sleeping) != 0)
+            {
+                th_futex_wake(&slot->seq, 1);
+            }
+        }
+        else
+        {
+            atomic_store_explicit(&slot->seq, tail + i + 1, memory_order_release);
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief   dequeue up to max messages in order, consumer side only
+ *
+ * @note    stops at the first slot not filled yet, even if later ones are
+ *
+ * @param ring
+ * @param msgs
+ * @param max
+ * @return uint32_t - messages dequeued, 0 when ring is empty
+ */
+static inline uint32_t th_mpsc_ring_dequeue_batch(th_mpsc_ring_t *ring, void **msgs, uint32_t max)
+{
+    uint32_t head = atomic_load_explicit(&ring->head.value, memory_order_relaxed);
+    uint32_t count;
+    th_mpsc_slot_t *slot;
+
+    for(count = 0; count < max; count++)
+    {
+        slot = &ring->slots[(head + count) & ring->mask];
+        if(atomic_load_explicit(&slot->seq, memory_order_acquire) != head + count + 1)
+        {
+            break;
+        }
+        msgs[count] = slot->msg;
+        /* free for producer of the index one lap later */
+        atomic_store_explicit(&slot->seq, head + count + ring->capacity, memory_order_relaxed);
+    }
+    if(count != 0)
+    {
+        /* release orders the slot reads and frees before producers see room */
+        th_ring_publish(&ring->head, head + count, ring->blocking);
+    }
+    return count;
+}
+
+static inline bool th_mpsc_ring_enqueue(th_mpsc_ring_t *ring, void *msg)
+{
+    return th_mpsc_ring_enqueue_batch(ring, &msg, 1) == 1;
+}
+
+static inline bool th_mpsc_ring_dequeue(th_mpsc_ring_t *ring, void **msg)
+{
+    return th_mpsc_ring_dequeue_batch(ring, msg, 1) == 1;
+}
+
+#endif /* __TH_RING__ */
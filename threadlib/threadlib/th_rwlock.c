@@ -0,0 +1,244 @@
+/**
+ * @file th_rwlock.c
+ * @author agent
+ * @brief  This file implements big-reader lock
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "th_rwlock.h"
+#include <sched.h>
+
+/* next reader slot handed to a thread on its first read lock */
+static _Atomic uint32_t th_rwlock_next_slot = 0;
+static __thread uint32_t th_rwlock_slot_tls = UINT32_MAX;
+
+/*********** private helper functions BEGIN **********/
+
+/**
+ * @brief   reader slot of calling thread, same index for every lock
+ *
+ * @return uint32_t
+ */
+static inline uint32_t th_rwlock_slot_index(void)
+{
+    if(th_rwlock_slot_tls == UINT32_MAX)
+    {
+        th_rwlock_slot_tls = atomic_fetch_add_explicit(&th_rwlock_next_slot, 1, memory_order_relaxed) &
+                             (TH_RWLOCK_READER_SLOTS - 1);
+    }
+    return th_rwlock_slot_tls;
+}
+
+/**
+ * @brief   drop reader mark, wakeup writer waiting for the slot to drain
+ *
+ * @note    slot decrement then sleeping flag load, flag store then slot load,
+ *          both sequentially consistent so one of them sees the other.
+ *          a writer still yielding is not woken, so a reader preferring lock with a
+ *          pending writer costs readers no syscall
+ *
+ * @param lock
+ * @param slot
+ */
+static inline void th_rwlock_reader_leave(th_rwlock_t *lock, th_rwlock_slot_t *slot)
+{
+    if(atomic_fetch_sub(&slot->readers, 1) == 1 &&
+       atomic_load(&lock->writer_sleeping) != 0)
+    {
+        th_futex_wake(&slot->readers, 1);
+    }
+}
+
+/**
+ * @brief   backed off reader got in, count it off the turn readers have before next writer
+ *
+ * @param lock
+ */
+static void th_rwlock_reader_take_turn(th_rwlock_t *lock)
+{
+    uint32_t turn = atomic_load(&lock->reader_turn);
+
+    while(turn != 0 && !atomic_compare_exchange_weak(&lock->reader_turn, &turn, turn - 1));
+    if(turn == 1)
+    {
+        th_futex_wake(&lock->reader_turn, 1);
+    }
+}
+
+/**
+ * @brief   wakeup readers backed off by writer, a load when none did
+ *
+ * @param lock
+ */
+static inline void th_rwlock_wake_readers(th_rwlock_t *lock)
+{
+    if(atomic_load(&lock->readers_waiting) != 0)
+    {
+        th_futex_wake(&lock->writer, INT32_MAX);
+    }
+}
+
+/**
+ * @brief   first slot still holding readers
+ *
+ * @param lock
+ * @param from - first slot to look at
+ * @return uint32_t - slot index, TH_RWLOCK_READER_SLOTS if all drained
+ */
+static uint32_t th_rwlock_busy_slot(th_rwlock_t *lock, uint32_t from)
+{
+    for(; from < TH_RWLOCK_READER_SLOTS; from++)
+    {
+        if(atomic_load(&lock->slots[from].readers) != 0)
+        {
+            break;
+        }
+    }
+    return from;
+}
+
+/**
+ * @brief   writer waits until slot has no reader, yield a few rounds then sleep on slot
+ *
+ * @param lock
+ * @param index
+ */
+static void th_rwlock_wait_slot(th_rwlock_t *lock, uint32_t index)
+{
+    _Atomic uint32_t *readers = &lock->slots[index].readers;
+    uint32_t count;
+
+    for(uint32_t i = 0; i < TH_PARK_YIELD_COUNT; i++)
+    {
+        if(atomic_load(readers) == 0)
+        {
+            return;
+        }
+        sched_yield();
+    }
+
+    /* readers wake writer only when slot drops to zero */
+    atomic_store(&lock->writer_sleeping, 1);
+    while((count = atomic_load(readers)) != 0)
+    {
+        th_futex_wait(readers, count);
+    }
+    atomic_store(&lock->writer_sleeping, 0);
+}
+
+/*********** private helper functions END ***********/
+
+void th_rwlock_init(th_rwlock_t *lock, th_rwlock_pref_t pref, bool anti_starvation)
+{
+    for(uint32_t i = 0; i < TH_RWLOCK_READER_SLOTS; i++)
+    {
+        atomic_init(&lock->slots[i].readers, 0);
+    }
+    atomic_init(&lock->writer, TH_RWLOCK_FREE);
+    lock->pref = pref;
+    lock->anti_starvation = anti_starvation;
+    th_byte_lock_init(&lock->writer_lock);
+    atomic_init(&lock->writer_sleeping, 0);
+    th_spin_budget_init(&lock->writer_budget);
+    atomic_init(&lock->readers_waiting, 0);
+    atomic_init(&lock->reader_turn, 0);
+    th_spin_budget_init(&lock->reader_budget);
+}
+
+void th_rwlock_rdlock(th_rwlock_t *lock)
+{
+    th_rwlock_slot_t *slot = &lock->slots[th_rwlock_slot_index()];
+    bool waited = false;
+
+    for(;;)
+    {
+        atomic_fetch_add(&slot->readers, 1);
+        if(atomic_load(&lock->writer) != TH_RWLOCK_WRITER_ACTIVE)
+        {
+            break;
+        }
+
+        /* door closed, back off until writer is done */
+        th_rwlock_reader_leave(lock, slot);
+        if(!waited)
+        {
+            /* counted before sleeping, writer stores its new state before reading the count */
+            atomic_fetch_add(&lock->readers_waiting, 1);
+            waited = true;
+        }
+        th_futex_wait_while_equal(&lock->writer, TH_RWLOCK_WRITER_ACTIVE, &lock->reader_budget);
+    }
+
+    if(waited)
+    {
+        atomic_fetch_sub(&lock->readers_waiting, 1);
+        th_rwlock_reader_take_turn(lock);
+    }
+}
+
+void th_rwlock_rdunlock(th_rwlock_t *lock)
+{
+    th_rwlock_reader_leave(lock, &lock->slots[th_rwlock_slot_index()]);
+}
+
+void th_rwlock_wrlock(th_rwlock_t *lock)
+{
+    uint32_t rounds = 0;
+    uint32_t busy;
+    uint32_t turn;
+
+    th_byte_lock_lock(&lock->writer_lock);
+
+    /* readers backed off by previous writer go first */
+    while((turn = atomic_load(&lock->reader_turn)) != 0)
+    {
+        th_futex_wait_while_equal(&lock->reader_turn, turn, &lock->writer_budget);
+    }
+
+    for(;;)
+    {
+        atomic_store(&lock->writer, TH_RWLOCK_WRITER_ACTIVE);
+        busy = th_rwlock_busy_slot(lock, 0);
+        if(busy == TH_RWLOCK_READER_SLOTS)
+        {
+            return;
+        }
+
+        if(lock->pref == TH_RWLOCK_PREFER_READER &&
+           !(lock->anti_starvation && rounds >= TH_RWLOCK_WRITER_RETRIES))
+        {
+            /* reopen the door while readers drain, try again once this slot is empty */
+            atomic_store(&lock->writer, TH_RWLOCK_WRITER_PENDING);
+            th_rwlock_wake_readers(lock);
+            th_rwlock_wait_slot(lock, busy);
+            rounds++;
+            continue;
+        }
+
+        /* door stays closed, wait readers inside out */
+        for(; busy < TH_RWLOCK_READER_SLOTS; busy = th_rwlock_busy_slot(lock, busy + 1))
+        {
+            th_rwlock_wait_slot(lock, busy);
+        }
+        return;
+    }
+}
+
+void th_rwlock_wrunlock(th_rwlock_t *lock)
+{
+    uint32_t waiting = atomic_load(&lock->readers_waiting);
+
+    /* every reader counted here is still backed off, it takes its turn once in */
+    if(lock->anti_starvation && lock->pref == TH_RWLOCK_PREFER_WRITER && waiting != 0)
+    {
+        atomic_store(&lock->reader_turn, waiting);
+    }
+
+    atomic_store(&lock->writer, TH_RWLOCK_FREE);
+    th_rwlock_wake_readers(lock);
+    th_byte_lock_unlock(&lock->writer_lock);
+}
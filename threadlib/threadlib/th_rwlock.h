@@ -0,0 +1,108 @@
+/**
+ * @file th_rwlock.h
+ * @author agent
+ * @brief  This file defines big-reader lock, a reader-writer lock for read mostly data:
+ *         each reader marks itself in its own cache line padded slot, so readers never
+ *         write a shared cache line, a writer closes the door then waits for all slots to drain
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __TH_RWLOCK__
+#define __TH_RWLOCK__
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "th_park.h"
+#include "th_telemetry.h"
+#include "parking_lot.h"
+
+/* reader slots per lock, power of two, threads are spread over them round robin */
+#define TH_RWLOCK_READER_SLOTS      64
+/* reader preferring writer rounds before it stops admitting new readers (anti-starvation) */
+#define TH_RWLOCK_WRITER_RETRIES    8
+
+/* writer word states */
+#define TH_RWLOCK_FREE              0
+#define TH_RWLOCK_WRITER_PENDING    1       /* writer waits, readers still admitted */
+#define TH_RWLOCK_WRITER_ACTIVE     2       /* door closed, new readers back off */
+
+/* who goes first when readers and a writer compete */
+typedef enum th_rwlock_pref_
+{
+    TH_RWLOCK_PREFER_READER,        /* writer waits for a moment with no reader at all */
+    TH_RWLOCK_PREFER_WRITER,        /* writer closes the door to new readers at once */
+}th_rwlock_pref_t;
+
+/* reader count of one slot, on its own cache line */
+typedef struct th_rwlock_slot_
+{
+    _Alignas(TH_CACHE_LINE_SIZE) _Atomic uint32_t readers;     /* futex word, writer sleeps on it */
+}th_rwlock_slot_t;
+
+typedef struct th_rwlock_
+{
+    th_rwlock_slot_t slots[TH_RWLOCK_READER_SLOTS];
+
+    /* writer side, read by readers once per lock, written only by writers */
+    _Alignas(TH_CACHE_LINE_SIZE) _Atomic uint32_t writer;       /* TH_RWLOCK_* state, futex word readers sleep on */
+    th_rwlock_pref_t pref;
+    bool anti_starvation;
+    th_byte_lock_t writer_lock;                                 /* serialise writers */
+    _Atomic uint32_t writer_sleeping;                           /* writer sleeps on a slot, its last reader wakes it */
+    th_spin_budget_t writer_budget;
+
+    /* readers backed off by a writer */
+    _Alignas(TH_CACHE_LINE_SIZE) _Atomic uint32_t readers_waiting;
+    _Atomic uint32_t reader_turn;               /* backed off readers let in before next writer */
+    th_spin_budget_t reader_budget;
+}th_rwlock_t;
+
+/**
+ * @brief   initiate big-reader lock
+ *
+ * @note    anti-starvation bounds the wait of the side not preferred:
+ *          a reader preferring lock stops admitting new readers once a writer retried
+ *          TH_RWLOCK_WRITER_RETRIES times, a writer preferring lock lets readers backed off
+ *          by a writer in before the next writer
+ *
+ * @param lock
+ * @param pref
+ * @param anti_starvation
+ */
+void th_rwlock_init(th_rwlock_t *lock, th_rwlock_pref_t pref, bool anti_starvation);
+
+/**
+ * @brief   lock for reading, one atomic add on the reader own slot and one shared load
+ *          when no writer is around
+ *
+ * @param lock
+ */
+void th_rwlock_rdlock(th_rwlock_t *lock);
+
+/**
+ * @brief   unlock read lock, taken by same thread
+ *
+ * @param lock
+ */
+void th_rwlock_rdunlock(th_rwlock_t *lock);
+
+/**
+ * @brief   lock for writing, O(TH_RWLOCK_READER_SLOTS), writes are expected to be rare
+ *
+ * @param lock
+ */
+void th_rwlock_wrlock(th_rwlock_t *lock);
+
+/**
+ * @brief   unlock write lock
+ *
+ * @param lock
+ */
+void th_rwlock_wrunlock(th_rwlock_t *lock);
+
+#endif /* __TH_RWLOCK__ */
@@ -0,0 +1,222 @@
+/**
+ * @file th_seqlock.h
+ * @author agent
+ * @brief  This file defines sequence lock for small records read all the time and written rarely:
+ *         writers make a sequence counter odd around an update, readers copy the record
+ *         without writing anything and retry if the counter moved meanwhile
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __TH_SEQLOCK__
+#define __TH_SEQLOCK__
+
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "th_park.h"
+#include "parking_lot.h"
+
+/* reader spins on an odd counter before yielding to the (maybe preempted) writer */
+#define TH_SEQLOCK_SPIN_COUNT       100
+
+/**
+ * @note    barriers are C11 fences, the ones a seqlock needs and nothing more:
+ *          x86-64 - compiler barriers only (stores are not reordered with stores, loads with loads),
+ *          aarch64 - ldar / stlr on the counter, dmb ishld after the reader copy, dmb ish before
+ *          the writer update.
+ *          record is copied with plain loads between the barriers, a torn copy is
+ *          thrown away by the retry, so records must not hold pointers readers follow
+ *          during the copy
+ */
+
+/**
+ * @brief   sequence counter alone, for records whose writers are already serialised
+ *          (e.g. updated under an application mutex)
+ *
+ */
+typedef struct th_seqcount_
+{
+    _Atomic uint32_t seq;                       /* odd while a write is in progress */
+}th_seqcount_t;
+
+/**
+ * @brief   sequence counter with its own writer lock
+ *
+ */
+typedef struct th_seqlock_
+{
+    th_seqcount_t count;
+    th_byte_lock_t lock;                        /* serialise writers */
+}th_seqlock_t;
+
+/**
+ * @brief initiate sequence counter
+ *
+ * @param count
+ */
+static inline void th_seqcount_init(th_seqcount_t *count)
+{
+    atomic_init(&count->seq, 0);
+}
+
+/**
+ * @brief   start optimistic read, wait out a write in progress
+ *
+ * @param count
+ * @return uint32_t - sequence to hand to th_seqcount_read_retry()
+ */
+static inline uint32_t th_seqcount_read_begin(th_seqcount_t *count)
+{
+    uint32_t seq;
+    uint32_t spins = 0;
+
+    while((seq = atomic_load_explicit(&count->seq, memory_order_acquire)) & 1)
+    {
+        if(++spins < TH_SEQLOCK_SPIN_COUNT)
+        {
+            TH_CPU_RELAX();
+        }
+        else
+        {
+            sched_yield();
+        }
+    }
+    return seq;
+}
+
+/**
+ * @brief   end optimistic read
+ *
+ * @param count
+ * @param seq - th_seqcount_read_begin() result
+ * @return true - a writer ran during the read, copy is not consistent, read again
+ */
+static inline bool th_seqcount_read_retry(th_seqcount_t *count, uint32_t seq)
+{
+    /* record loads complete before counter is checked again */
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&count->seq, memory_order_relaxed) != seq;
+}
+
+/**
+ * @brief   start update, caller serialise writers
+ *
+ * @param count
+ */
+static inline void th_seqcount_write_begin(th_seqcount_t *count)
+{
+    atomic_store_explicit(&count->seq, atomic_load_explicit(&count->seq, memory_order_relaxed) + 1,
+            memory_order_relaxed);
+    /* odd counter visible before any record store */
+    atomic_thread_fence(memory_order_release);
+}
+
+/**
+ * @brief   end update
+ *
+ * @param count
+ */
+static inline void th_seqcount_write_end(th_seqcount_t *count)
+{
+    /* record stores visible before even counter */
+    atomic_store_explicit(&count->seq, atomic_load_explicit(&count->seq, memory_order_relaxed) + 1,
+            memory_order_release);
+}
+
+/**
+ * @brief initiate seqlock
+ *
+ * @param lock
+ */
+static inline void th_seqlock_init(th_seqlock_t *lock)
+{
+    th_seqcount_init(&lock->count);
+    th_byte_lock_init(&lock->lock);
+}
+
+/**
+ * @brief   th_seqcount_read_begin() on seqlock counter
+ *
+ * @param lock
+ * @return uint32_t
+ */
+static inline uint32_t th_seqlock_read_begin(th_seqlock_t *lock)
+{
+    return th_seqcount_read_begin(&lock->count);
+}
+
+/**
+ * @brief   th_seqcount_read_retry() on seqlock counter
+ *
+ * @param lock
+ * @param seq
+ * @return true - read again
+ */
+static inline bool th_seqlock_read_retry(th_seqlock_t *lock, uint32_t seq)
+{
+    return th_seqcount_read_retry(&lock->count, seq);
+}
+
+/**
+ * @brief   take writer lock and start update
+ *
+ * @param lock
+ */
+static inline void th_seqlock_write_lock(th_seqlock_t *lock)
+{
+    th_byte_lock_lock(&lock->lock);
+    th_seqcount_write_begin(&lock->count);
+}
+
+/**
+ * @brief   end update and release writer lock
+ *
+ * @param lock
+ */
+static inline void th_seqlock_write_unlock(th_seqlock_t *lock)
+{
+    th_seqcount_write_end(&lock->count);
+    th_byte_lock_unlock(&lock->lock);
+}
+
+/**
+ * typed helpers, dst and src are pointers to the same record type (checked by the assignment)
+ * e.g. TH_SEQLOCK_READ(&entry->seqlock, &copy, &entry->nexthop);
+ */
+
+/* consistent copy of *src into *dst */
+#define TH_SEQCOUNT_READ(count, dst, src)                                   \
+    do {                                                                    \
+        uint32_t _th_seq;                                                   \
+        do {                                                                \
+            _th_seq = th_seqcount_read_begin(count);                        \
+            *(dst) = *(src);                                                \
+        } while(th_seqcount_read_retry((count), _th_seq));                  \
+    } while(0)
+
+/* publish *src into *dst, caller serialise writers */
+#define TH_SEQCOUNT_WRITE(count, dst, src)                                  \
+    do {                                                                    \
+        th_seqcount_write_begin(count);                                     \
+        *(dst) = *(src);                                                    \
+        th_seqcount_write_end(count);                                       \
+    } while(0)
+
+/* consistent copy of *src into *dst */
+#define TH_SEQLOCK_READ(lock, dst, src)                                     \
+    TH_SEQCOUNT_READ(&(lock)->count, dst, src)
+
+/* publish *src into *dst under seqlock writer lock */
+#define TH_SEQLOCK_WRITE(lock, dst, src)                                    \
+    do {                                                                    \
+        th_seqlock_write_lock(lock);                                        \
+        *(dst) = *(src);                                                    \
+        th_seqlock_write_unlock(lock);                                      \
+    } while(0)
+
+#endif /* __TH_SEQLOCK__ */
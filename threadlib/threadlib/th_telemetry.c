@@ -0,0 +1,216 @@
+/**
+ * @file th_telemetry.c
+ * @author agent
+ * @brief  This file implements thread pool telemetry snapshot and report dump
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "threadlib.h"
+
+#ifdef THREADLIB_TELEMETRY
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+
+uint64_t th_histogram_bucket_low(uint32_t bucket)
+{
+    uint32_t shift;
+
+    if(bucket < TH_HIST_SUB_COUNT)
+    {
+        return bucket;
+    }
+    shift = bucket / TH_HIST_SUB_COUNT - 1;
+    return (uint64_t)(TH_HIST_SUB_COUNT + bucket % TH_HIST_SUB_COUNT) << shift;
+}
+
+void th_histogram_merge(th_histogram_t *dst, th_histogram_t *src)
+{
+    uint64_t src_max = atomic_load_explicit(&src->max, memory_order_relaxed);
+
+    for(uint32_t i = 0; i < TH_HIST_BUCKETS; i++)
+    {
+        TH_TELEMETRY_ADD(dst->count[i], atomic_load_explicit(&src->count[i], memory_order_relaxed));
+    }
+    TH_TELEMETRY_ADD(dst->total_count, atomic_load_explicit(&src->total_count, memory_order_relaxed));
+    TH_TELEMETRY_ADD(dst->total_sum, atomic_load_explicit(&src->total_sum, memory_order_relaxed));
+    if(src_max > atomic_load_explicit(&dst->max, memory_order_relaxed))
+    {
+        atomic_store_explicit(&dst->max, src_max, memory_order_relaxed);
+    }
+}
+
+uint64_t th_histogram_percentile(th_histogram_t *hist, double percentile)
+{
+    uint64_t total = 0, target, seen = 0;
+
+    /* sum buckets instead of total_count, so result is consistent with buckets read */
+    for(uint32_t i = 0; i < TH_HIST_BUCKETS; i++)
+    {
+        total += atomic_load_explicit(&hist->count[i], memory_order_relaxed);
+    }
+    if(total == 0)
+    {
+        return 0;
+    }
+
+    target = (uint64_t)((percentile / 100.0) * (double)total);
+    if(target == 0)
+    {
+        target = 1;
+    }
+
+    for(uint32_t i = 0; i < TH_HIST_BUCKETS; i++)
+    {
+        seen += atomic_load_explicit(&hist->count[i], memory_order_relaxed);
+        if(seen >= target)
+        {
+            return th_histogram_bucket_low(i);
+        }
+    }
+    return atomic_load_explicit(&hist->max, memory_order_relaxed);
+}
+
+void thread_pool_telemetry_snapshot(thread_pool_t *th_pool, th_pool_telemetry_snapshot_t *snapshot)
+{
+    thread_t *thread;
+
+    memset(snapshot, 0, sizeof(*snapshot));
+    snapshot->rejections = atomic_load_explicit(&th_pool->telemetry.rejections, memory_order_relaxed);
+    snapshot->backlogged = atomic_load_explicit(&th_pool->telemetry.backlogged, memory_order_relaxed);
+
+    /* slots are only appended, threads below thread_count are complete */
+    TH_LOCK(&th_pool->mutex);
+    snapshot->thread_count = th_pool->thread_count;
+    TH_UNLOCK(&th_pool->mutex);
+
+    for(uint32_t i = 0; i < snapshot->thread_count; i++)
+    {
+        thread = th_pool->slots[i];
+        snapshot->tasks_completed += atomic_load_explicit(&thread->telemetry->tasks_completed, memory_order_relaxed);
+        th_histogram_merge(&snapshot->queue_latency, &thread->telemetry->queue_latency);
+        th_histogram_merge(&snapshot->run_time, &thread->telemetry->run_time);
+        th_histogram_merge(&snapshot->idle_time, &thread->telemetry->idle_time);
+    }
+}
+
+/*********** private helper functions BEGIN **********/
+
+/**
+ * @brief   write one histogram summary line
+ *
+ * @param fptr
+ * @param name
+ * @param hist
+ */
+static void th_histogram_print(FILE *fptr, const char *name, th_histogram_t *hist)
+{
+    uint64_t count = atomic_load_explicit(&hist->total_count, memory_order_relaxed);
+    uint64_t sum = atomic_load_explicit(&hist->total_sum, memory_order_relaxed);
+
+    fprintf(fptr, "  %-14s count=%lu mean=%lu p50=%lu p90=%lu p99=%lu p999=%lu max=%lu (ns)\n",
+            name, (unsigned long)count, (unsigned long)(count ? sum / count : 0),
+            (unsigned long)th_histogram_percentile(hist, 50.0),
+            (unsigned long)th_histogram_percentile(hist, 90.0),
+            (unsigned long)th_histogram_percentile(hist, 99.0),
+            (unsigned long)th_histogram_percentile(hist, 99.9),
+            (unsigned long)atomic_load_explicit(&hist->max, memory_order_relaxed));
+}
+
+/**
+ * @brief   dumper thread function, write report every interval until stopped
+ *
+ * @param arg - thread_pool_t - pointer
+ * @return void*
+ */
+static void *thread_pool_telemetry_dump_fn(void *arg)
+{
+    thread_pool_t *th_pool = (thread_pool_t *) arg;
+
+    while(!atomic_load(&th_pool->telemetry.dump_stop))
+    {
+        thread_pool_telemetry_dump(th_pool, th_pool->telemetry.dump_path);
+        usleep(th_pool->telemetry.dump_interval_ms * 1000);
+    }
+    return NULL;
+}
+
+/*********** private helper functions END ***********/
+
+int thread_pool_telemetry_dump(thread_pool_t *th_pool, const char *path)
+{
+    th_pool_telemetry_snapshot_t *snapshot;
+    char tmp_path[sizeof(th_pool->telemetry.dump_path) + 8];
+    thread_t *thread;
+    FILE *fptr;
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    fptr = fopen(tmp_path, "w");
+    if(fptr == NULL)
+    {
+        return -1;
+    }
+
+    /* snapshot is large (3 histograms), keep it off the stack */
+    snapshot = calloc(1, sizeof(th_pool_telemetry_snapshot_t));
+    thread_pool_telemetry_snapshot(th_pool, snapshot);
+
+    fprintf(fptr, "pool timestamp_ns=%lu threads=%u tasks_completed=%lu rejections=%lu backlogged=%lu\n",
+            (unsigned long)th_now_ns(), snapshot->thread_count,
+            (unsigned long)snapshot->tasks_completed, (unsigned long)snapshot->rejections,
+            (unsigned long)snapshot->backlogged);
+    th_histogram_print(fptr, "queue_latency", &snapshot->queue_latency);
+    th_histogram_print(fptr, "run_time", &snapshot->run_time);
+    th_histogram_print(fptr, "idle_time", &snapshot->idle_time);
+
+    for(uint32_t i = 0; i < snapshot->thread_count; i++)
+    {
+        thread = th_pool->slots[i];
+        fprintf(fptr, "worker %u name=%s tasks_completed=%lu\n", i, thread->name,
+                (unsigned long)atomic_load_explicit(&thread->telemetry->tasks_completed, memory_order_relaxed));
+        th_histogram_print(fptr, "queue_latency", &thread->telemetry->queue_latency);
+        th_histogram_print(fptr, "run_time", &thread->telemetry->run_time);
+        th_histogram_print(fptr, "idle_time", &thread->telemetry->idle_time);
+    }
+
+    free(snapshot);
+    fclose(fptr);
+
+    /* atomic replace, monitor never read half written report */
+    return rename(tmp_path, path);
+}
+
+void thread_pool_telemetry_start_dump(thread_pool_t *th_pool, const char *path, uint32_t interval_ms)
+{
+    assert(th_pool->telemetry.dump_thread == NULL);
+
+    strncpy(th_pool->telemetry.dump_path, path, sizeof(th_pool->telemetry.dump_path) - 1);
+    th_pool->telemetry.dump_interval_ms = interval_ms;
+    atomic_store(&th_pool->telemetry.dump_stop, false);
+
+    th_pool->telemetry.dump_thread = thread_create(NULL, "telemetry_dump");
+    thread_set_thread_attribute_joinable_or_detached(th_pool->telemetry.dump_thread, true);
+    thread_run(th_pool->telemetry.dump_thread, thread_pool_telemetry_dump_fn, th_pool);
+}
+
+void thread_pool_telemetry_stop_dump(thread_pool_t *th_pool)
+{
+    if(th_pool->telemetry.dump_thread == NULL)
+    {
+        return;
+    }
+
+    atomic_store(&th_pool->telemetry.dump_stop, true);
+    pthread_join(th_pool->telemetry.dump_thread->thread, NULL);
+    free(th_pool->telemetry.dump_thread);
+    th_pool->telemetry.dump_thread = NULL;
+}
+
+#endif /* THREADLIB_TELEMETRY */
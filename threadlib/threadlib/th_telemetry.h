@@ -0,0 +1,178 @@
+/**
+ * @file th_telemetry.h
+ * @author agent
+ * @brief  This file defines thread pool telemetry data structures,
+ *         per worker counters and HDR-style (log-linear) latency histograms.
+ *         Telemetry is compiled only when THREADLIB_TELEMETRY is defined.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __TH_TELEMETRY__
+#define __TH_TELEMETRY__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <time.h>
+
+/* size of cache line, used to pad per thread data from false sharing */
+#define TH_CACHE_LINE_SIZE          64
+
+/**
+ * @brief monotonic clock in nano seconds
+ *
+ * @return uint64_t
+ */
+static inline uint64_t th_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+#ifdef THREADLIB_TELEMETRY
+
+/******************** Histogram Begin ********************/
+
+/**
+ * histogram buckets are log-linear (HDR-style):
+ * values below TH_HIST_SUB_COUNT get a bucket each, above that every power of two
+ * is split into TH_HIST_SUB_COUNT linear sub buckets, so relative error is bounded by 1/TH_HIST_SUB_COUNT
+ */
+#define TH_HIST_SUB_BITS            3
+#define TH_HIST_SUB_COUNT           (1 << TH_HIST_SUB_BITS)
+#define TH_HIST_BUCKETS             ((64 - TH_HIST_SUB_BITS + 1) * TH_HIST_SUB_COUNT)
+
+/**
+ * @brief histogram object
+ *
+ * @note  single writer (owner worker thread), any number of readers.
+ *        writer update with relaxed load/store pairs, no atomic read-modify-write
+ */
+typedef struct th_histogram_
+{
+    _Atomic uint64_t total_count;               /* number of recorded values */
+    _Atomic uint64_t total_sum;                 /* sum of recorded values */
+    _Atomic uint64_t max;                       /* max recorded value */
+    _Atomic uint64_t count[TH_HIST_BUCKETS];    /* per bucket count */
+} th_histogram_t;
+
+/**
+ * @brief map value to histogram bucket index
+ *
+ * @param value
+ * @return uint32_t
+ */
+static inline uint32_t th_histogram_bucket(uint64_t value)
+{
+    uint32_t msb;
+
+    if(value < TH_HIST_SUB_COUNT)
+    {
+        return (uint32_t)value;
+    }
+    msb = 63 - __builtin_clzll(value);
+    return (msb - TH_HIST_SUB_BITS + 1) * TH_HIST_SUB_COUNT +
+        (uint32_t)((value >> (msb - TH_HIST_SUB_BITS)) & (TH_HIST_SUB_COUNT - 1));
+}
+
+/* single writer increment, readers may observe it late but never torn */
+#define TH_TELEMETRY_ADD(counter, value)                                            \
+    atomic_store_explicit(&(counter),                                               \
+        atomic_load_explicit(&(counter), memory_order_relaxed) + (value),           \
+        memory_order_relaxed)
+
+/**
+ * @brief record value in histogram, must be called by histogram owner thread only
+ *
+ * @param hist
+ * @param value
+ */
+static inline void th_histogram_record(th_histogram_t *hist, uint64_t value)
+{
+    TH_TELEMETRY_ADD(hist->count[th_histogram_bucket(value)], 1);
+    TH_TELEMETRY_ADD(hist->total_count, 1);
+    TH_TELEMETRY_ADD(hist->total_sum, value);
+    if(value > atomic_load_explicit(&hist->max, memory_order_relaxed))
+    {
+        atomic_store_explicit(&hist->max, value, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief lowest value that maps to histogram bucket
+ *
+ * @param bucket
+ * @return uint64_t
+ */
+uint64_t th_histogram_bucket_low(uint32_t bucket);
+
+/**
+ * @brief add histogram src counts to dst (snapshot merge)
+ *
+ * @param dst
+ * @param src
+ */
+void th_histogram_merge(th_histogram_t *dst, th_histogram_t *src);
+
+/**
+ * @brief get approximate value at percentile
+ *
+ * @param hist
+ * @param percentile - [0, 100]
+ * @return uint64_t - lower bound of bucket holding the percentile
+ */
+uint64_t th_histogram_percentile(th_histogram_t *hist, double percentile);
+
+/******************** Histogram End ********************/
+
+/**
+ * @brief per worker telemetry, owned and written by worker thread only
+ *        aligned on cache line so workers never share a line
+ */
+typedef struct th_worker_telemetry_
+{
+    _Alignas(TH_CACHE_LINE_SIZE) _Atomic uint64_t tasks_completed;
+    _Atomic uint64_t enqueue_ns;                /* time task handed to worker, written by dispatcher before wakeup */
+    _Atomic uint64_t idle_since_ns;             /* time worker returned to pool, 0 if never ran */
+    th_histogram_t queue_latency;               /* enqueue to start of work (ns) */
+    th_histogram_t run_time;                    /* work function run time (ns) */
+    th_histogram_t idle_time;                   /* time spent idle in pool between tasks (ns) */
+} th_worker_telemetry_t;
+
+/**
+ * @brief per pool telemetry
+ */
+typedef struct th_pool_telemetry_
+{
+    _Alignas(TH_CACHE_LINE_SIZE) _Atomic uint64_t rejections;   /* dispatch with no idle thread, off hot path */
+    _Atomic uint64_t backlogged;                /* submit with no idle thread, queued on backlog */
+
+    /* periodic dump */
+    _Atomic bool dump_stop;
+    char dump_path[256];
+    uint32_t dump_interval_ms;
+    struct thread_ *dump_thread;
+} th_pool_telemetry_t;
+
+/**
+ * @brief pool telemetry snapshot, counters and histograms summed over workers
+ */
+typedef struct th_pool_telemetry_snapshot_
+{
+    uint32_t thread_count;
+    uint64_t tasks_completed;
+    uint64_t rejections;
+    uint64_t backlogged;
+    th_histogram_t queue_latency;
+    th_histogram_t run_time;
+    th_histogram_t idle_time;
+} th_pool_telemetry_snapshot_t;
+
+#endif /* THREADLIB_TELEMETRY */
+
+#endif /* __TH_TELEMETRY__ */
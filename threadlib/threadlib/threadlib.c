@@ -14,7 +14,52 @@
 #include "memory.h"
 #include "stdio.h"
 #include "bitsop.h"
+#include "fiber.h"
 #include <assert.h>
+#include <errno.h>
+
+/* thread pool telemetry hooks, compiled out when telemetry disabled */
+#ifdef THREADLIB_TELEMETRY
+#define TELEMETRY_TASK_DISPATCH(thread)                                                     \
+    atomic_store_explicit(&(thread)->telemetry->enqueue_ns, th_now_ns(), memory_order_relaxed)
+#define TELEMETRY_TASK_REJECT(th_pool)                                                      \
+    atomic_fetch_add_explicit(&(th_pool)->telemetry.rejections, 1, memory_order_relaxed)
+#define TELEMETRY_TASK_BACKLOG(th_pool, work)                                               \
+    (work)->enqueue_ns = th_now_ns();                                                       \
+    atomic_fetch_add_explicit(&(th_pool)->telemetry.backlogged, 1, memory_order_relaxed)
+#define TELEMETRY_BACKLOG_START(thread, work, start_ns)                                     \
+    uint64_t start_ns = thread_pool_telemetry_backlog_start(thread, (work)->enqueue_ns)
+#define TELEMETRY_TASK_START(thread, start_ns)                                              \
+    uint64_t start_ns = thread_pool_telemetry_task_start(thread)
+#define TELEMETRY_TASK_END(thread, start_ns)                                                \
+    thread_pool_telemetry_task_end(thread, start_ns)
+#define TELEMETRY_TASK_IDLE(thread)                                                         \
+    atomic_store_explicit(&(thread)->telemetry->idle_since_ns, th_now_ns(), memory_order_relaxed)
+#else
+#define TELEMETRY_TASK_DISPATCH(thread)
+#define TELEMETRY_TASK_REJECT(th_pool)
+#define TELEMETRY_TASK_BACKLOG(th_pool, work)
+#define TELEMETRY_BACKLOG_START(thread, work, start_ns)
+#define TELEMETRY_TASK_START(thread, start_ns)
+#define TELEMETRY_TASK_END(thread, start_ns)
+#define TELEMETRY_TASK_IDLE(thread)
+#endif
+
+/**
+ * @brief   initiate condition variable timed against CLOCK_MONOTONIC,
+ *          so deadlines built with th_deadline_in() are not moved by wall clock changes
+ * 
+ * @param cv 
+ */
+static void thread_cond_init_monotonic(pthread_cond_t *cv)
+{
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cv, &attr);
+    pthread_condattr_destroy(&attr);
+}
 
 thread_t *thread_create(thread_t *thread, char *name)
 {
@@ -29,22 +74,63 @@ thread_t *thread_create(thread_t *thread, char *name)
     pthread_attr_init(&thread->attributes);
     thread->thread_pause_fn = NULL;
     thread->pause_arg = NULL;
-    thread->flag = 0;
-    pthread_mutex_init(&thread->state_mutex, NULL);
-    pthread_cond_init(&thread->cv, NULL);
+    atomic_init(&thread->flag, 0);
+    th_byte_lock_init(&thread->state_lock);
+    th_byte_cond_init(&thread->cv);
+    thread->group = NULL;
+    thread->rcu_reader = NULL;
+    atomic_init(&thread->caller_parker, NULL);
+    init_glthread(&thread->wait_glue);
+    thread->wait_parker = NULL;
+    thread->pool_slot = 0;
+    atomic_init(&thread->pool_next, 0);
+    th_parker_init(&thread->parker);
+#ifdef THREADLIB_TELEMETRY
+    thread->telemetry = NULL;
+#endif
 
     return thread;
 
 }
+/* thread object of running thread */
+static __thread thread_t *thread_self_tls = NULL;
+/* thread object for threads not started by thread_run() */
+static __thread thread_t thread_foreign_tls;
+
+/**
+ * @brief   pthread start routine, record thread object then run thread function
+ * 
+ * @param arg - thread_t - pointer
+ * @return void* 
+ */
+static void *thread_start_fn(void *arg)
+{
+    thread_t *thread = (thread_t *) arg;
+
+    thread_self_tls = thread;
+    return thread->thread_fn(thread->arg);
+}
+
 void thread_run(thread_t *thread, void *(*thread_fn)(void *), void *arg)
 {
     thread->thread_fn = thread_fn;
     thread->arg = arg;
     thread->thread_created = true;
     thread->flag = THREAD_F_RUNNING;
-    pthread_create(&thread->thread, &thread->attributes, thread->thread_fn, thread->arg);
+    pthread_create(&thread->thread, &thread->attributes, thread_start_fn, thread);
 
 }
+thread_t *thread_self(void)
+{
+    if(thread_self_tls == NULL)
+    {
+        thread_self_tls = thread_create(&thread_foreign_tls, "foreign");
+        thread_self_tls->thread = pthread_self();
+        thread_self_tls->thread_created = true;
+        thread_self_tls->flag = THREAD_F_RUNNING;
+    }
+    return thread_self_tls;
+}
 void thread_set_thread_attribute_joinable_or_detached(thread_t *thread, bool joinable)
 {
     pthread_attr_setdetachstate(&thread->attributes, joinable ? PTHREAD_CREATE_JOINABLE : PTHREAD_CREATE_DETACHED);
@@ -57,89 +143,526 @@ void thread_set_pause_fn(thread_t *thread,
     thread->thread_pause_fn = thread_pause_fn;
     thread->pause_arg = pause_arg;
 }
+void thread_set_rcu_reader(thread_t *thread, th_rcu_reader_t *rcu_reader)
+{
+    thread->rcu_reader = rcu_reader;
+}
 void thread_pause(thread_t *thread)
 {
-    pthread_mutex_lock(&thread->state_mutex);
+    th_byte_lock_lock(&thread->state_lock);
     if(IS_BIT_SET(thread->flag, THREAD_F_RUNNING)) // check if thread is running at first 
     {
         SET_BIT(thread->flag, THREAD_F_MARKED_FOR_PAUSE);
     }
-    pthread_mutex_unlock(&thread->state_mutex);
+    th_byte_lock_unlock(&thread->state_lock);
 }
 void thread_resume(thread_t *thread)
 {
-    pthread_mutex_lock(&thread->state_mutex);
+    th_byte_lock_lock(&thread->state_lock);
     if(IS_BIT_SET(thread->flag, THREAD_F_PAUSED)) // check if thread pause at first 
     {
-        pthread_cond_signal(&thread->cv);
+        UNSET_BIT(thread->flag, THREAD_F_PAUSED); // unset flag
+        th_byte_cond_signal(&thread->cv);
+    }
+    th_byte_lock_unlock(&thread->state_lock);
+}
+
+/**
+ * @brief   take QSBR reader of thread offline while it is parked at a pause point
+ * 
+ * @param thread 
+ */
+static inline void thread_rcu_offline(thread_t *thread)
+{
+    if(thread->rcu_reader != NULL)
+    {
+        th_rcu_thread_offline(thread->rcu_reader);
+    }
+}
+
+/**
+ * @brief   bring QSBR reader of thread back online once resumed
+ * 
+ * @param thread 
+ */
+static inline void thread_rcu_online(thread_t *thread)
+{
+    if(thread->rcu_reader != NULL)
+    {
+        th_rcu_thread_online(thread->rcu_reader);
+    }
+}
+
+/*********** thread group helpers BEGIN **********/
+
+/**
+ * @brief   park thread group member at its safepoint until group is resumed
+ * 
+ * @note    lock order is group->mutex then thread->state_lock
+ * 
+ * @param thread 
+ */
+static void thread_group_safepoint(thread_t *thread)
+{
+    thread_group_t *group = thread->group;
+    uint32_t resume_epoch;
+
+    TH_MUTEX_LOCK(&group->mutex);
+    if(!IS_BIT_SET(thread->flag, THREAD_F_MARKED_FOR_SAFEPOINT))
+    {
+        TH_MUTEX_UNLOCK(&group->mutex);
+        return;
+    }
+
+    /**
+     * running flag is kept, a member woken by resume but not scheduled yet
+     * must still be counted by the next stop, it parks again at its next safepoint
+     */
+    th_byte_lock_lock(&thread->state_lock);
+    UNSET_BIT(thread->flag, THREAD_F_MARKED_FOR_SAFEPOINT); // unset flag
+    th_byte_lock_unlock(&thread->state_lock);
+
+    /* report parked, wait for resume broadcast */
+    resume_epoch = group->resume_epoch;
+    group->parked_count++;
+    pthread_cond_signal(&group->parked_cv);
+    thread_rcu_offline(thread);
+    while(resume_epoch == group->resume_epoch)
+    {
+        TH_COND_WAIT(&group->resume_cv, &group->mutex);
+    }
+    thread_rcu_online(thread);
+    TH_MUTEX_UNLOCK(&group->mutex);
+
+    if(thread->thread_pause_fn != NULL)
+    {
+        thread->thread_pause_fn(thread->pause_arg);
     }
-    pthread_mutex_unlock(&thread->state_mutex);
 }
+
+/*********** thread group helpers END **********/
+
 void thread_test_and_pause(thread_t *thread)
 {
+    /* pause point is a QSBR quiescent state, two loads when no grace period waits */
+    if(thread->rcu_reader != NULL)
+    {
+        th_rcu_quiescent_state(thread->rcu_reader);
+    }
+
+    /* fast path - nothing pending, one atomic load and no lock */
+    if(!IS_BIT_SET(atomic_load_explicit(&thread->flag, memory_order_acquire), THREAD_F_PAUSE_PENDING))
+    {
+        return;
+    }
+
+    /* stop-the-world request from thread group */
+    if(thread->group != NULL)
+    {
+        thread_group_safepoint(thread);
+    }
+
     /* lock */
-    pthread_mutex_lock(&thread->state_mutex);
+    th_byte_lock_lock(&thread->state_lock);
     /* test pause */
     if(IS_BIT_SET(thread->flag, THREAD_F_MARKED_FOR_PAUSE))
     {
         SET_BIT(thread->flag, THREAD_F_PAUSED); // set flag 
         UNSET_BIT(thread->flag, THREAD_F_MARKED_FOR_PAUSE); // unset flag
         UNSET_BIT(thread->flag, THREAD_F_RUNNING); // unset flag
-        pthread_cond_wait(&thread->cv, &thread->state_mutex); // thread paused
+        /* paused thread reads nothing, grace periods must not wait for its resume */
+        thread_rcu_offline(thread);
+        while(IS_BIT_SET(thread->flag, THREAD_F_PAUSED))
+        {
+            th_byte_cond_wait(&thread->cv, &thread->state_lock, NULL); // thread paused
+        }
+        thread_rcu_online(thread);
 
         /* thread wakeup (resume) here */
         SET_BIT(thread->flag, THREAD_F_RUNNING); // set flag 
-        thread->thread_pause_fn(thread->pause_arg);
+        if(thread->thread_pause_fn != NULL)
+        {
+            thread->thread_pause_fn(thread->pause_arg);
+        }
+    }
+    th_byte_lock_unlock(&thread->state_lock);
+
+}
+
+void thread_group_init(thread_group_t *group)
+{
+    group->members = NULL;
+    group->member_count = 0;
+    group->member_capacity = 0;
+    group->parked_count = 0;
+    group->resume_epoch = 0;
+    group->stopped = false;
+    pthread_mutex_init(&group->mutex, NULL);
+    TH_LOCK_PROF_NAME(&group->mutex, "thread_group_t mutex");
+    thread_cond_init_monotonic(&group->parked_cv);
+    pthread_cond_init(&group->resume_cv, NULL);
+}
+
+void thread_group_add(thread_group_t *group, thread_t *thread)
+{
+    TH_MUTEX_LOCK(&group->mutex);
+    assert(!group->stopped && thread->group == NULL);
+
+    if(group->member_count == group->member_capacity)
+    {
+        group->member_capacity = group->member_capacity ? group->member_capacity * 2 : 8;
+        group->members = realloc(group->members, group->member_capacity * sizeof(thread_t *));
+    }
+    group->members[group->member_count++] = thread;
+    thread->group = group;
+    TH_MUTEX_UNLOCK(&group->mutex);
+}
+
+void thread_group_remove(thread_group_t *group, thread_t *thread)
+{
+    TH_MUTEX_LOCK(&group->mutex);
+    assert(!group->stopped && thread->group == group);
+
+    for(uint32_t i = 0; i < group->member_count; i++)
+    {
+        if(group->members[i] == thread)
+        {
+            group->members[i] = group->members[--group->member_count];
+            break;
+        }
+    }
+    thread->group = NULL;
+    TH_MUTEX_UNLOCK(&group->mutex);
+}
+
+uint32_t thread_group_pause_all(thread_group_t *group)
+{
+    uint32_t parked_count = 0;
+
+    thread_group_pause_all_until(group, NULL, &parked_count);
+    return parked_count;
+}
+int thread_group_pause_all_until(thread_group_t *group, const struct timespec *deadline,
+        uint32_t *parked_count)
+{
+    uint32_t target_count = 0;
+    thread_t *thread;
+    int rc = 0;
+
+    TH_MUTEX_LOCK(&group->mutex);
+    assert(!group->stopped);
+    group->stopped = true;
+    group->parked_count = 0;
+
+    /* mark running members, members paused on their own are already stopped */
+    for(uint32_t i = 0; i < group->member_count; i++)
+    {
+        thread = group->members[i];
+        th_byte_lock_lock(&thread->state_lock);
+        if(IS_BIT_SET(thread->flag, THREAD_F_RUNNING))
+        {
+            SET_BIT(thread->flag, THREAD_F_MARKED_FOR_SAFEPOINT);
+            target_count++;
+        }
+        th_byte_lock_unlock(&thread->state_lock);
+    }
+
+    while(group->parked_count < target_count && rc != ETIMEDOUT)
+    {
+        rc = deadline == NULL ? TH_COND_WAIT(&group->parked_cv, &group->mutex) :
+                                TH_COND_TIMEDWAIT(&group->parked_cv, &group->mutex, deadline);
+    }
+
+    if(group->parked_count < target_count)
+    {
+        /**
+         * a member blocked outside its safepoints never parks, stop fails as a whole:
+         * members checking their safepoint later see no mark, parked ones see the resume
+         */
+        for(uint32_t i = 0; i < group->member_count; i++)
+        {
+            thread = group->members[i];
+            th_byte_lock_lock(&thread->state_lock);
+            UNSET_BIT(thread->flag, THREAD_F_MARKED_FOR_SAFEPOINT);
+            th_byte_lock_unlock(&thread->state_lock);
+        }
+        group->stopped = false;
+        group->resume_epoch++;
+        pthread_cond_broadcast(&group->resume_cv);
+        group->parked_count = 0;
+        target_count = 0;
+        rc = ETIMEDOUT;
+    }
+    else
+    {
+        rc = 0;
+    }
+    TH_MUTEX_UNLOCK(&group->mutex);
+
+    if(parked_count != NULL)
+    {
+        *parked_count = target_count;
+    }
+    return rc;
+}
+
+void thread_group_resume_all(thread_group_t *group)
+{
+    TH_MUTEX_LOCK(&group->mutex);
+    assert(group->stopped);
+    group->stopped = false;
+    group->parked_count = 0;
+    group->resume_epoch++;
+    pthread_cond_broadcast(&group->resume_cv);
+    TH_MUTEX_UNLOCK(&group->mutex);
+}
+
+void thread_group_destroy(thread_group_t *group)
+{
+    assert(!group->stopped);
+
+    for(uint32_t i = 0; i < group->member_count; i++)
+    {
+        group->members[i]->group = NULL;
     }
-    pthread_mutex_unlock(&thread->state_mutex);
+    free(group->members);
+    group->members = NULL;
+    group->member_count = 0;
+    group->member_capacity = 0;
+    pthread_mutex_destroy(&group->mutex);
+    pthread_cond_destroy(&group->parked_cv);
+    pthread_cond_destroy(&group->resume_cv);
+}
+
+/*********** thread pool idle stack helpers BEGIN **********/
+
+/* top of idle stack word: version tag in upper 32 bits, slot + 1 in lower 32 bits */
+#define IDLE_TOP_SLOT(top)          ((uint32_t)(top))
+#define IDLE_TOP_TAG(top)           ((uint32_t)((top) >> 32))
+#define IDLE_TOP_MAKE(tag, slot)    (((uint64_t)(tag) << 32) | (uint32_t)(slot))
+
+/**
+ * @brief   push thread on pool idle stack
+ * 
+ * @note    lock-free, each successful CAS bumps the version tag
+ * 
+ * @param th_pool 
+ * @param thread 
+ */
+static void thread_pool_idle_push(thread_pool_t *th_pool, thread_t *thread)
+{
+    uint64_t top = atomic_load_explicit(&th_pool->idle_top, memory_order_relaxed);
+    uint64_t new_top;
+
+    do
+    {
+        /* link thread to current top */
+        atomic_store_explicit(&thread->pool_next, IDLE_TOP_SLOT(top), memory_order_relaxed);
+        new_top = IDLE_TOP_MAKE(IDLE_TOP_TAG(top) + 1, thread->pool_slot + 1);
+    } while(!atomic_compare_exchange_weak_explicit(&th_pool->idle_top, &top, new_top,
+                memory_order_release, memory_order_relaxed));
+}
+
+/**
+ * @brief   pop thread from pool idle stack
+ * 
+ * @note    lock-free, reading `pool_next` of a thread popped concurrently is safe,
+ *          pool threads are never freed and the version tag makes stale CAS fail
+ * 
+ * @param th_pool 
+ * @return thread_t* - NULL if no idle thread
+ */
+static thread_t *thread_pool_idle_pop(thread_pool_t *th_pool)
+{
+    uint64_t top = atomic_load_explicit(&th_pool->idle_top, memory_order_acquire);
+    uint64_t new_top;
+    thread_t *thread;
+
+    do
+    {
+        if(IDLE_TOP_SLOT(top) == 0)
+        {
+            return NULL;
+        }
+        thread = th_pool->slots[IDLE_TOP_SLOT(top) - 1];
+        new_top = IDLE_TOP_MAKE(IDLE_TOP_TAG(top) + 1,
+                    atomic_load_explicit(&thread->pool_next, memory_order_relaxed));
+    } while(!atomic_compare_exchange_weak_explicit(&th_pool->idle_top, &top, new_top,
+                memory_order_acquire, memory_order_acquire));
 
+    return thread;
 }
 
+/*********** thread pool idle stack helpers END **********/
+
 void thread_pool_init(thread_pool_t *th_pool)
 {
-    init_glthread(&th_pool->pool_head);
-    pthread_mutex_init(&th_pool->mutex, NULL);
+    thread_pool_init_lock(th_pool, TH_LOCK_PTHREAD);
 }
-void thread_pool_insert_new_thread(thread_pool_t *th_pool, thread_t *thread)
+void thread_pool_init_lock(thread_pool_t *th_pool, th_lock_type_t lock_type)
 {
-    pthread_mutex_lock(&th_pool->mutex);
+    atomic_init(&th_pool->idle_top, 0);
+    memset(th_pool->slots, 0, sizeof(th_pool->slots));
+    th_pool->thread_count = 0;
+    th_lock_init(&th_pool->mutex, lock_type);
+    th_lock_init(&th_pool->work_mutex, lock_type);
+    TH_LOCK_PROF_NAME(&th_pool->mutex, "thread_pool_t mutex");
+    TH_LOCK_PROF_NAME(&th_pool->work_mutex, "thread_pool_t work_mutex");
+    init_glthread_list(&th_pool->work_list);
+    atomic_init(&th_pool->work_count, 0);
+#ifdef THREADLIB_TELEMETRY
+    memset(&th_pool->telemetry, 0, sizeof(th_pool->telemetry));
+#endif
+}
+bool thread_pool_insert_new_thread(thread_pool_t *th_pool, thread_t *thread)
+{
+    TH_LOCK(&th_pool->mutex);
     /* check if thread is not in a list already */
     assert(IS_GLTHREAD_LIST_EMPTY(&thread->wait_glue));
 
     /* check if thread is assigned to job by checking thread function */
     assert(thread->thread_fn == NULL);
 
-    /* add thread */
-    glthread_add_last(&th_pool->pool_head, &thread->wait_glue);
+    /* check pool capacity, slots[] can not grow under lock-free idle stack readers */
+    if(th_pool->thread_count >= THREAD_POOL_MAX_THREADS)
+    {
+        TH_UNLOCK(&th_pool->mutex);
+        return false;
+    }
+
+#ifdef THREADLIB_TELEMETRY
+    /* worker telemetry on its own cache lines */
+    if(thread->telemetry == NULL)
+    {
+        thread->telemetry = aligned_alloc(TH_CACHE_LINE_SIZE, sizeof(th_worker_telemetry_t));
+        memset(thread->telemetry, 0, sizeof(th_worker_telemetry_t));
+    }
+#endif
 
-    pthread_mutex_unlock(&th_pool->mutex);
+    /* own thread by pool slot, then publish it on idle stack */
+    thread->pool_slot = th_pool->thread_count;
+    th_pool->slots[th_pool->thread_count++] = thread;
+    thread_pool_idle_push(th_pool, thread);
 
+    TH_UNLOCK(&th_pool->mutex);
+    return true;
 }
 thread_t *thread_pool_get_thread(thread_pool_t *th_pool)
 {
-    glthread_t *node;
-    thread_t *thread;
-    /* mutex for Critical Section */
-    pthread_mutex_lock(&th_pool->mutex);
-    
-    /* get node from data structure */
-    node = dequeue_glthread_first(&th_pool->pool_head);
-    if(node == NULL)
+    /* lock-free fetch from idle stack */
+    return thread_pool_idle_pop(th_pool);
+}
+
+/*********** private helper functions BEGIN **********/
+
+static thread_t *thread_pool_assign_thread(thread_pool_t *th_pool, void *(*thread_fn)(void*), void *arg,
+        th_parker_t *caller_parker);
+
+#ifdef THREADLIB_TELEMETRY
+/**
+ * @brief   record queue latency and idle time when worker start a task
+ * 
+ * @param thread 
+ * @return uint64_t - task start time
+ */
+static uint64_t thread_pool_telemetry_task_start(thread_t *thread)
+{
+    th_worker_telemetry_t *telemetry = thread->telemetry;
+    uint64_t now = th_now_ns();
+    uint64_t enqueue_ns = atomic_load_explicit(&telemetry->enqueue_ns, memory_order_relaxed);
+    uint64_t idle_since_ns = atomic_load_explicit(&telemetry->idle_since_ns, memory_order_relaxed);
+
+    th_histogram_record(&telemetry->queue_latency, now > enqueue_ns ? now - enqueue_ns : 0);
+    if(idle_since_ns != 0)
     {
-        pthread_mutex_unlock(&th_pool->mutex);
-        return NULL;
+        th_histogram_record(&telemetry->idle_time, enqueue_ns > idle_since_ns ? enqueue_ns - idle_since_ns : 0);
     }
-    else
+    return now;
+}
+
+/**
+ * @brief   record run time and completion when worker finish a task
+ * 
+ * @param thread 
+ * @param start_ns 
+ */
+static void thread_pool_telemetry_task_end(thread_t *thread, uint64_t start_ns)
+{
+    th_worker_telemetry_t *telemetry = thread->telemetry;
+
+    th_histogram_record(&telemetry->run_time, th_now_ns() - start_ns);
+    TH_TELEMETRY_ADD(telemetry->tasks_completed, 1);
+}
+
+/**
+ * @brief   record queue latency when worker start a backlog work,
+ *          worker is not idle in between, so no idle time
+ * 
+ * @param thread 
+ * @param enqueue_ns - time work was queued on backlog
+ * @return uint64_t - task start time
+ */
+static uint64_t thread_pool_telemetry_backlog_start(thread_t *thread, uint64_t enqueue_ns)
+{
+    uint64_t now = th_now_ns();
+
+    th_histogram_record(&thread->telemetry->queue_latency, now > enqueue_ns ? now - enqueue_ns : 0);
+    return now;
+}
+#endif
+
+/**
+ * @brief   run backlog work until backlog is empty
+ * 
+ * @param th_pool 
+ * @param thread - pool thread running the work
+ */
+static void thread_pool_drain_work(thread_pool_t *th_pool, thread_t *thread)
+{
+    glthread_t *node;
+    thread_pool_work_t *work;
+    void *(*work_fn)(void *);
+    void *arg;
+
+    /* only telemetry records per worker */
+    (void) thread;
+
+    /* a single load when backlog is empty */
+    while(atomic_load(&th_pool->work_count) != 0)
     {
-        /* transform glthread object to thread object */
-        thread = wait_glue_to_thread(node);
-        pthread_mutex_unlock(&th_pool->mutex);
-        return thread;
-    }
+        TH_LOCK(&th_pool->work_mutex);
+        node = glthread_list_dequeue_first(&th_pool->work_list);
+        if(node == NULL)
+        {
+            TH_UNLOCK(&th_pool->work_mutex);
+            return;
+        }
+        atomic_fetch_sub(&th_pool->work_count, 1);
 
+        /* copy out under lock, once dequeued the work object belongs to its submitter again */
+        work = work_glue_to_thread_pool_work(node);
+        work_fn = work->work_fn;
+        arg = work->arg;
+        TELEMETRY_BACKLOG_START(thread, work, start_ns);
+        TH_UNLOCK(&th_pool->work_mutex);
+
+        work_fn(arg);
+
+        TELEMETRY_TASK_END(thread, start_ns);
+    }
 }
 
-/*********** private helper functions BEGIN **********/
+/**
+ * @brief   thread pool work function, drain backlog
+ * 
+ * @param arg - thread_pool_t - pointer
+ * @return void* 
+ */
+static void *thread_pool_drain_work_fn(void *arg)
+{
+    thread_pool_drain_work((thread_pool_t *)arg, thread_self());
+    return NULL;
+}
 
 /**
  * @brief   this function return thread back to thread pool
@@ -148,28 +671,57 @@ thread_t *thread_pool_get_thread(thread_pool_t *th_pool)
  * 
  * @note    1. add thread back to thread pool
  *          2. notify application if requested
- *          3. block thread with cv 
+ *          3. park thread on its private parker
  * 
  * @param th_pool 
  * @param thread 
  */
 static void thread_pool_return_thread(thread_pool_t *th_pool, thread_t *thread)
 {
+    /* take application notification request before thread become visible to dispatchers,
+       a timed out dispatcher may withdraw it concurrently */
+    th_parker_t *caller_parker = atomic_exchange_explicit(&thread->caller_parker, NULL, memory_order_acq_rel);
+
+    /**
+     * caller work is done, it must not wait for unrelated backlog work. with no backlog
+     * unpark after push, so a caller dispatching again right away finds this thread idle
+     */
+    if(caller_parker != NULL && atomic_load(&th_pool->work_count) != 0)
+    {
+        th_unpark(caller_parker);
+        caller_parker = NULL;
+    }
+
+    /* run work submitted while all threads were busy */
+    thread_pool_drain_work(th_pool, thread);
+
+    TELEMETRY_TASK_IDLE(thread);
 
     /* return thread back to the pool */
-    pthread_mutex_lock(&th_pool->mutex);
-    glthread_add_next(&th_pool->pool_head, &thread->wait_glue);
+    thread_pool_idle_push(th_pool, thread);
     
     /* check if application requested for notification from worker thread */
-    if(thread->semaphore != NULL)
+    if(caller_parker != NULL)
     {
         /* notify and unblock application */
-        sem_post(thread->semaphore);
+        th_unpark(caller_parker);
+    }
+
+    /**
+     * work queued by a submitter that found no idle thread just before our push,
+     * pairs with the fence in thread_pool_submit(), one of us sees the other.
+     * we are on the idle stack already, a dispatcher may pop us and unpark our parker,
+     * so never run the work here: hand it to an idle thread, often ourselves, popped
+     * off the stack the same way any dispatch does
+     */
+    atomic_thread_fence(memory_order_seq_cst);
+    if(atomic_load(&th_pool->work_count) != 0)
+    {
+        thread_pool_assign_thread(th_pool, thread_pool_drain_work_fn, th_pool, NULL);
     }
 
-    /* block thread */
-    pthread_cond_wait(&thread->cv, &th_pool->mutex);
-    pthread_mutex_unlock(&th_pool->mutex);
+    /* spin, yield then sleep on private parker until dispatched again */
+    th_park(&thread->parker);
 }
 
 /**
@@ -184,7 +736,7 @@ static void thread_pool_return_thread(thread_pool_t *th_pool, thread_t *thread)
  */
 static void thread_pool_run_thread(thread_t *thread)
 {
-    /* check if thread not in a pool */
+    /* check if thread not queued in other list */
     assert(IS_GLTHREAD_LIST_EMPTY(&thread->wait_glue));
 
     if(!thread->thread_created)
@@ -194,8 +746,8 @@ static void thread_pool_run_thread(thread_t *thread)
     }
     else
     {
-        /* unblock thread */
-        pthread_cond_signal(&thread->cv);
+        /* unblock thread, no syscall if it is still spinning */
+        th_unpark(&thread->parker);
     }
 
 }
@@ -216,36 +768,51 @@ static void *thread_fn_work_and_return_to_thread_pool(void *arg)
     /* thread super loop routine */
     while(1)
     {
-        /* execute work assigned to thread - stage 2 */
-        thread_execution_data->thread_work_fn(thread_execution_data->arg);
+        if(thread_execution_data->thread_work_fn == thread_pool_drain_work_fn)
+        {
+            /* backlog drain records each work it runs, not itself */
+            thread_execution_data->thread_work_fn(thread_execution_data->arg);
+        }
+        else
+        {
+            TELEMETRY_TASK_START(thread_execution_data->thread, start_ns);
+
+            /* execute work assigned to thread - stage 2 */
+            thread_execution_data->thread_work_fn(thread_execution_data->arg);
+
+            TELEMETRY_TASK_END(thread_execution_data->thread, start_ns);
+        }
 
         /* return back to thread pool and block it self - stage 3 */
         thread_execution_data->thread_retrun_to_thread_pool_fn(thread_execution_data->th_pool, thread_execution_data->thread);
     }
 }
 
-/*********** private helper functions END ***********/
-
 
-void thread_pool_dispatch_thread(thread_pool_t *th_pool, void *(*thread_fn)(void*), void *arg, bool block_caller)
+/**
+ * @brief   fetch idle thread, assign work to it and run it - stage 1
+ * 
+ * @param th_pool 
+ * @param thread_fn 
+ * @param arg 
+ * @param caller_parker - parker to unpark when work is done, NULL for none
+ * @return thread_t* - thread running the work, NULL when work rejected
+ */
+static thread_t *thread_pool_assign_thread(thread_pool_t *th_pool, void *(*thread_fn)(void*), void *arg,
+        th_parker_t *caller_parker)
 {
     thread_t *thread = NULL;
     /* fetch thread from thread pool - stage 1*/
     thread = thread_pool_get_thread(th_pool);
 
-    /* no threads available in thread pool */
+    /* no threads available in thread pool, caller decide if work is rejected */
     if(thread == NULL)
     {
-        return;
+        return NULL;
     }
     
-    /* check if application block it self - use zero semaphore */
-    if(block_caller)
-    {   
-        /* application want to block it self - allocate and initiate semaphore */
-        thread->semaphore =  calloc(1, sizeof(sem_t));
-        sem_init(thread->semaphore, 0, 0); // zero semaphore 
-    }
+    /* application block it self on its parker */
+    atomic_store_explicit(&thread->caller_parker, caller_parker, memory_order_relaxed);
     /* data struct to control thread execution flow - will act as argument to thread work function */
     thread_execution_data_t *thread_execution_data = (thread_execution_data_t *) thread->arg;
     
@@ -273,101 +840,843 @@ void thread_pool_dispatch_thread(thread_pool_t *th_pool, void *(*thread_fn)(void
      */
     thread->thread_fn = thread_fn_work_and_return_to_thread_pool; 
 
+    TELEMETRY_TASK_DISPATCH(thread);
+
     /* trigger and run thread - stage 2 and stage 3 */
     thread_pool_run_thread(thread);
-
+    return thread;
+}
+
+/*********** private helper functions END ***********/
+
+
+bool thread_pool_dispatch_thread(thread_pool_t *th_pool, void *(*thread_fn)(void*), void *arg, bool block_caller)
+{
+    /* caller parker lives in thread local storage, its spin budget persists across dispatches */
+    th_parker_t *caller_parker = block_caller ? th_parker_self() : NULL;
+
+    if(thread_pool_assign_thread(th_pool, thread_fn, arg, caller_parker) == NULL)
+    {
+        TELEMETRY_TASK_REJECT(th_pool);
+        return false;
+    }
+
     if(block_caller)
     {
-        /* application block and wait for thread to finish work */
-        sem_wait(thread->semaphore);
+        /**
+         * application block and wait for thread to finish work
+         * thread may be dispatched again by the time we wakeup, so don't touch thread here,
+         * worker thread already cleared thread->caller_parker
+         */
+        th_park(caller_parker);
+    }
+    return true;
+}
+int thread_pool_dispatch_thread_until(thread_pool_t *th_pool, void *(*thread_fn)(void*), void *arg,
+        const struct timespec *deadline)
+{
+    th_parker_t *caller_parker = th_parker_self();
+    th_parker_t *expected = caller_parker;
+    thread_t *thread = thread_pool_assign_thread(th_pool, thread_fn, arg, caller_parker);
+
+    if(thread == NULL)
+    {
+        TELEMETRY_TASK_REJECT(th_pool);
+        return EAGAIN;
+    }
+
+    if(th_park_until(caller_parker, deadline) == 0)
+    {
+        return 0;
+    }
+
+    /**
+     * withdraw notification request, pool threads are never freed so thread is still valid.
+     * if worker already took it, its unpark is on the way, consume it so our next park does not
+     * return early. a redispatch of thread carries another caller parker, so compare exchange
+     * never takes it
+     */
+    if(atomic_compare_exchange_strong_explicit(&thread->caller_parker, &expected, NULL,
+                memory_order_acq_rel, memory_order_acquire))
+    {
+        return ETIMEDOUT;
+    }
+    th_park(caller_parker);
+    return 0;
+}
 
-        /* worker thread notify blocked application - destroy and free semaphore */
-        sem_destroy(thread->semaphore);
-        free(thread->semaphore);
-        thread->semaphore = NULL;
+void thread_pool_submit(thread_pool_t *th_pool, thread_pool_work_t *work)
+{
+    if(thread_pool_assign_thread(th_pool, work->work_fn, work->arg, NULL) != NULL)
+    {
+        return;
     }
+
+    /* all threads busy, queue on backlog in submit order, work is accepted not rejected */
+    init_glthread(&work->work_glue);
+    TELEMETRY_TASK_BACKLOG(th_pool, work);
+    TH_LOCK(&th_pool->work_mutex);
+    glthread_list_add_last(&th_pool->work_list, &work->work_glue);
+    atomic_fetch_add(&th_pool->work_count, 1);
+    TH_UNLOCK(&th_pool->work_mutex);
+
+    /* a worker may have gone idle after our first try, pairs with the fence in thread_pool_return_thread() */
+    atomic_thread_fence(memory_order_seq_cst);
+    thread_pool_assign_thread(th_pool, thread_pool_drain_work_fn, th_pool, NULL);
 }
 
+/* central barrier slot indexes */
+#define BARRIER_CENTRAL_RESULT      1
+#define BARRIER_CENTRAL_DEPOSIT     3
+
 void thread_barrier_init(th_barrier_t *barrier, 
                       uint32_t threshold_count)
 {
+    thread_barrier_init_type(barrier, threshold_count, THREAD_BARRIER_MUTEX);
+}
+void thread_barrier_init_type(th_barrier_t *barrier, 
+                      uint32_t threshold_count, th_barrier_type_t type)
+{
+    uint32_t slot_count = 0;
+
+    assert(threshold_count > 0);
+
     barrier->threshold_count = threshold_count;
     barrier->curr_wait_count = 0;
     barrier->is_ready_again = true;
     pthread_mutex_init(&barrier->mutex, NULL);
-    pthread_cond_init(&barrier->cv, NULL);
-    pthread_cond_init(&barrier->busy_cv, NULL);
+    TH_LOCK_PROF_NAME(&barrier->mutex, "thread_barrier_t mutex");
+    th_byte_cond_init(&barrier->cv);
+    th_byte_cond_init(&barrier->busy_cv);
+    init_glthread_list(&barrier->fiber_wait_head);
+    init_glthread_list(&barrier->fiber_busy_head);
+
+    barrier->reduce_value = 0;
+    barrier->type = type;
+    atomic_init(&barrier->ticket, 0);
+    th_spin_budget_init(&barrier->budget);
+    for(barrier->rounds = 0; (1U << barrier->rounds) < threshold_count; barrier->rounds++);
+
+    switch(type)
+    {
+        case THREAD_BARRIER_CENTRAL:
+            /* release word, result per parity, deposit per parity per thread */
+            slot_count = BARRIER_CENTRAL_DEPOSIT + 2 * threshold_count;
+            break;
+        case THREAD_BARRIER_DISSEMINATION:
+        case THREAD_BARRIER_TOURNAMENT:
+            /* per parity: flag per round per thread, then release flag / deposit per thread */
+            slot_count = 2 * (barrier->rounds + 1) * threshold_count;
+            break;
+        default:
+            break;
+    }
+
+    barrier->slots = NULL;
+    if(slot_count != 0)
+    {
+        barrier->slots = aligned_alloc(TH_CACHE_LINE_SIZE, slot_count * sizeof(th_barrier_slot_t));
+        for(uint32_t i = 0; i < slot_count; i++)
+        {
+            th_wait_word_init(&barrier->slots[i].word, 0);
+            barrier->slots[i].value = 0;
+        }
+    }
 }
 void thread_barrier_destroy(th_barrier_t *barrier)
 {
     pthread_mutex_destroy(&barrier->mutex);
-    pthread_cond_destroy(&barrier->cv);
-    pthread_cond_destroy(&barrier->busy_cv);
+    free(barrier->slots);
+    barrier->slots = NULL;
 }
-void thread_barrier_wait(th_barrier_t *barrier)
+/*********** private helper functions BEGIN **********/
+
+/**
+ * spin barrier flags are split by episode parity and count once per episode of their parity,
+ * so a waiter of episode e waits for its flag to reach e / 2 + 1.
+ * a signal of episode e + 2 can only be sent once every thread arrived in episode e + 1,
+ * so a flag (and the value stored next to it) never runs ahead of its waiter.
+ * dissemination and tournament slots: [parity][row][id], rows 0..rounds-1 are round flags,
+ * row rounds is the tournament release flag / dissemination value deposit.
+ * central slots: release word, result per parity, then value deposit per parity per id
+ * (BARRIER_CENTRAL_* indexes)
+ */
+/**
+ * @brief   dissemination / tournament slot
+ * 
+ * @param barrier 
+ * @param parity - episode parity
+ * @param row - round, or barrier->rounds for release/deposit row
+ * @param id - arrival id
+ * @return th_barrier_slot_t* 
+ */
+static inline th_barrier_slot_t *thread_barrier_slot(th_barrier_t *barrier, uint32_t parity, uint32_t row, uint32_t id)
 {
+    return &barrier->slots[(parity * (barrier->rounds + 1) + row) * barrier->threshold_count + id];
+}
+
+/**
+ * @brief   centralized sense-reversing barrier, last arrival flip the release word
+ *          when reducing, last arrival fold all deposited values and publish the result
+ * 
+ * @param barrier 
+ * @param id - arrival id in episode
+ * @param episode - episode number
+ * @param value - thread contribution, combined value on return
+ * @param reduce_fn - combine function, NULL for plain barrier
+ * @param deadline - NULL to wait forever
+ * @return int - 0, ETIMEDOUT (arrival stands)
+ */
+static int thread_barrier_wait_central(th_barrier_t *barrier, uint32_t id, uint32_t episode,
+        int64_t *value, th_reduce_fn_t reduce_fn, const struct timespec *deadline)
+{
+    uint32_t n = barrier->threshold_count;
+    uint32_t parity = episode & 1;
+    uint32_t deposit_target = (episode >> 1) + 1;
+    th_barrier_slot_t *release = &barrier->slots[0];
+    th_barrier_slot_t *result = &barrier->slots[BARRIER_CENTRAL_RESULT + parity];
+    th_barrier_slot_t *deposits = &barrier->slots[BARRIER_CENTRAL_DEPOSIT + parity * n];
+
+    if(id != n - 1)
+    {
+        if(reduce_fn != NULL)
+        {
+            deposits[id].value = *value;
+            th_wait_word_store(&deposits[id].word, deposit_target);
+        }
+        if(th_wait_word_wait_deadline(&release->word, episode + 1, &barrier->budget, deadline) != 0)
+        {
+            return ETIMEDOUT;
+        }
+        *value = result->value;
+        return 0;
+    }
+
+    /* last arrival */
+    if(reduce_fn != NULL)
+    {
+        for(uint32_t i = 0; i < n - 1; i++)
+        {
+            /* depositor took its ticket before us, its value is nearly always there already */
+            th_wait_word_wait_until(&deposits[i].word, deposit_target, &barrier->budget);
+            *value = reduce_fn(*value, deposits[i].value);
+        }
+    }
+    result->value = *value;
+    th_wait_word_add(&release->word, 1);
+    return 0;
+}
+
+/**
+ * @brief   dissemination barrier, in round r thread i signal thread (i + 2^r) mod n
+ *          and wait for thread (i - 2^r) mod n
+ * 
+ * @note    with power of two threads each signal carries the sender partial result,
+ *          after round r a thread holds the combination of 2^(r+1) values, no value counted twice.
+ *          otherwise each thread deposit its value before round 0 and fold all deposits after
+ *          the last round, when every deposit is known to be visible
+ * 
+ * @param barrier 
+ * @param id - arrival id in episode
+ * @param episode - episode number
+ * @param value - thread contribution
+ * @param reduce_fn - combine function, NULL for plain barrier
+ * @return int64_t - combined value
+ */
+static int64_t thread_barrier_wait_dissemination(th_barrier_t *barrier, uint32_t id, uint32_t episode,
+        int64_t value, th_reduce_fn_t reduce_fn)
+{
+    uint32_t n = barrier->threshold_count;
+    uint32_t parity = episode & 1;
+    uint32_t target = (episode >> 1) + 1;
+    bool carry = reduce_fn != NULL && (n & (n - 1)) == 0;
+    th_barrier_slot_t *send, *recv;
+
+    if(reduce_fn != NULL && !carry)
+    {
+        thread_barrier_slot(barrier, parity, barrier->rounds, id)->value = value;
+    }
+
+    for(uint32_t round = 0; round < barrier->rounds; round++)
+    {
+        send = thread_barrier_slot(barrier, parity, round, (id + (1U << round)) % n);
+        recv = thread_barrier_slot(barrier, parity, round, id);
+
+        send->value = value;
+        th_wait_word_add(&send->word, 1);
+        th_wait_word_wait_until(&recv->word, target, &barrier->budget);
+        if(carry)
+        {
+            value = reduce_fn(value, recv->value);
+        }
+    }
+
+    if(reduce_fn != NULL && !carry)
+    {
+        value = thread_barrier_slot(barrier, parity, barrier->rounds, id)->value;
+        for(uint32_t i = 1; i < n; i++)
+        {
+            value = reduce_fn(value, thread_barrier_slot(barrier, parity, barrier->rounds, (id + i) % n)->value);
+        }
+    }
+    return value;
+}
+
+/**
+ * @brief   tournament barrier, in round r thread i with low r + 1 bits clear wait for
+ *          thread i + 2^r (loser), champion (id 0) then wakeup losers down the tree
+ * 
+ * @note    pairs are consecutive arrival tickets, threads arriving close in time
+ *          meet in early rounds and only log2(n) threads touch upper level flags.
+ *          losers hand their partial result to the winner, champion holds the final
+ *          result and it travels down the tree with the wakeup
+ * 
+ * @param barrier 
+ * @param id - arrival id in episode
+ * @param episode - episode number
+ * @param value - thread contribution
+ * @param reduce_fn - combine function, NULL for plain barrier
+ * @return int64_t - combined value
+ */
+static int64_t thread_barrier_wait_tournament(th_barrier_t *barrier, uint32_t id, uint32_t episode,
+        int64_t value, th_reduce_fn_t reduce_fn)
+{
+    uint32_t n = barrier->threshold_count;
+    uint32_t parity = episode & 1;
+    uint32_t target = (episode >> 1) + 1;
+    th_barrier_slot_t *slot;
+    uint32_t round, partner;
+
+    /* arrival, up the tree */
+    for(round = 0; round < barrier->rounds; round++)
+    {
+        partner = id ^ (1U << round);
+        if(id & (1U << round))
+        {
+            /* loser, report to winner and wait for release */
+            slot = thread_barrier_slot(barrier, parity, round, partner);
+            slot->value = value;
+            th_wait_word_add(&slot->word, 1);
+
+            slot = thread_barrier_slot(barrier, parity, barrier->rounds, id);
+            th_wait_word_wait_until(&slot->word, target, &barrier->budget);
+            value = slot->value;
+            break;
+        }
+        if(partner < n)
+        {
+            /* winner, wait for loser */
+            slot = thread_barrier_slot(barrier, parity, round, id);
+            th_wait_word_wait_until(&slot->word, target, &barrier->budget);
+            if(reduce_fn != NULL)
+            {
+                value = reduce_fn(value, slot->value);
+            }
+        }
+    }
+
+    /* wakeup, down the tree to losers of lower rounds */
+    while(round-- > 0)
+    {
+        partner = id | (1U << round);
+        if(partner < n)
+        {
+            slot = thread_barrier_slot(barrier, parity, barrier->rounds, partner);
+            slot->value = value;
+            th_wait_word_add(&slot->word, 1);
+        }
+    }
+    return value;
+}
+
+/**
+ * @brief   signal one thread or fiber blocked on barrier (signal chain link)
+ *          caller holds barrier->mutex
+ * 
+ * @param barrier 
+ */
+static void thread_barrier_signal_one(th_barrier_t *barrier)
+{
+    if(!fiber_wake_one(&barrier->fiber_wait_head))
+    {
+        th_byte_cond_signal(&barrier->cv);
+    }
+}
+
+/**
+ * @brief   mutex barrier, threads released one by one in a signal chain
+ *          when reducing, arrivals combine their value under barrier mutex
+ * 
+ * @note    a timed out thread withdraws its arrival unless disposition already began,
+ *          then it was released (its signal may race with the timeout) and passes on the chain
+ * 
+ * @param barrier 
+ * @param value - thread contribution, combined value on return
+ * @param reduce_fn - combine function, NULL for plain barrier
+ * @param deadline - NULL to wait forever
+ * @return int - 0, ETIMEDOUT
+ */
+static int thread_barrier_wait_mutex(th_barrier_t *barrier, int64_t *value, th_reduce_fn_t reduce_fn,
+        const struct timespec *deadline)
+{
+    /* fibers block by yielding their worker */
+    bool in_fiber = fiber_self() != NULL;
+
+    assert(deadline == NULL || !in_fiber);
+
     /* critical section */
-    pthread_mutex_lock(&barrier->mutex);
+    TH_MUTEX_LOCK(&barrier->mutex);
     /**
      *  check if barrier disposition in progress, means threads in progress of passing barrier
      *  block thread if thraed barrier is busy  */
     while(barrier->is_ready_again == false)
     {
-        pthread_cond_wait(&barrier->busy_cv, &barrier->mutex);
+        if(in_fiber)
+        {
+            fiber_wait(&barrier->fiber_busy_head, &barrier->mutex);
+        }
+        else if(th_byte_cond_wait_mutex(&barrier->busy_cv, &barrier->mutex, deadline) == ETIMEDOUT &&
+                barrier->is_ready_again == false)
+        {
+            /* not arrived yet, nothing to undo */
+            TH_MUTEX_UNLOCK(&barrier->mutex);
+            return ETIMEDOUT;
+        }
+    }
+
+    /* combine arrival value, it stays stable until disposition end */
+    if(reduce_fn != NULL)
+    {
+        barrier->reduce_value = barrier->curr_wait_count == 0 ? *value : reduce_fn(barrier->reduce_value, *value);
     }
 
     /* check if thread is last thread, nth thread = threshold */
     if(barrier->curr_wait_count + 1 == barrier->threshold_count)
     {
+        *value = barrier->reduce_value;
+        if(barrier->curr_wait_count == 0)
+        {
+            /* threshold of one, nobody to release */
+            TH_MUTEX_UNLOCK(&barrier->mutex);
+            return 0;
+        }
         /* disposition begin */
         barrier->is_ready_again = false;
         /* generate a relay signal (signal chain)*/
-        pthread_cond_signal(&barrier->cv);
-        pthread_mutex_unlock(&barrier->mutex);
-        return;
+        thread_barrier_signal_one(barrier);
+        TH_MUTEX_UNLOCK(&barrier->mutex);
+        return 0;
     }
 
     /* case thread is not last thread, block thread */
     barrier->curr_wait_count++;
-    pthread_cond_wait(&barrier->cv, &barrier->mutex);
+    if(in_fiber)
+    {
+        fiber_wait(&barrier->fiber_wait_head, &barrier->mutex);
+    }
+    else if(th_byte_cond_wait_mutex(&barrier->cv, &barrier->mutex, deadline) == ETIMEDOUT &&
+            barrier->is_ready_again == true)
+    {
+        /* barrier did not trip, withdraw arrival */
+        barrier->curr_wait_count--;
+        TH_MUTEX_UNLOCK(&barrier->mutex);
+        return ETIMEDOUT;
+    }
 
     /* thraed got signaled and resumed */
     barrier->curr_wait_count--;
+    *value = barrier->reduce_value;
 
     /* if this thread last thread waiting on the barrier, signal threads blocked in disposition phase */
     if(barrier-> curr_wait_count == 0)
     {
         /* disposition end */
         barrier->is_ready_again = true; 
-        pthread_cond_broadcast(&barrier->busy_cv);
+        th_byte_cond_broadcast(&barrier->busy_cv);
+        fiber_wake_all(&barrier->fiber_busy_head);
     }
     else /* not last thread in the barrier, signal another thread block in the barrier */ 
     {
         /* signal chain */ 
-        pthread_cond_signal(&barrier->cv);
+        thread_barrier_signal_one(barrier);
+    }
+    TH_MUTEX_UNLOCK(&barrier->mutex);
+    return 0;
+}
+
+/**
+ * @brief   barrier wait, optionally combining one value per thread
+ * 
+ * @param barrier 
+ * @param value - thread contribution, combined value on return
+ * @param reduce_fn - combine function, NULL for plain barrier
+ * @param deadline - NULL to wait forever, mutex and central barriers only
+ * @return int - 0, ETIMEDOUT
+ */
+static int thread_barrier_wait_combine(th_barrier_t *barrier, int64_t *value, th_reduce_fn_t reduce_fn,
+        const struct timespec *deadline)
+{
+    uint64_t ticket;
+    uint32_t id, episode;
+
+    if(barrier->type == THREAD_BARRIER_MUTEX)
+    {
+        return thread_barrier_wait_mutex(barrier, value, reduce_fn, deadline);
+    }
+
+    /* dissemination and tournament arrivals can not leave before signalling their partners */
+    assert(deadline == NULL || barrier->type == THREAD_BARRIER_CENTRAL);
+
+    /* spin barriers would block the worker a fiber runs on */
+    assert(fiber_self() == NULL);
+
+    /* arrival ticket gives episode and id within episode */
+    ticket = atomic_fetch_add_explicit(&barrier->ticket, 1, memory_order_acq_rel);
+    id = (uint32_t)(ticket % barrier->threshold_count);
+    episode = (uint32_t)(ticket / barrier->threshold_count);
+
+    switch(barrier->type)
+    {
+        case THREAD_BARRIER_CENTRAL:
+            return thread_barrier_wait_central(barrier, id, episode, value, reduce_fn, deadline);
+        case THREAD_BARRIER_DISSEMINATION:
+            *value = thread_barrier_wait_dissemination(barrier, id, episode, *value, reduce_fn);
+            return 0;
+        case THREAD_BARRIER_TOURNAMENT:
+            *value = thread_barrier_wait_tournament(barrier, id, episode, *value, reduce_fn);
+            return 0;
+        default:
+            assert(0);
+            return 0;
     }
-    pthread_mutex_unlock(&barrier->mutex);
+}
+
+/*********** private helper functions END ***********/
+
+void thread_barrier_wait(th_barrier_t *barrier)
+{
+    int64_t value = 0;
+
+    thread_barrier_wait_combine(barrier, &value, NULL, NULL);
+}
+int thread_barrier_wait_until(th_barrier_t *barrier, const struct timespec *deadline)
+{
+    int64_t value = 0;
+
+    return thread_barrier_wait_combine(barrier, &value, NULL, deadline);
+}
+int64_t thread_barrier_wait_reduce(th_barrier_t *barrier, int64_t value, th_reduce_fn_t reduce_fn)
+{
+    thread_barrier_wait_combine(barrier, &value, reduce_fn, NULL);
+    return value;
+}
+int64_t th_reduce_sum(int64_t acc, int64_t value)
+{
+    return acc + value;
+}
+int64_t th_reduce_min(int64_t acc, int64_t value)
+{
+    return value < acc ? value : acc;
+}
+int64_t th_reduce_max(int64_t acc, int64_t value)
+{
+    return value > acc ? value : acc;
 }
 void thread_barrier_signal_all(th_barrier_t *barrier)
 {
-    pthread_mutex_lock(&barrier->mutex);
+    assert(barrier->type == THREAD_BARRIER_MUTEX);
+
+    TH_MUTEX_LOCK(&barrier->mutex);
 
     /* check if there are waiting threads */
     if(barrier->curr_wait_count > 0)
     {
-        pthread_cond_signal(&barrier->cv);
+        /* disposition begin, a waiter timing out from now on is released, not withdrawn */
+        barrier->is_ready_again = false;
+        thread_barrier_signal_one(barrier);
     }
 
-    pthread_mutex_unlock(&barrier->mutex);
+    TH_MUTEX_UNLOCK(&barrier->mutex);
 }
 
 void wait_queue_init (wait_queue_t * wq)
+{
+    wait_queue_init_mode(wq, WAIT_QUEUE_CV);
+}
+void wait_queue_init_mode (wait_queue_t * wq, wait_queue_mode_t mode)
 {
     wq->thread_wait_count = 0;
     wq->app_mutex = NULL;
-    pthread_cond_init(&wq->cv, NULL);
+    th_byte_cond_init(&wq->cv);
+    wq->mode = mode;
+    wq->handoff_count = 0;
+    wq->cancel_seq = 0;
+    wq->lists = NULL;
+}
+
+/*********** private helper functions BEGIN **********/
+
+/**
+ * @brief   waiter lists of wait queue, allocated on first use, caller holds app mutex
+ * 
+ * @param wq 
+ * @return wait_queue_lists_t* 
+ */
+static wait_queue_lists_t *wait_queue_lists(wait_queue_t *wq)
+{
+    if(wq->lists == NULL)
+    {
+        wq->lists = malloc(sizeof(wait_queue_lists_t));
+        init_glthread_list(&wq->lists->fiber_wait_head);
+        init_glthread_list(&wq->lists->thread_wait_head);
+        init_glthread_list(&wq->lists->select_wait_head);
+        init_glthread_list(&wq->lists->async_wait_head);
+    }
+    return wq->lists;
 }
 
+/**
+ * @brief   FIFO mode wait, queue calling thread at tail and park on its parker
+ *          caller holds app mutex, it is held again on return
+ * 
+ * @param wq 
+ * @param thread - calling thread
+ * @param deadline - NULL to wait forever
+ * @return int - 0 woken, ETIMEDOUT (thread unlinked itself)
+ */
+static int wait_queue_fifo_wait(wait_queue_t *wq, thread_t *thread, const struct timespec *deadline)
+{
+    /* own parker, thread->parker belongs to thread pool dispatch */
+    th_parker_t *parker = th_parker_self();
+    int rc;
+
+    thread->wait_parker = parker;
+    glthread_list_add_last(&wait_queue_lists(wq)->thread_wait_head, &thread->wait_glue);
+    TH_MUTEX_UNLOCK(wq->app_mutex);
+
+    for(;;)
+    {
+        rc = th_park_until(parker, deadline);
+        TH_MUTEX_LOCK(wq->app_mutex);
+
+        /* waker unlinks thread before unparking it */
+        if(IS_GLTHREAD_LIST_EMPTY(&thread->wait_glue))
+        {
+            if(rc == ETIMEDOUT)
+            {
+                /* woken right at the deadline, unpark done under app mutex, consume it */
+                th_park(parker);
+            }
+            return 0;
+        }
+        if(rc == ETIMEDOUT)
+        {
+            glthread_list_remove(&wq->lists->thread_wait_head, &thread->wait_glue);
+            return ETIMEDOUT;
+        }
+        TH_MUTEX_UNLOCK(wq->app_mutex);
+    }
+}
+
+/**
+ * @brief   FIFO mode wakeup of oldest waiters, caller holds app mutex
+ * 
+ * @param wq 
+ * @param count - max waiters to wakeup
+ * @return uint32_t - waiters woken
+ */
+static uint32_t wait_queue_fifo_wake(wait_queue_t *wq, uint32_t count)
+{
+    glthread_t *node;
+    uint32_t woken = 0;
+
+    if(wq->lists == NULL)
+    {
+        return 0;
+    }
+    while(woken < count && (node = glthread_list_dequeue_first(&wq->lists->thread_wait_head)) != NULL)
+    {
+        th_unpark(wait_glue_to_thread(node)->wait_parker);
+        woken++;
+    }
+    return woken;
+}
+
+/**
+ * @brief   FIFO mode broadcast relay, woken waiter hand the wakeup to next broadcast waiter
+ *          caller holds app mutex
+ * 
+ * @param wq 
+ */
+static void wait_queue_fifo_handoff(wait_queue_t *wq)
+{
+    if(wq->handoff_count == 0)
+    {
+        return;
+    }
+
+    if(wait_queue_fifo_wake(wq, 1) == 1)
+    {
+        wq->handoff_count--;
+    }
+    else
+    {
+        wq->handoff_count = 0;
+    }
+}
+
+/**
+ * @brief   wakeup fibers blocked in wait queue, caller holds app mutex
+ * 
+ * @param wq 
+ * @param count - max fibers to wakeup
+ * @return uint32_t - fibers woken
+ */
+static uint32_t wait_queue_fiber_wake(wait_queue_t *wq, uint32_t count)
+{
+    uint32_t woken = 0;
+
+    if(wq->lists == NULL)
+    {
+        return 0;
+    }
+    if(count == UINT32_MAX)
+    {
+        return fiber_wake_all(&wq->lists->fiber_wait_head);
+    }
+    while(woken < count && fiber_wake_one(&wq->lists->fiber_wait_head))
+    {
+        woken++;
+    }
+    return woken;
+}
+
+/**
+ * @brief   wakeup oldest wait_queue_wait_any() waiters, caller holds app mutex
+ * 
+ * @note    an entry whose call already fired through another queue (or timed out)
+ *          is dropped and the wakeup goes to the next entry
+ * 
+ * @param wq 
+ * @param count - max waiters to wakeup
+ * @return uint32_t - waiters woken
+ */
+static uint32_t wait_queue_select_wake(wait_queue_t *wq, uint32_t count)
+{
+    glthread_t *node;
+    wait_queue_any_t *entry;
+    int32_t expected;
+    uint32_t woken = 0;
+
+    if(wq->lists == NULL)
+    {
+        return 0;
+    }
+    while(woken < count && (node = glthread_list_dequeue_first(&wq->lists->select_wait_head)) != NULL)
+    {
+        entry = select_glue_to_wait_queue_any(node);
+        expected = WAIT_QUEUE_SELECT_WAITING;
+        if(atomic_compare_exchange_strong(&entry->select->fired, &expected, (int32_t)entry->index))
+        {
+            /* waiting thread deregisters under this mutex before returning, entry is still valid */
+            th_unpark(entry->select->parker);
+            woken++;
+        }
+    }
+    return woken;
+}
+
+/**
+ * @brief   remove wait_queue_wait_any() entries from their queues, one app mutex at a time
+ * 
+ * @param entries 
+ * @param count - registered entries
+ */
+static void wait_queue_select_deregister(wait_queue_any_t *entries, uint32_t count)
+{
+    wait_queue_t *wq;
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        wq = entries[i].wq;
+        TH_MUTEX_LOCK(wq->app_mutex);
+        /* signaller unlinks the entry it fired */
+        if(!IS_GLTHREAD_LIST_EMPTY(&entries[i].select_glue))
+        {
+            glthread_list_remove(&wq->lists->select_wait_head, &entries[i].select_glue);
+        }
+        wq->thread_wait_count--;
+        TH_MUTEX_UNLOCK(wq->app_mutex);
+    }
+}
+
+/**
+ * @brief   queue async waiter at tail, caller holds app mutex
+ * 
+ * @param wq 
+ * @param waiter 
+ */
+static void wait_queue_async_enqueue(wait_queue_t *wq, wait_queue_async_t *waiter)
+{
+    init_glthread(&waiter->async_glue);
+    glthread_list_add_last(&wait_queue_lists(wq)->async_wait_head, &waiter->async_glue);
+    wq->thread_wait_count++;
+}
+
+/**
+ * @brief   submit oldest async waiters to their pools, caller holds app mutex
+ * 
+ * @param wq 
+ * @param count - max waiters to wakeup
+ * @return uint32_t - waiters woken
+ */
+static uint32_t wait_queue_async_wake(wait_queue_t *wq, uint32_t count)
+{
+    glthread_t *node;
+    wait_queue_async_t *waiter;
+    uint32_t woken = 0;
+
+    if(wq->lists == NULL)
+    {
+        return 0;
+    }
+    while(woken < count && (node = glthread_list_dequeue_first(&wq->lists->async_wait_head)) != NULL)
+    {
+        /* no thread to count itself out */
+        wq->thread_wait_count--;
+        waiter = async_glue_to_wait_queue_async(node);
+        thread_pool_submit(waiter->th_pool, &waiter->work);
+        woken++;
+    }
+    return woken;
+}
+
+/**
+ * @brief   thread pool work function of a woken async waiter,
+ *          re-test condition then run continuation or wait again
+ * 
+ * @param arg - wait_queue_async_t - pointer
+ * @return void* 
+ */
+static void *wait_queue_async_resume_fn(void *arg)
+{
+    wait_queue_async_t *waiter = (wait_queue_async_t *)arg;
+    pthread_mutex_t *app_mutex = NULL;
+
+    if(waiter->wait_queue_block_fn_cb(waiter->arg, &app_mutex))
+    {
+        /* condition consumed by another waiter since the wakeup */
+        waiter->wq->app_mutex = app_mutex;
+        wait_queue_async_enqueue(waiter->wq, waiter);
+        TH_MUTEX_UNLOCK(app_mutex);
+        return NULL;
+    }
+    waiter->wq->app_mutex = app_mutex;
+    return waiter->cont_fn(waiter->arg);
+}
+
+/*********** private helper functions END ***********/
+
 thread_t *wait_queue_test_and_wait (wait_queue_t *wq,
         wait_queue_condn_fn wait_queue_block_fn_cb,
         void *arg )
@@ -386,7 +1695,19 @@ thread_t *wait_queue_test_and_wait (wait_queue_t *wq,
     while(should_block)
     {
         wq->thread_wait_count++;
-        pthread_cond_wait(&wq->cv, wq->app_mutex);
+        if(fiber_self() != NULL)
+        {
+            /* fiber yield its worker, app mutex released once fiber switched out */
+            fiber_wait(&wait_queue_lists(wq)->fiber_wait_head, wq->app_mutex);
+        }
+        else if(wq->mode == WAIT_QUEUE_FIFO)
+        {
+            wait_queue_fifo_wait(wq, thread_self(), NULL);
+        }
+        else
+        {
+            th_byte_cond_wait_mutex(&wq->cv, wq->app_mutex, NULL);
+        }
 
         /**
          * thread unlocking and resume
@@ -394,9 +1715,64 @@ thread_t *wait_queue_test_and_wait (wait_queue_t *wq,
          */
         wq->thread_wait_count--;
         should_block = wait_queue_block_fn_cb(arg, NULL);
+
+        /* condition tested, pass broadcast on to next waiter in order */
+        if(wq->mode == WAIT_QUEUE_FIFO)
+        {
+            wait_queue_fifo_handoff(wq);
+        }
     }
     return NULL;
 }
+int wait_queue_test_and_wait_until (wait_queue_t *wq,
+        wait_queue_condn_fn wait_queue_block_fn_cb,
+        void *arg, const struct timespec *deadline)
+{
+    bool should_block;
+    pthread_mutex_t *locked_app_mutex = NULL;
+    uint32_t cancel_seq;
+    int rc;
+
+    /* fiber_wait() has no timeout */
+    assert(fiber_self() == NULL);
+
+    should_block = wait_queue_block_fn_cb(arg, &locked_app_mutex);
+    wq->app_mutex = locked_app_mutex;
+    cancel_seq = wq->cancel_seq;
+
+    while(should_block)
+    {
+        wq->thread_wait_count++;
+        if(wq->mode == WAIT_QUEUE_FIFO)
+        {
+            rc = wait_queue_fifo_wait(wq, thread_self(), deadline);
+        }
+        else
+        {
+            rc = th_byte_cond_wait_mutex(&wq->cv, wq->app_mutex, deadline);
+        }
+        wq->thread_wait_count--;
+
+        if(wq->cancel_seq != cancel_seq)
+        {
+            return ECANCELED;
+        }
+
+        should_block = wait_queue_block_fn_cb(arg, NULL);
+        if(rc == ETIMEDOUT)
+        {
+            /* condition may have turned false right at the deadline */
+            return should_block ? ETIMEDOUT : 0;
+        }
+
+        /* condition tested, pass broadcast on to next waiter in order */
+        if(wq->mode == WAIT_QUEUE_FIFO)
+        {
+            wait_queue_fifo_handoff(wq);
+        }
+    }
+    return 0;
+}
 void wait_queue_signal (wait_queue_t *wq, bool lock_mutex)
 {
     /* check application mutex */
@@ -408,7 +1784,7 @@ void wait_queue_signal (wait_queue_t *wq, bool lock_mutex)
     /* lock mutex if application request locking */
     if(lock_mutex)
     {
-        pthread_mutex_lock(wq->app_mutex);
+        TH_MUTEX_LOCK(wq->app_mutex);
     }
 
     /* check if there are threads waiting in queue */
@@ -416,18 +1792,73 @@ void wait_queue_signal (wait_queue_t *wq, bool lock_mutex)
     {
         if(lock_mutex)
         {
-            pthread_mutex_unlock(wq->app_mutex);
+            TH_MUTEX_UNLOCK(wq->app_mutex);
             
         }
         return;
     }
 
-    pthread_cond_signal(&wq->cv);
+    /* wakeup fiber waiter first, then multi-queue waiter, then async waiter, otherwise a blocked thread */
+    if(!wait_queue_fiber_wake(wq, 1) && wait_queue_select_wake(wq, 1) == 0 &&
+       wait_queue_async_wake(wq, 1) == 0)
+    {
+        if(wq->mode == WAIT_QUEUE_FIFO)
+        {
+            wait_queue_fifo_wake(wq, 1);
+        }
+        else
+        {
+            th_byte_cond_signal(&wq->cv);
+        }
+    }
+
+    if(lock_mutex)
+    {
+        TH_MUTEX_UNLOCK(wq->app_mutex);
+    }
+}
+uint32_t wait_queue_signal_n (wait_queue_t *wq, uint32_t count, bool lock_mutex)
+{
+    uint32_t woken = 0, fiber_woken, select_woken, thread_waiting, i;
+
+    /* check application mutex */
+    if(!wq->app_mutex)
+    {
+        return 0;
+    }
+
+    /* lock mutex if application request locking */
+    if(lock_mutex)
+    {
+        TH_MUTEX_LOCK(wq->app_mutex);
+    }
+
+    /* wakeup fiber waiters first, then multi-queue waiters, then async waiters, then threads */
+    fiber_woken = wait_queue_fiber_wake(wq, count < wq->thread_wait_count ? count : wq->thread_wait_count);
+    woken = fiber_woken;
+    select_woken = wait_queue_select_wake(wq, count - woken);
+    woken += select_woken;
+    woken += wait_queue_async_wake(wq, count - woken);
+
+    if(wq->mode == WAIT_QUEUE_FIFO)
+    {
+        woken += wait_queue_fifo_wake(wq, count - woken);
+    }
+    else
+    {
+        /* woken fibers and multi-queue waiters count themselves out only once they run */
+        thread_waiting = wq->thread_wait_count - fiber_woken - select_woken;
+        for(i = 0; woken < count && i < thread_waiting; i++, woken++)
+        {
+            th_byte_cond_signal(&wq->cv);
+        }
+    }
 
     if(lock_mutex)
     {
-        pthread_mutex_unlock(wq->app_mutex);
+        TH_MUTEX_UNLOCK(wq->app_mutex);
     }
+    return woken;
 }
 void wait_queue_broadcast (wait_queue_t *wq, bool lock_mutex)
 {
@@ -440,7 +1871,7 @@ void wait_queue_broadcast (wait_queue_t *wq, bool lock_mutex)
     /* lock mutex if application request locking */
     if(lock_mutex)
     {
-        pthread_mutex_lock(wq->app_mutex);
+        TH_MUTEX_LOCK(wq->app_mutex);
     }
 
     /* check if there are threads waiting in queue */
@@ -448,21 +1879,203 @@ void wait_queue_broadcast (wait_queue_t *wq, bool lock_mutex)
     {
         if(lock_mutex)
         {
-            pthread_mutex_unlock(wq->app_mutex);
+            TH_MUTEX_UNLOCK(wq->app_mutex);
             
         }
         return;
     }
 
-    pthread_cond_broadcast(&wq->cv);
+    wait_queue_fiber_wake(wq, UINT32_MAX);
+    wait_queue_select_wake(wq, UINT32_MAX);
+    wait_queue_async_wake(wq, UINT32_MAX);
+    if(wq->mode == WAIT_QUEUE_FIFO)
+    {
+        /* wakeup oldest waiter only, the others are handed the wakeup one after another */
+        wq->handoff_count = wq->lists ? GLTHREAD_LIST_COUNT(&wq->lists->thread_wait_head) : 0;
+        wait_queue_fifo_handoff(wq);
+    }
+    else
+    {
+        th_byte_cond_broadcast(&wq->cv);
+    }
 
     if(lock_mutex)
     {
-        pthread_mutex_unlock(wq->app_mutex);
+        TH_MUTEX_UNLOCK(wq->app_mutex);
+    }
+}
+int wait_queue_wait_any (wait_queue_any_t *entries, uint32_t count,
+        const struct timespec *deadline, uint32_t *fired)
+{
+    wait_queue_select_t select;
+    wait_queue_any_t *entry;
+    pthread_mutex_t *app_mutex;
+    uint32_t registered;
+    int32_t index, expected;
+
+    assert(fiber_self() == NULL && count > 0);
+    select.parker = th_parker_self();
+
+    for(;;)
+    {
+        atomic_store(&select.fired, WAIT_QUEUE_SELECT_WAITING);
+        index = WAIT_QUEUE_SELECT_WAITING;
+
+        /* register on every queue whose condition blocks, stop at the first ready one */
+        for(registered = 0; registered < count; registered++)
+        {
+            entry = &entries[registered];
+            app_mutex = NULL;
+            if(!entry->wait_queue_block_fn_cb(entry->arg, &app_mutex))
+            {
+                entry->wq->app_mutex = app_mutex;
+                expected = WAIT_QUEUE_SELECT_WAITING;
+                if(atomic_compare_exchange_strong(&select.fired, &expected, (int32_t)registered) &&
+                   registered == 0)
+                {
+                    /* ready without registering anywhere */
+                    *fired = 0;
+                    return 0;
+                }
+                /* other mutexes are taken to deregister, re-test this queue afterwards */
+                TH_MUTEX_UNLOCK(app_mutex);
+                break;
+            }
+
+            entry->wq->app_mutex = app_mutex;
+            entry->select = &select;
+            entry->index = registered;
+            init_glthread(&entry->select_glue);
+            glthread_list_add_last(&wait_queue_lists(entry->wq)->select_wait_head, &entry->select_glue);
+            entry->wq->thread_wait_count++;
+            TH_MUTEX_UNLOCK(app_mutex);
+        }
+
+        if(registered == count &&
+           th_park_until(select.parker, deadline) == ETIMEDOUT)
+        {
+            expected = WAIT_QUEUE_SELECT_WAITING;
+            if(atomic_compare_exchange_strong(&select.fired, &expected, WAIT_QUEUE_SELECT_TIMEDOUT))
+            {
+                wait_queue_select_deregister(entries, registered);
+                return ETIMEDOUT;
+            }
+            /* fired right at the deadline, its unpark is pending */
+            index = WAIT_QUEUE_SELECT_TIMEDOUT;
+        }
+
+        /* unpark of a fired entry is done under its app mutex, so it happened once deregistered */
+        wait_queue_select_deregister(entries, registered);
+        if(index == WAIT_QUEUE_SELECT_TIMEDOUT ||
+           (registered != count && atomic_load(&select.fired) != (int32_t)registered))
+        {
+            /* wakeup not consumed by park, take it so the next park does not return early */
+            th_park(select.parker);
+        }
+
+        /* re-test fired queue, its condition may be consumed already by another waiter */
+        index = atomic_load(&select.fired);
+        entry = &entries[index];
+        app_mutex = NULL;
+        if(!entry->wait_queue_block_fn_cb(entry->arg, &app_mutex))
+        {
+            entry->wq->app_mutex = app_mutex;
+            *fired = (uint32_t)index;
+            return 0;
+        }
+        TH_MUTEX_UNLOCK(app_mutex);
+    }
+}
+bool wait_queue_test_and_wait_async (wait_queue_async_t *waiter)
+{
+    pthread_mutex_t *app_mutex = NULL;
+
+    waiter->work.work_fn = wait_queue_async_resume_fn;
+    waiter->work.arg = waiter;
+
+    if(waiter->wait_queue_block_fn_cb(waiter->arg, &app_mutex))
+    {
+        waiter->wq->app_mutex = app_mutex;
+        wait_queue_async_enqueue(waiter->wq, waiter);
+        TH_MUTEX_UNLOCK(app_mutex);
+        return true;
+    }
+
+    /* not run inline, a continuation waiting again would recurse for as long as condition holds */
+    waiter->wq->app_mutex = app_mutex;
+    TH_MUTEX_UNLOCK(app_mutex);
+    thread_pool_submit(waiter->th_pool, &waiter->work);
+    return false;
+}
+void wait_queue_cancel (wait_queue_t *wq, bool lock_mutex)
+{
+    /* check application mutex */
+    if(!wq->app_mutex)
+    {
+        return;
+    }
+
+    if(lock_mutex)
+    {
+        TH_MUTEX_LOCK(wq->app_mutex);
+    }
+
+    wq->cancel_seq++;
+    wait_queue_fiber_wake(wq, UINT32_MAX);
+    wait_queue_select_wake(wq, UINT32_MAX);
+    wait_queue_async_wake(wq, UINT32_MAX);
+    if(wq->mode == WAIT_QUEUE_FIFO)
+    {
+        wq->handoff_count = 0;
+        wait_queue_fifo_wake(wq, UINT32_MAX);
+    }
+    else
+    {
+        th_byte_cond_broadcast(&wq->cv);
+    }
+
+    if(lock_mutex)
+    {
+        TH_MUTEX_UNLOCK(wq->app_mutex);
     }
 }
 void wait_queue_destroy (wait_queue_t *wq)
 {
-    pthread_cond_destroy(&wq->cv);
+    free(wq->lists);
+    wq->lists = NULL;
     wq->app_mutex = NULL;
 }
+void wait_queue_lite_init (wait_queue_lite_t *wq)
+{
+    th_byte_cond_init(&wq->cond);
+}
+int wait_queue_lite_test_and_wait (wait_queue_lite_t *wq,
+        wait_queue_condn_fn wait_queue_block_fn_cb,
+        void *arg, const struct timespec *deadline)
+{
+    pthread_mutex_t *app_mutex = NULL;
+    bool should_block;
+
+    assert(fiber_self() == NULL);
+
+    /* condition function lock application mutex and hand it back */
+    should_block = wait_queue_block_fn_cb(arg, &app_mutex);
+    while(should_block)
+    {
+        if(th_byte_cond_wait_mutex(&wq->cond, app_mutex, deadline) == ETIMEDOUT)
+        {
+            /* condition may have turned false right at the deadline */
+            return wait_queue_block_fn_cb(arg, NULL) ? ETIMEDOUT : 0;
+        }
+        should_block = wait_queue_block_fn_cb(arg, NULL);
+    }
+    return 0;
+}
+void wait_queue_lite_signal (wait_queue_lite_t *wq)
+{
+    th_byte_cond_signal(&wq->cond);
+}
+void wait_queue_lite_broadcast (wait_queue_lite_t *wq)
+{
+    th_byte_cond_broadcast(&wq->cond);
+}
@@ -17,7 +17,14 @@
 #include <semaphore.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdatomic.h>
 #include "glthread.h"
+#include "th_telemetry.h"
+#include "th_park.h"
+#include "parking_lot.h"
+#include "th_rcu.h"
+#include "th_lock.h"
+#include "th_lock_prof.h"
 
 /******************** thread flags status ********************/
 
@@ -29,9 +36,16 @@
 #define THREAD_F_PAUSED             (1<<2)
 /* thread blocked by CV */
 #define THREAD_F_BLOCKED            (1<<3)
+/* thread group requested stop at next safepoint */
+#define THREAD_F_MARKED_FOR_SAFEPOINT (1<<4)
+
+/* any request thread_test_and_pause() must act on */
+#define THREAD_F_PAUSE_PENDING      (THREAD_F_MARKED_FOR_PAUSE | THREAD_F_MARKED_FOR_SAFEPOINT)
 
 /******************** thread flags status END ********************/
 
+struct thread_group_;
+
 /* typedefs */
 typedef struct thread_{
 
@@ -46,13 +60,25 @@ typedef struct thread_{
     void *(*thread_pause_fn)(void *);           /* thread resume after pause function call */
     void *pause_arg;                            /* pause/resume function call argument */
 
-    uint32_t flag;                              /* thread status flag */
-    pthread_mutex_t state_mutex;                /* update thread state mutually exclusive */
-    pthread_cond_t cv;                          /* cv on which thread will block it self */
+    _Atomic uint32_t flag;                      /* thread status flag, written under state_lock, read lock-free */
+    th_byte_lock_t state_lock;                  /* update thread state mutually exclusive */
+    th_byte_cond_t cv;                          /* cv on which thread will block it self */
+    struct thread_group_ *group;                /* thread group for stop-the-world safepoints, NULL if none */
+    th_rcu_reader_t *rcu_reader;                /* QSBR reader reporting quiescent states at pause points, NULL if none */
 
-    sem_t *semaphore;                           /* thread object semaphore - usually will be used for zero semaphore */
+    th_parker_t *_Atomic caller_parker;         /* blocked dispatcher parker, unparked when work is done */
 
     glthread_t wait_glue;                       /* glthread data structure node */
+    th_parker_t *wait_parker;                   /* FIFO wait queue waiter parker, set while wait_glue is queued */
+
+    /* thread pool idle stack */
+    uint32_t pool_slot;                         /* index of thread in thread pool slots table */
+    _Atomic uint32_t pool_next;                 /* next idle thread (slot + 1), 0 is end of stack */
+    th_parker_t parker;                         /* private parker thread spins then sleeps on while idle in pool */
+
+#ifdef THREADLIB_TELEMETRY
+    th_worker_telemetry_t *telemetry;           /* worker telemetry, allocated when inserted in pool */
+#endif
 } thread_t;
 /**
  * @brief this macro make inline function to be used to return get the object from glue thread
@@ -87,6 +113,15 @@ void thread_run(thread_t *thread, void *(*thread_fn)(void *), void *arg);
  */
 void thread_set_thread_attribute_joinable_or_detached(thread_t *thread, bool joinable);
 
+/**
+ * @brief   thread object of calling thread
+ * 
+ * @note    threads not started by thread_run() get a private thread object on first call
+ * 
+ * @return thread_t* 
+ */
+thread_t *thread_self(void);
+
 /********************* Thead pausing and resuming *********************/
 
 /**
@@ -100,6 +135,17 @@ void thread_set_thread_attribute_joinable_or_detached(thread_t *thread, bool joi
 void thread_set_pause_fn(thread_t *thread,
                     void *(*thread_pause_fn)(void *),
                     void *pause_arg);
+
+/**
+ * @brief   make thread pause points QSBR quiescent states:
+ *          thread_test_and_pause() announces one, and the thread is offline while paused
+ * 
+ * @note    thread must be outside rcu read side at every pause point
+ * 
+ * @param thread 
+ * @param rcu_reader - registered QSBR reader of thread, NULL to detach
+ */
+void thread_set_rcu_reader(thread_t *thread, th_rcu_reader_t *rcu_reader);
 /**
  * @brief this API just set the pause flag
  *        thread when he got to the pause point it pause it self
@@ -120,22 +166,149 @@ void thread_resume(thread_t *thread);
  *          if pause flag is set pause the thread
  *          This API must be called at pause points
  * 
+ * @note    when no pause is pending it costs one atomic load, no lock is taken,
+ *          it is also the safepoint where thread group members stop
+ * 
  * @param thread 
  */
 void thread_test_and_pause(thread_t *thread);
 
 /********************* Thead pausing and resuming END *********************/
 
+/********************* Thead group safepoints *********************/
+
+/**
+ * @brief   group of threads which can be stopped together at their safepoints (thread_test_and_pause)
+ *          e.g. to take consistent snapshot of shared state without per-object locks
+ * 
+ */
+typedef struct thread_group_
+{
+    thread_t **members;                         /* member threads */
+    uint32_t member_count;
+    uint32_t member_capacity;
+    uint32_t parked_count;                      /* members parked at safepoint in current stop */
+    uint32_t resume_epoch;                      /* bumped by every resume, parked members wait for it to change */
+    bool stopped;                               /* between thread_group_pause_all() and thread_group_resume_all() */
+    pthread_mutex_t mutex;
+    pthread_cond_t parked_cv;                   /* controller waits for members to park */
+    pthread_cond_t resume_cv;                   /* parked members wait here, one broadcast resumes all */
+}thread_group_t;
+
+/**
+ * @brief initiate empty thread group
+ * 
+ * @param group 
+ */
+void thread_group_init(thread_group_t *group);
+
+/**
+ * @brief   add thread to group, thread must call thread_test_and_pause() periodically
+ * 
+ * @note    a thread belongs to one group at most, and must leave it before it exits
+ * 
+ * @param group 
+ * @param thread 
+ */
+void thread_group_add(thread_group_t *group, thread_t *thread);
+
+/**
+ * @brief remove thread from group
+ * 
+ * @param group 
+ * @param thread 
+ */
+void thread_group_remove(thread_group_t *group, thread_t *thread);
+
+/**
+ * @brief   mark all running members for stop and block until every one of them is parked at its safepoint
+ * 
+ * @note    must not be called by a group member.
+ *          only thread_test_and_pause() parks a member, a member blocked elsewhere (wait queue,
+ *          barrier, thread pool dispatch, lock held by a parked member ...) is not parked and this
+ *          call waits for it to come back to a safepoint, use thread_group_pause_all_until() when
+ *          members may block for long
+ * 
+ * @param group 
+ * @return uint32_t - number of members parked
+ */
+uint32_t thread_group_pause_all(thread_group_t *group);
+
+/**
+ * @brief   thread_group_pause_all() bounded by an absolute deadline, all or nothing
+ * 
+ * @note    on timeout the stop is cancelled: members already parked are resumed, the others
+ *          no longer stop, group is not stopped and thread_group_resume_all() must not be called
+ * 
+ * @param group 
+ * @param deadline - absolute CLOCK_MONOTONIC time (see th_deadline_in()), NULL to wait forever
+ * @param parked_count - number of members parked, 0 on timeout, may be NULL
+ * @return int - 0 all running members parked, ETIMEDOUT
+ */
+int thread_group_pause_all_until(thread_group_t *group, const struct timespec *deadline,
+        uint32_t *parked_count);
+
+/**
+ * @brief   resume all members parked by thread_group_pause_all() with one broadcast
+ * 
+ * @param group 
+ */
+void thread_group_resume_all(thread_group_t *group);
+
+/**
+ * @brief   destroy thread group, group must be empty or have no parked members
+ * 
+ * @param group 
+ */
+void thread_group_destroy(thread_group_t *group);
+
+/********************* Thead group safepoints END *********************/
+
 /******************** Thread Pool Begin ********************/
 
+/* maximum number of threads a single thread pool can own */
+#define THREAD_POOL_MAX_THREADS     256
+
+/**
+ * @brief   unit of work queued on thread pool backlog by thread_pool_submit(),
+ *          caller owned, no allocation per submit
+ */
+typedef struct thread_pool_work_
+{
+    void *(*work_fn)(void *);
+    void *arg;
+    glthread_t work_glue;                               /* node in th_pool->work_list */
+#ifdef THREADLIB_TELEMETRY
+    uint64_t enqueue_ns;                                /* time queued on backlog */
+#endif
+}thread_pool_work_t;
+GLTHREAD_TO_STRUCT(work_glue_to_thread_pool_work, thread_pool_work_t, work_glue);
+
 /**
  * @brief thread pool data struct
  * 
+ * @note  idle threads are kept in a lock-free stack (Treiber stack).
+ *        stack links are slot indexes instead of pointers, and the top of stack
+ *        word carries a version tag in its upper 32 bits, so a pop racing with
+ *        pop/push of the same thread (ABA) fails its CAS and retries.
+ *        `mutex` only serialise adding new threads to the pool, fetching and
+ *        returning a thread never take it.
  */
 typedef struct thread_pool_
 {
-    glthread_t pool_head;
-    pthread_mutex_t mutex;
+    _Atomic uint64_t idle_top;                          /* tag(32 bits) | top slot + 1 (32 bits) */
+    thread_t *slots[THREAD_POOL_MAX_THREADS];           /* threads owned by pool, indexed by pool_slot */
+    uint32_t thread_count;                              /* number of used slots */
+    th_lock_t mutex;                                    /* serialise thread_pool_insert_new_thread() */
+
+    /* backlog of submitted work no idle thread was free for, drained by workers before they park */
+    th_lock_t work_mutex;
+    glthread_list_t work_list;
+    _Atomic uint32_t work_count;
+
+#ifdef THREADLIB_TELEMETRY
+    th_pool_telemetry_t telemetry;                      /* pool wide telemetry */
+#endif
 }thread_pool_t;
 
 /**
@@ -167,6 +340,15 @@ typedef struct thread_execution_data_
  */
 void thread_pool_init(thread_pool_t *th_pool);
 
+/**
+ * @brief   initiate thread pool object with pool and backlog locks of given type,
+ *          e.g. TH_LOCK_MCS when many threads submit to a busy pool
+ *
+ * @param th_pool
+ * @param lock_type - thread_pool_init() uses TH_LOCK_PTHREAD
+ */
+void thread_pool_init_lock(thread_pool_t *th_pool, th_lock_type_t lock_type);
+
 /**
  * @brief add thread to thread pool
  *        thread require to be new and not null
@@ -174,8 +356,10 @@ void thread_pool_init(thread_pool_t *th_pool);
  * 
  * @param th_pool 
  * @param thread 
+ * @return true  - thread added
+ *         false - pool already owns THREAD_POOL_MAX_THREADS threads, thread not added
  */
-void thread_pool_insert_new_thread(thread_pool_t *th_pool, thread_t *thread);
+bool thread_pool_insert_new_thread(thread_pool_t *th_pool, thread_t *thread);
 
 /**
  * @brief fetch a thread from thread pool
@@ -200,21 +384,129 @@ thread_t *thread_pool_get_thread(thread_pool_t *th_pool);
  * @param th_pool    - pointer to thread_pool_t object
  * @param thread_fn  - pointer to thread work function
  * @param arg        - pointer to thread work arg
+ * @return true      - work dispatched
+ *         false     - no idle thread in thread pool, work rejected
+ */
+bool thread_pool_dispatch_thread(thread_pool_t *th_pool, void *(*thread_fn)(void*), void *arg, bool block_caller);
+
+/**
+ * @brief   dispatch work and block caller until it is done or deadline passed
+ * 
+ * @note    on timeout the work keeps running on its worker, the caller is just no longer notified
+ * 
+ * @param th_pool    - pointer to thread_pool_t object
+ * @param thread_fn  - pointer to thread work function
+ * @param arg        - pointer to thread work arg
+ * @param deadline   - absolute CLOCK_MONOTONIC time (see th_deadline_in()), NULL to wait forever
+ * @return int       - 0 work done, EAGAIN no idle thread (work rejected), ETIMEDOUT
+ */
+int thread_pool_dispatch_thread_until(thread_pool_t *th_pool, void *(*thread_fn)(void*), void *arg,
+        const struct timespec *deadline);
+
+/**
+ * @brief   run work on an idle thread, or queue it on pool backlog when all threads are busy,
+ *          work is never rejected
+ * 
+ * @note    busy workers drain the backlog in order before going back to idle,
+ *          so the backlog may hold far more work than the pool has threads.
+ *          work object must stay valid until its work function is called
+ * 
+ * @param th_pool    - pointer to thread_pool_t object
+ * @param work       - work function and arg filled by caller
+ */
+void thread_pool_submit(thread_pool_t *th_pool, thread_pool_work_t *work);
+
+#ifdef THREADLIB_TELEMETRY
+
+/**
+ * @brief   take a snapshot of pool telemetry without stopping the pool
+ * 
+ * @note    worker counters are read while workers keep updating them,
+ *          snapshot is consistent per counter, not across counters
+ * 
+ * @param th_pool 
+ * @param snapshot - caller allocated snapshot object
+ */
+void thread_pool_telemetry_snapshot(thread_pool_t *th_pool, th_pool_telemetry_snapshot_t *snapshot);
+
+/**
+ * @brief   write pool telemetry report to file
+ * 
+ * @note    report is written to `<path>.tmp` then renamed, so a monitor reading `path`
+ *          always see a complete report. path under /dev/shm keep it in shared memory
+ * 
+ * @param th_pool 
+ * @param path 
+ * @return int - 0 on success, -1 on failure
  */
-void thread_pool_dispatch_thread(thread_pool_t *th_pool, void *(*thread_fn)(void*), void *arg, bool block_caller);
+int thread_pool_telemetry_dump(thread_pool_t *th_pool, const char *path);
+
+/**
+ * @brief   start a dumper thread writing pool telemetry report to path every interval
+ * 
+ * @param th_pool 
+ * @param path 
+ * @param interval_ms 
+ */
+void thread_pool_telemetry_start_dump(thread_pool_t *th_pool, const char *path, uint32_t interval_ms);
+
+/**
+ * @brief   stop and join dumper thread
+ * 
+ * @param th_pool 
+ */
+void thread_pool_telemetry_stop_dump(thread_pool_t *th_pool);
+
+#endif /* THREADLIB_TELEMETRY */
 
 /********************* Thread pool End *********************/
 
 /********************* Thread Barrier Begin *********************/
 
+/**
+ * barrier algorithms, selected at init
+ * mutex barrier is the only one fibers can block on, others spin then sleep on futex
+ */
+typedef enum th_barrier_type_
+{
+	THREAD_BARRIER_MUTEX,			/* mutex + cv, release by signal chain (default) */
+	THREAD_BARRIER_CENTRAL,			/* centralized sense-reversing, all waiters watch one release word */
+	THREAD_BARRIER_DISSEMINATION,	/* log2(n) rounds, each thread signal one partner per round */
+	THREAD_BARRIER_TOURNAMENT,		/* arrival up a binary tree, wakeup down the tree */
+} th_barrier_type_t;
+
+/* spin barrier flag and the value it carries, padded to its own cache line */
+typedef struct th_barrier_slot_ {
+
+	th_wait_word_t word;
+	int64_t value;					/* reduction partial result, written before word is signaled */
+	char pad[TH_CACHE_LINE_SIZE - sizeof(th_wait_word_t) - sizeof(int64_t)];
+} th_barrier_slot_t;
+
+/**
+ * reduction combine function, must be associative and commutative,
+ * values are combined in arrival order
+ */
+typedef int64_t (*th_reduce_fn_t)(int64_t acc, int64_t value);
+
 typedef struct th_barrier_ {
 
  	uint32_t threshold_count;
 	uint32_t curr_wait_count;
-	pthread_cond_t cv;
-	pthread_mutex_t mutex;
+	th_byte_cond_t cv;				/* waiters sleep in parking lot, keyed by address */
+	pthread_mutex_t mutex;			/* pthread mutex, fiber_wait() releases it */
 	bool is_ready_again;
-	pthread_cond_t busy_cv;
+	th_byte_cond_t busy_cv;
+	glthread_list_t fiber_wait_head;	/* fibers blocked on barrier, woken like cv waiters */
+	glthread_list_t fiber_busy_head;	/* fibers blocked while barrier disposition in progress */
+	int64_t reduce_value;			/* mutex barrier reduction, combined under mutex */
+
+	/* spin barriers */
+	th_barrier_type_t type;
+	_Atomic uint64_t ticket;		/* arrival ticket, episode = ticket / threshold, id = ticket % threshold */
+	uint32_t rounds;				/* dissemination / tournament rounds, ceil(log2(threshold)) */
+	th_barrier_slot_t *slots;		/* per type flags, counted per episode */
+	th_spin_budget_t budget;		/* adaptive spin before sleeping on futex */
 } th_barrier_t;
 
 /**
@@ -225,6 +517,19 @@ typedef struct th_barrier_ {
  */
 void thread_barrier_init (th_barrier_t *barrier, 
                       uint32_t threshold_count);
+
+/**
+ * @brief 	this function initiate thread barrier object with selected algorithm
+ * 
+ * @note 	spin barriers give arriving threads an id from an arrival ticket, so callers need no id,
+ * 			waiters spin for an adaptive budget then sleep on futex, fibers must use THREAD_BARRIER_MUTEX
+ * 
+ * @param barrier - thread barrier object 
+ * @param threshold_count - thread barrier threshold
+ * @param type - barrier algorithm
+ */
+void thread_barrier_init_type (th_barrier_t *barrier, 
+                      uint32_t threshold_count, th_barrier_type_t type);
 /**
  * @brief this function deinitialize thread barrier object
  *        freeing the object memory is user responsibility
@@ -241,9 +546,44 @@ void thread_barrier_destroy (th_barrier_t *barrier );
  */
 void thread_barrier_wait (th_barrier_t *barrier);
 
+/**
+ * @brief 	barrier wait bounded by an absolute deadline (THREAD_BARRIER_MUTEX and THREAD_BARRIER_CENTRAL only)
+ * 
+ * @note 	mutex barrier: a thread timing out before the barrier trips withdraws its arrival.
+ * 			central barrier: the arrival stands, the episode completes once the other threads arrive.
+ * 			dissemination and tournament arrivals must keep signalling partners so they cannot time out.
+ * 			fibers can not use timed waits
+ * 
+ * @param barrier - thread barrier object
+ * @param deadline - absolute CLOCK_MONOTONIC time (see th_deadline_in()), NULL to wait forever
+ * @return int - 0 barrier passed, ETIMEDOUT
+ */
+int thread_barrier_wait_until (th_barrier_t *barrier, const struct timespec *deadline);
+
+/**
+ * @brief 	barrier wait where every thread contribute a value and leave with all values combined
+ * 
+ * @note 	values are combined along the barrier own communication (mutex: under barrier mutex,
+ * 			central: last arrival fold, dissemination: carried by round signals,
+ * 			tournament: up the tree to champion, result down the tree), no extra lock is taken.
+ * 			all threads of one episode must call it with the same reduce_fn
+ * 
+ * @param barrier - thread barrier object
+ * @param value - thread contribution
+ * @param reduce_fn - combine function, th_reduce_sum / th_reduce_min / th_reduce_max or custom
+ * @return int64_t - combined value of all threads in this episode
+ */
+int64_t thread_barrier_wait_reduce (th_barrier_t *barrier, int64_t value, th_reduce_fn_t reduce_fn);
+
+/* built-in combine functions */
+int64_t th_reduce_sum (int64_t acc, int64_t value);
+int64_t th_reduce_min (int64_t acc, int64_t value);
+int64_t th_reduce_max (int64_t acc, int64_t value);
+
 /**
  * @brief 	force signal all threads blocked on thread barrier
  * 			this function ignores number of threads waiting on thread barrier
+ * 			(THREAD_BARRIER_MUTEX only)
  * 
  * @param barrier 
  */
@@ -254,12 +594,34 @@ void thread_barrier_signal_all(th_barrier_t *barrier);
 
 /********************* Wait Queue Begin *********************/
 
+/* wait queue wakeup policy, selected at init */
+typedef enum wait_queue_mode_
+{
+    WAIT_QUEUE_CV,                  /* waiters block on one condition variable (default) */
+    WAIT_QUEUE_FIFO,                /* waiters queue up through thread_t wait_glue and park on their own parker */
+}wait_queue_mode_t;
+
+/**
+ * @brief   wait queue waiters not sleeping on its condition variable,
+ *          allocated by the first such waiter, most wait queues never need it
+ */
+typedef struct wait_queue_lists_
+{
+    glthread_list_t fiber_wait_head;    /* fibers blocked in wait-queue, they yield their worker instead of blocking it */
+    glthread_list_t thread_wait_head;   /* FIFO mode waiting thread_t objects linked by wait_glue, oldest first */
+    glthread_list_t select_wait_head;   /* wait_queue_wait_any() entries, woken after fibers, before other threads */
+    glthread_list_t async_wait_head;    /* wait_queue_test_and_wait_async() waiters, woken after select entries */
+}wait_queue_lists_t;
+
 typedef struct wait_queue_
 {
     uint32_t thread_wait_count;     /* number of threads waiting in wait-queue */
-    pthread_cond_t cv;              /* CV to block multiple threads in wait-queue */
+    th_byte_cond_t cv;              /* CV to block multiple threads in wait-queue, sleepers wait in parking lot */
+    wait_queue_mode_t mode;
+    uint32_t handoff_count;         /* FIFO mode broadcast waiters still to be handed the wakeup in order */
+    uint32_t cancel_seq;            /* bumped by wait_queue_cancel(), timed waiters compare with entry value */
     pthread_mutex_t *app_mutex;     /* application owned mutex cached in wait-queue */
-
+    wait_queue_lists_t *lists;      /* NULL until a fiber, FIFO, select or async waiter shows up */
 }wait_queue_t;
 
 /* function signature to be used by application for application condition function */
@@ -268,15 +630,47 @@ typedef bool (*wait_queue_condn_fn) (void *appln_arg, pthread_mutex_t **out_mute
 /**
  * @brief initiate wait queue
  * 
+ * @note  no lock type to pick, wait queue has no lock of its own,
+ *        waiters sleep with the application mutex handed out by the condition function
+ * 
  * @param wq 
  */
 void wait_queue_init (wait_queue_t * wq);
 
+/**
+ * @brief   initiate wait queue with wakeup policy
+ * 
+ * @note    in WAIT_QUEUE_FIFO mode signal wakes the oldest waiter, and broadcast wakes the
+ *          oldest waiter only, each woken waiter hands the wakeup to the next one once it
+ *          tested its condition, so waiters never all race for the application mutex
+ * 
+ * @param wq 
+ * @param mode 
+ */
+void wait_queue_init_mode (wait_queue_t * wq, wait_queue_mode_t mode);
+
 
 thread_t *wait_queue_test_and_wait (wait_queue_t *wq,
         wait_queue_condn_fn wait_queue_block_fn_cb,
         void *arg );
 
+/**
+ * @brief   wait_queue_test_and_wait() bounded by an absolute deadline
+ * 
+ * @note    application mutex is held on return whatever the result, like pthread_cond_timedwait().
+ *          a condition that turned false right at the deadline counts as success.
+ *          fibers can not use timed waits
+ * 
+ * @param wq 
+ * @param wait_queue_block_fn_cb 
+ * @param arg 
+ * @param deadline - absolute CLOCK_MONOTONIC time (see th_deadline_in()), NULL to wait forever
+ * @return int - 0 condition no longer blocks, ETIMEDOUT, ECANCELED after wait_queue_cancel()
+ */
+int wait_queue_test_and_wait_until (wait_queue_t *wq,
+        wait_queue_condn_fn wait_queue_block_fn_cb,
+        void *arg, const struct timespec *deadline);
+
 /**
  * @brief   signal threads waiting in queue
  * 
@@ -287,6 +681,16 @@ thread_t *wait_queue_test_and_wait (wait_queue_t *wq,
  */
 void wait_queue_signal (wait_queue_t *wq, bool lock_mutex);
 
+/**
+ * @brief   wakeup up to count threads waiting in queue, oldest first in WAIT_QUEUE_FIFO mode
+ * 
+ * @param wq            wait_queue_t - pointer
+ * @param count         max number of waiters to wakeup
+ * @param lock_mutex    bool - application lock mutex indicator
+ * @return uint32_t     number of waiters woken
+ */
+uint32_t wait_queue_signal_n (wait_queue_t *wq, uint32_t count, bool lock_mutex);
+
 /**
  * @brief   broadcast all threads waiting in queue
  * 
@@ -297,6 +701,15 @@ void wait_queue_signal (wait_queue_t *wq, bool lock_mutex);
  */
 void wait_queue_broadcast (wait_queue_t *wq, bool lock_mutex);
 
+/**
+ * @brief   cancel timed waits in progress, they return ECANCELED,
+ *          untimed waiters are woken too and go back to waiting if their condition still holds
+ * 
+ * @param wq            wait_queue_t - pointer
+ * @param lock_mutex    bool - application lock mutex indicator
+ */
+void wait_queue_cancel (wait_queue_t *wq, bool lock_mutex);
+
 /**
  * @brief destory wait queue
  * 
@@ -304,6 +717,136 @@ void wait_queue_broadcast (wait_queue_t *wq, bool lock_mutex);
  */
 void wait_queue_destroy (wait_queue_t *wq);
 
+/* wait_queue_wait_any() selector states, >= 0 is index of entry fired */
+#define WAIT_QUEUE_SELECT_WAITING   (-1)
+#define WAIT_QUEUE_SELECT_TIMEDOUT  (-2)
+
+/**
+ * @brief   one wait_queue_wait_any() call, shared by all its entries,
+ *          the first queue to move fired from WAITING to its index wakes the thread
+ */
+typedef struct wait_queue_select_
+{
+    _Atomic int32_t fired;              /* WAIT_QUEUE_SELECT_* or index of entry fired */
+    th_parker_t *parker;                /* waiting thread parker */
+}wait_queue_select_t;
+
+/**
+ * @brief   one wait queue of a wait_queue_wait_any() call,
+ *          caller fills wq, condition function and arg, the rest is private
+ */
+typedef struct wait_queue_any_
+{
+    wait_queue_t *wq;
+    wait_queue_condn_fn wait_queue_block_fn_cb;
+    void *arg;
+
+    /* private */
+    glthread_t select_glue;             /* node in wq->select_wait_head */
+    wait_queue_select_t *select;
+    uint32_t index;
+}wait_queue_any_t;
+GLTHREAD_TO_STRUCT(select_glue_to_wait_queue_any, wait_queue_any_t, select_glue);
+
+/**
+ * @brief   block until the condition of any of several wait queues stops blocking,
+ *          one thread serves many event sources without a thread per queue or polling
+ * 
+ * @note    calling thread registers one waiter on every queue whose condition blocks,
+ *          the first signal to reach it fires it and the others are deregistered,
+ *          a signal reaching an already fired waiter passes on to the next waiter of that queue.
+ *          queues may use different application mutexes, at most one is held at a time.
+ *          a queue must not appear twice in entries. threads only
+ * 
+ * @param entries - wait queues with their condition function and arg
+ * @param count - number of entries
+ * @param deadline - absolute CLOCK_MONOTONIC time, NULL to wait forever
+ * @param fired - index of entry whose condition no longer blocks
+ * @return int - 0 with application mutex of entries[*fired] held, ETIMEDOUT with no mutex held
+ */
+int wait_queue_wait_any (wait_queue_any_t *entries, uint32_t count,
+        const struct timespec *deadline, uint32_t *fired);
+
+/**
+ * @brief   asynchronous waiter, a continuation queued on a thread pool instead of a blocked thread,
+ *          caller fills wq, condition function, continuation, arg and pool, the rest is private
+ */
+typedef struct wait_queue_async_
+{
+    wait_queue_t *wq;
+    wait_queue_condn_fn wait_queue_block_fn_cb;
+    void *(*cont_fn)(void *);           /* called on a pool thread with application mutex held, unlocks it */
+    void *arg;                          /* passed to condition function and continuation */
+    thread_pool_t *th_pool;
+
+    /* private */
+    glthread_t async_glue;              /* node in wq->async_wait_head */
+    thread_pool_work_t work;            /* condition re-test and continuation, submitted once woken */
+}wait_queue_async_t;
+GLTHREAD_TO_STRUCT(async_glue_to_wait_queue_async, wait_queue_async_t, async_glue);
+
+/**
+ * @brief   wait for condition without blocking calling thread,
+ *          continuation runs on a thread pool thread once condition no longer blocks
+ * 
+ * @note    signal / broadcast submit woken waiters to their pool, the pool thread
+ *          re-tests the condition and goes back to waiting if another waiter consumed it,
+ *          so a handful of pool threads serve any number of logical waiters.
+ *          a waiter whose condition does not block is submitted right away, never run inline.
+ *          waiter must stay valid until its continuation is called, continuation may
+ *          wait again with the same waiter
+ * 
+ * @param waiter 
+ * @return true - waiter queued on wait queue, false - condition did not block, continuation submitted
+ */
+bool wait_queue_test_and_wait_async (wait_queue_async_t *waiter);
+
+/**
+ * @brief   one byte wait queue for objects that come by the million (e.g. one per routing entry),
+ *          sleepers wait in the global parking lot keyed by wait queue address.
+ *          application mutex is not cached, callers lock it around signal / broadcast themselves.
+ *          threads only, fibers use wait_queue_t
+ */
+typedef struct wait_queue_lite_
+{
+    th_byte_cond_t cond;
+}wait_queue_lite_t;
+
+/**
+ * @brief   initiate lite wait queue
+ * 
+ * @param wq 
+ */
+void wait_queue_lite_init (wait_queue_lite_t *wq);
+
+/**
+ * @brief   block calling thread while condition function return true,
+ *          same condition function contract as wait_queue_test_and_wait()
+ * 
+ * @param wq 
+ * @param wait_queue_block_fn_cb 
+ * @param arg 
+ * @param deadline - absolute CLOCK_MONOTONIC time, NULL to wait forever
+ * @return int - 0 condition no longer blocks, ETIMEDOUT (application mutex held either way)
+ */
+int wait_queue_lite_test_and_wait (wait_queue_lite_t *wq,
+        wait_queue_condn_fn wait_queue_block_fn_cb,
+        void *arg, const struct timespec *deadline);
+
+/**
+ * @brief   wakeup oldest waiter, a single load when nobody waits
+ * 
+ * @param wq 
+ */
+void wait_queue_lite_signal (wait_queue_lite_t *wq);
+
+/**
+ * @brief   wakeup all waiters, a single load when nobody waits
+ * 
+ * @param wq 
+ */
+void wait_queue_lite_broadcast (wait_queue_lite_t *wq);
+
 /********************* Wait Queue End *********************/
 
 #endif /* __THREAD_LIB__  */
\ No newline at end of file
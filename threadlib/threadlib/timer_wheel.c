@@ -0,0 +1,303 @@
+/**
+ * @file timer_wheel.c
+ * @author agent
+ * @brief  This file implements hashed hierarchical timer wheel
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "timer_wheel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+
+/*********** private helper functions BEGIN **********/
+
+/**
+ * @brief   link timer in the slot matching its expire tick, caller holds wheel->mutex
+ *
+ * @note    level is picked by distance to current tick, slot by expire tick bits of that level,
+ *          timers further than the wheel span park in the last slot of top level and cascade again
+ *
+ * @param wheel
+ * @param timer
+ */
+static void timer_wheel_link(timer_wheel_t *wheel, wheel_timer_t *timer)
+{
+    uint64_t delta;
+    uint32_t level, slot;
+
+    if(timer->expire_tick <= wheel->current_tick)
+    {
+        timer->expire_tick = wheel->current_tick + 1;
+    }
+    delta = timer->expire_tick - wheel->current_tick;
+
+    for(level = 0; level < TIMER_WHEEL_LEVELS - 1; level++)
+    {
+        if(delta < (1ULL << (TIMER_WHEEL_SLOT_BITS * (level + 1))))
+        {
+            break;
+        }
+    }
+
+    if(delta >= (1ULL << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)))
+    {
+        /* beyond wheel span, cascade from the farthest top level slot */
+        slot = ((wheel->current_tick >> (TIMER_WHEEL_SLOT_BITS * level)) - 1) & TIMER_WHEEL_SLOT_MASK;
+    }
+    else
+    {
+        slot = (timer->expire_tick >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK;
+    }
+
+    init_glthread(&timer->glue);
+    glthread_add_next(&wheel->slots[level][slot], &timer->glue);
+    timer->is_pending = true;
+}
+
+/**
+ * @brief   re-link all timers of a slot, they land in lower levels, caller holds wheel->mutex
+ *
+ * @note    timers due on current tick go to its level 0 slot, the tick expires them right after
+ *          the cascade, timer_wheel_link() would push them one tick late
+ *
+ * @param wheel
+ * @param level
+ * @param slot
+ */
+static void timer_wheel_cascade(timer_wheel_t *wheel, uint32_t level, uint32_t slot)
+{
+    glthread_t *node;
+    wheel_timer_t *timer;
+
+    while((node = dequeue_glthread_first(&wheel->slots[level][slot])) != NULL)
+    {
+        timer = glue_to_wheel_timer(node);
+        if(timer->expire_tick <= wheel->current_tick)
+        {
+            glthread_add_next(&wheel->slots[0][wheel->current_tick & TIMER_WHEEL_SLOT_MASK], node);
+            continue;
+        }
+        timer_wheel_link(wheel, timer);
+    }
+}
+
+/**
+ * @brief   thread pool work function of an expiry, timer may be queued again from now on
+ *
+ * @param arg - wheel_timer_t - pointer
+ * @return void*
+ */
+static void *wheel_timer_expire_fn(void *arg)
+{
+    wheel_timer_t *timer = (wheel_timer_t *) arg;
+
+    atomic_store(&timer->is_queued, false);
+    return timer->timer_fn(timer->arg);
+}
+
+/**
+ * @brief   advance wheel one tick and submit timers expired on it to the thread pool
+ *          caller holds wheel->mutex
+ *
+ * @param wheel
+ */
+static void timer_wheel_tick(timer_wheel_t *wheel)
+{
+    wheel_timer_t *timer;
+    glthread_t *node;
+    uint32_t level, slot;
+
+    wheel->current_tick++;
+
+    /* on level wrap, pull next slot of upper level down */
+    for(level = 1; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        if((wheel->current_tick & ((1ULL << (TIMER_WHEEL_SLOT_BITS * level)) - 1)) != 0)
+        {
+            break;
+        }
+        slot = (wheel->current_tick >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK;
+        timer_wheel_cascade(wheel, level, slot);
+    }
+
+    slot = wheel->current_tick & TIMER_WHEEL_SLOT_MASK;
+    while((node = dequeue_glthread_first(&wheel->slots[0][slot])) != NULL)
+    {
+        timer = glue_to_wheel_timer(node);
+        timer->is_pending = false;
+        wheel->pending_count--;
+
+        if(timer->period_ticks != 0)
+        {
+            timer->expire_tick = wheel->current_tick + timer->period_ticks;
+            timer_wheel_link(wheel, timer);
+            wheel->pending_count++;
+        }
+
+        /* never blocks and never runs timer_fn here, work object is linked on pool backlog at most once */
+        if(!atomic_exchange(&timer->is_queued, true))
+        {
+            thread_pool_submit(wheel->th_pool, &timer->work);
+        }
+    }
+}
+
+/**
+ * @brief   timer thread function, sleep until next tick and advance wheel
+ *
+ * @param arg - timer_wheel_t - pointer
+ * @return void*
+ */
+static void *timer_wheel_thread_fn(void *arg)
+{
+    timer_wheel_t *wheel = (timer_wheel_t *) arg;
+    uint64_t tick_ns = (uint64_t)wheel->tick_ms * 1000000ULL;
+    uint64_t now_tick, wakeup_ns;
+    struct timespec ts;
+
+    TH_MUTEX_LOCK(&wheel->mutex);
+    while(!wheel->stop)
+    {
+        /* catch up with wall time, several ticks if thread was late */
+        now_tick = (th_now_ns() - wheel->start_ns) / tick_ns;
+        while(wheel->current_tick < now_tick && !wheel->stop)
+        {
+            timer_wheel_tick(wheel);
+        }
+
+        if(wheel->pending_count == 0)
+        {
+            /* nothing armed, sleep until timer_wheel_add() signal, it moves the wheel over idle ticks */
+            TH_COND_WAIT(&wheel->cv, &wheel->mutex);
+            continue;
+        }
+
+        wakeup_ns = wheel->start_ns + (wheel->current_tick + 1) * tick_ns;
+        ts.tv_sec = wakeup_ns / 1000000000ULL;
+        ts.tv_nsec = wakeup_ns % 1000000000ULL;
+        TH_COND_TIMEDWAIT(&wheel->cv, &wheel->mutex, &ts);
+    }
+    TH_MUTEX_UNLOCK(&wheel->mutex);
+    return NULL;
+}
+
+/*********** private helper functions END ***********/
+
+void timer_wheel_init(timer_wheel_t *wheel, thread_pool_t *th_pool, uint32_t tick_ms)
+{
+    pthread_condattr_t attr;
+
+    for(uint32_t level = 0; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        for(uint32_t slot = 0; slot < TIMER_WHEEL_SLOTS; slot++)
+        {
+            init_glthread(&wheel->slots[level][slot]);
+        }
+    }
+    wheel->current_tick = 0;
+    wheel->start_ns = th_now_ns();
+    wheel->tick_ms = tick_ms ? tick_ms : 1;
+    wheel->pending_count = 0;
+    wheel->th_pool = th_pool;
+    wheel->timer_thread = NULL;
+    wheel->stop = false;
+    pthread_mutex_init(&wheel->mutex, NULL);
+    TH_LOCK_PROF_NAME(&wheel->mutex, "timer_wheel_t mutex");
+
+    /* timer thread sleeps to absolute monotonic deadlines */
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&wheel->cv, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+void timer_wheel_start(timer_wheel_t *wheel)
+{
+    assert(wheel->timer_thread == NULL);
+
+    wheel->stop = false;
+    wheel->timer_thread = thread_create(NULL, "timer_wheel");
+    thread_set_thread_attribute_joinable_or_detached(wheel->timer_thread, true);
+    thread_run(wheel->timer_thread, timer_wheel_thread_fn, wheel);
+}
+
+void timer_wheel_stop(timer_wheel_t *wheel)
+{
+    if(wheel->timer_thread == NULL)
+    {
+        return;
+    }
+
+    TH_MUTEX_LOCK(&wheel->mutex);
+    wheel->stop = true;
+    pthread_cond_signal(&wheel->cv);
+    TH_MUTEX_UNLOCK(&wheel->mutex);
+
+    pthread_join(wheel->timer_thread->thread, NULL);
+    free(wheel->timer_thread);
+    wheel->timer_thread = NULL;
+}
+
+void wheel_timer_init(wheel_timer_t *timer, void *(*timer_fn)(void *), void *arg)
+{
+    timer->timer_fn = timer_fn;
+    timer->arg = arg;
+    timer->expire_tick = 0;
+    timer->period_ticks = 0;
+    timer->is_pending = false;
+    init_glthread(&timer->glue);
+    timer->work.work_fn = wheel_timer_expire_fn;
+    timer->work.arg = timer;
+    atomic_init(&timer->is_queued, false);
+}
+
+void timer_wheel_add(timer_wheel_t *wheel, wheel_timer_t *timer, uint32_t delay_ms, uint32_t period_ms)
+{
+    uint64_t tick_ns = (uint64_t)wheel->tick_ms * 1000000ULL;
+    uint64_t now_ns = th_now_ns() - wheel->start_ns;
+
+    TH_MUTEX_LOCK(&wheel->mutex);
+    assert(!timer->is_pending);
+
+    if(wheel->pending_count == 0)
+    {
+        /* empty wheel, jump over idle ticks instead of replaying them */
+        wheel->current_tick = now_ns / tick_ns;
+    }
+
+    /* round expiry up to next tick boundary, a timer never fires early */
+    timer->expire_tick = (now_ns + (uint64_t)delay_ms * 1000000ULL + tick_ns - 1) / tick_ns;
+    timer->period_ticks = period_ms ? (period_ms + wheel->tick_ms - 1) / wheel->tick_ms : 0;
+    timer_wheel_link(wheel, timer);
+
+    /* wakeup timer thread sleeping on empty wheel */
+    if(wheel->pending_count++ == 0)
+    {
+        pthread_cond_signal(&wheel->cv);
+    }
+    TH_MUTEX_UNLOCK(&wheel->mutex);
+}
+
+bool timer_wheel_cancel(timer_wheel_t *wheel, wheel_timer_t *timer)
+{
+    bool was_pending;
+
+    TH_MUTEX_LOCK(&wheel->mutex);
+    was_pending = timer->is_pending;
+    if(was_pending)
+    {
+        remove_glthread(&timer->glue);
+        timer->is_pending = false;
+        timer->period_ticks = 0;
+        wheel->pending_count--;
+    }
+    TH_MUTEX_UNLOCK(&wheel->mutex);
+
+    return was_pending;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file timer_wheel.h
+ * @author agent
+ * @brief  This file defines a hashed hierarchical timer wheel,
+ *         one timer thread advance the wheel and hand expired timers to a thread pool
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __TIMER_WHEEL__
+#define __TIMER_WHEEL__
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "glthread.h"
+#include "threadlib.h"
+
+/**
+ * wheel has TIMER_WHEEL_LEVELS levels of TIMER_WHEEL_SLOTS slots,
+ * level n slot spans TIMER_WHEEL_SLOTS^n ticks, timers cascade down one level
+ * when the wheel reaches their slot, so insert and cancel are O(1)
+ */
+#define TIMER_WHEEL_SLOT_BITS       8
+#define TIMER_WHEEL_SLOTS           (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOT_MASK       (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_LEVELS          4
+
+/**
+ * @brief timer object, owned by caller
+ *
+ */
+typedef struct wheel_timer_
+{
+    void *(*timer_fn)(void *);                  /* expiry function, run on thread pool */
+    void *arg;                                  /* expiry function args */
+    uint64_t expire_tick;                       /* absolute wheel tick timer expires at */
+    uint32_t period_ticks;                      /* re-arm period, 0 for one-shot timer */
+    bool is_pending;                            /* timer linked in wheel */
+    glthread_t glue;                            /* wheel slot node */
+    thread_pool_work_t work;                    /* expiry submitted to thread pool */
+    _Atomic bool is_queued;                     /* expiry submitted, timer_fn not started yet */
+}wheel_timer_t;
+GLTHREAD_TO_STRUCT(glue_to_wheel_timer, wheel_timer_t, glue);
+
+typedef struct timer_wheel_
+{
+    glthread_t slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    uint64_t current_tick;                      /* last processed tick */
+    uint64_t start_ns;                          /* monotonic time of tick 0 */
+    uint32_t tick_ms;                           /* wheel resolution */
+    uint64_t pending_count;                     /* timers linked in wheel */
+    thread_pool_t *th_pool;                     /* expired timers run here */
+    thread_t *timer_thread;
+    bool stop;
+    pthread_mutex_t mutex;
+    pthread_cond_t cv;                          /* timer thread sleeps on it, CLOCK_MONOTONIC */
+}timer_wheel_t;
+
+/**
+ * @brief initiate timer wheel
+ *
+ * @note  mutex stays a pthread mutex, timer thread sleeps until next tick on a
+ *        condition variable bound to it
+ *
+ * @param wheel
+ * @param th_pool - thread pool running expired timers
+ * @param tick_ms - wheel resolution in milli seconds
+ */
+void timer_wheel_init(timer_wheel_t *wheel, thread_pool_t *th_pool, uint32_t tick_ms);
+
+/**
+ * @brief start wheel timer thread
+ *
+ * @param wheel
+ */
+void timer_wheel_start(timer_wheel_t *wheel);
+
+/**
+ * @brief stop and join wheel timer thread, pending timers stay in wheel
+ *
+ * @param wheel
+ */
+void timer_wheel_stop(timer_wheel_t *wheel);
+
+/**
+ * @brief initiate timer object
+ *
+ * @param timer
+ * @param timer_fn
+ * @param arg
+ */
+void wheel_timer_init(wheel_timer_t *timer, void *(*timer_fn)(void *), void *arg);
+
+/**
+ * @brief   arm timer, O(1)
+ *
+ * @note    expiry is submitted to the thread pool, queued on its backlog when no pool
+ *          thread is idle, timer thread never runs timer_fn. a periodic expiry whose
+ *          previous one has not started yet is skipped, not queued twice
+ *
+ * @param wheel
+ * @param timer     - initiated, not pending timer
+ * @param delay_ms  - first expiry, rounded up to wheel tick
+ * @param period_ms - re-arm period, 0 for one-shot timer
+ */
+void timer_wheel_add(timer_wheel_t *wheel, wheel_timer_t *timer, uint32_t delay_ms, uint32_t period_ms);
+
+/**
+ * @brief   cancel pending timer, O(1)
+ *
+ * @note    an expiry already handed to the thread pool may still be queued or running,
+ *          timer must stay valid until it ran
+ *
+ * @param wheel
+ * @param timer
+ * @return true  - timer was pending and will not fire again
+ *         false - timer not pending (expired one-shot or never armed)
+ */
+bool timer_wheel_cancel(timer_wheel_t *wheel, wheel_timer_t *timer);
+
+#endif /* __TIMER_WHEEL__ */